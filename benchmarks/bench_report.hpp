@@ -0,0 +1,260 @@
+#ifndef BENCH_REPORT_HPP
+#define BENCH_REPORT_HPP
+
+#include <string>
+#include <vector>
+#include <map>
+#include <utility>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <cmath>
+#include <cstdint>
+#include <cstddef>
+#include <cstdlib>
+
+// ============================================================================
+// BENCH REPORT - Structured benchmark results (JSON)
+// ============================================================================
+//
+// Benchmarks record named metrics per scenario as they print. Repeated runs
+// of the suite append samples to the same metric, and the comparator works
+// on those samples. File layout:
+//   { "schema": 1, "config": { "<key>": "<value>", ... },
+//     "metrics": [ { "scenario": "...", "metric": "...", "unit": "...",
+//                    "better": "higher" | "lower", "samples": [ ... ] } ] }
+
+struct BenchMetric {
+    std::string scenario;
+    std::string metric;
+    std::string unit;
+    bool higher_is_better = true;
+    std::vector<double> samples;
+
+    double mean() const {
+        double sum = 0.0;
+        for (double v : samples) sum += v;
+        return samples.empty() ? 0.0 : sum / samples.size();
+    }
+
+    // Sample variance (n - 1); 0 with fewer than two samples
+    double variance() const {
+        if (samples.size() < 2) return 0.0;
+        double m = mean(), sum = 0.0;
+        for (double v : samples) sum += (v - m) * (v - m);
+        return sum / (samples.size() - 1);
+    }
+};
+
+class BenchReport {
+public:
+    static BenchReport& global() {
+        static BenchReport report;
+        return report;
+    }
+
+    void set_config(const std::string& key, const std::string& value) {
+        for (auto& kv : config_) {
+            if (kv.first == key) {
+                kv.second = value;
+                return;
+            }
+        }
+        config_.emplace_back(key, value);
+    }
+
+    void record(const std::string& scenario, const std::string& metric, double value,
+                const std::string& unit, bool higher_is_better) {
+        auto key = std::make_pair(scenario, metric);
+        auto it = index_.find(key);
+        if (it == index_.end()) {
+            it = index_.emplace(key, metrics_.size()).first;
+            metrics_.push_back({scenario, metric, unit, higher_is_better, {}});
+        }
+        metrics_[it->second].samples.push_back(value);
+    }
+
+    const std::vector<BenchMetric>& metrics() const { return metrics_; }
+    const std::vector<std::pair<std::string, std::string>>& config() const { return config_; }
+
+    std::string to_json() const {
+        std::ostringstream out;
+        out << std::setprecision(17);
+        out << "{\n  \"schema\": 1,\n  \"config\": {";
+        for (size_t i = 0; i < config_.size(); ++i) {
+            out << (i ? ",\n    " : "\n    ") << quote(config_[i].first) << ": "
+                << quote(config_[i].second);
+        }
+        out << "\n  },\n  \"metrics\": [";
+        for (size_t i = 0; i < metrics_.size(); ++i) {
+            const BenchMetric& m = metrics_[i];
+            out << (i ? ",\n    " : "\n    ") << "{\"scenario\": " << quote(m.scenario)
+                << ", \"metric\": " << quote(m.metric) << ", \"unit\": " << quote(m.unit)
+                << ", \"better\": \"" << (m.higher_is_better ? "higher" : "lower")
+                << "\", \"samples\": [";
+            for (size_t s = 0; s < m.samples.size(); ++s) {
+                out << (s ? ", " : "") << (std::isfinite(m.samples[s]) ? m.samples[s] : 0.0);
+            }
+            out << "]}";
+        }
+        out << "\n  ]\n}\n";
+        return out.str();
+    }
+
+    bool save(const std::string& path) const {
+        std::ofstream file(path);
+        if (!file) return false;
+        file << to_json();
+        return static_cast<bool>(file);
+    }
+
+    // Reads a file written by save(). Returns false on I/O or format errors.
+    bool load(const std::string& path) {
+        std::ifstream file(path);
+        if (!file) return false;
+        std::stringstream buffer;
+        buffer << file.rdbuf();
+        return parse(buffer.str());
+    }
+
+    bool parse(const std::string& text) {
+        Parser p{text, 0};
+        Json root;
+        if (!p.value(root) || root.type != Json::OBJECT) return false;
+        config_.clear();
+        metrics_.clear();
+        index_.clear();
+        if (const Json* config = root.get("config")) {
+            for (size_t i = 0; i < config->keys.size(); ++i) {
+                config_.emplace_back(config->keys[i], config->items[i].str);
+            }
+        }
+        const Json* metrics = root.get("metrics");
+        if (!metrics || metrics->type != Json::ARRAY) return false;
+        for (const Json& m : metrics->items) {
+            const Json* scenario = m.get("scenario");
+            const Json* metric = m.get("metric");
+            const Json* samples = m.get("samples");
+            if (!scenario || !metric || !samples) return false;
+            const Json* unit = m.get("unit");
+            const Json* better = m.get("better");
+            for (const Json& s : samples->items) {
+                record(scenario->str, metric->str, s.num, unit ? unit->str : "",
+                       !better || better->str != "lower");
+            }
+        }
+        return true;
+    }
+
+private:
+    static std::string quote(const std::string& s) {
+        std::string out = "\"";
+        for (char c : s) {
+            if (c == '"' || c == '\\') out += '\\';
+            if (static_cast<unsigned char>(c) < 0x20) continue;
+            out += c;
+        }
+        return out + "\"";
+    }
+
+    // Just enough JSON for the layout above
+    struct Json {
+        enum Type { NONE, NUMBER, STRING, BOOL, ARRAY, OBJECT } type = NONE;
+        double num = 0.0;
+        std::string str;
+        std::vector<std::string> keys;  // OBJECT only, parallel to items
+        std::vector<Json> items;        // ARRAY elements or OBJECT values
+
+        const Json* get(const std::string& key) const {
+            for (size_t i = 0; i < keys.size(); ++i) {
+                if (keys[i] == key) return &items[i];
+            }
+            return nullptr;
+        }
+    };
+
+    struct Parser {
+        const std::string& s;
+        size_t pos;
+
+        void skip() {
+            while (pos < s.size() && (s[pos] == ' ' || s[pos] == '\n' || s[pos] == '\r' || s[pos] == '\t')) ++pos;
+        }
+
+        bool consume(char c) {
+            skip();
+            if (pos < s.size() && s[pos] == c) {
+                ++pos;
+                return true;
+            }
+            return false;
+        }
+
+        bool string(std::string& out) {
+            if (!consume('"')) return false;
+            out.clear();
+            while (pos < s.size() && s[pos] != '"') {
+                if (s[pos] == '\\' && pos + 1 < s.size()) ++pos;
+                out += s[pos++];
+            }
+            return consume('"');
+        }
+
+        bool value(Json& v) {
+            skip();
+            if (pos >= s.size()) return false;
+            char c = s[pos];
+            if (c == '{') {
+                ++pos;
+                v.type = Json::OBJECT;
+                if (consume('}')) return true;
+                do {
+                    std::string key;
+                    Json item;
+                    if (!string(key) || !consume(':') || !value(item)) return false;
+                    v.keys.push_back(std::move(key));
+                    v.items.push_back(std::move(item));
+                } while (consume(','));
+                return consume('}');
+            }
+            if (c == '[') {
+                ++pos;
+                v.type = Json::ARRAY;
+                if (consume(']')) return true;
+                do {
+                    Json item;
+                    if (!value(item)) return false;
+                    v.items.push_back(std::move(item));
+                } while (consume(','));
+                return consume(']');
+            }
+            if (c == '"') {
+                v.type = Json::STRING;
+                return string(v.str);
+            }
+            if (s.compare(pos, 4, "true") == 0 || s.compare(pos, 5, "false") == 0) {
+                v.type = Json::BOOL;
+                v.num = s[pos] == 't' ? 1.0 : 0.0;
+                pos += s[pos] == 't' ? 4 : 5;
+                return true;
+            }
+            if (s.compare(pos, 4, "null") == 0) {
+                pos += 4;
+                return true;
+            }
+            const char* begin = s.c_str() + pos;
+            char* end = nullptr;
+            v.num = std::strtod(begin, &end);
+            if (end == begin) return false;
+            v.type = Json::NUMBER;
+            pos += static_cast<size_t>(end - begin);
+            return true;
+        }
+    };
+
+    std::vector<std::pair<std::string, std::string>> config_;
+    std::vector<BenchMetric> metrics_;
+    std::map<std::pair<std::string, std::string>, size_t> index_;
+};
+
+#endif
@@ -0,0 +1,148 @@
+#include "bench_report.hpp"
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <cmath>
+
+// ============================================================================
+// BENCHMARK COMPARATOR - Flags regressions between two JSON result files
+// ============================================================================
+//
+// Usage: matching_engine_bench_compare BASELINE.json CANDIDATE.json
+//                                      [--threshold PCT]
+//
+// For every metric in both files, the candidate/baseline difference of
+// means gets a 95% confidence interval (Welch's t). A metric regresses
+// when it moved the wrong way by more than the threshold (default 5%) AND
+// the interval excludes zero. With fewer than two samples on either side
+// there is no interval and the threshold alone decides, so record with
+// --repeat for a trustworthy gate. Exit status: 0 clean, 1 regression,
+// 2 usage or file error.
+
+namespace {
+
+// Two-sided 95% Student t critical values for df = 1..30
+double t_critical(double df) {
+    static const double table[] = {
+        12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+        2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+        2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042
+    };
+    if (df < 1.0) return table[0];
+    if (df > 30.0) return 1.960;
+    return table[static_cast<int>(df) - 1];  // Round df down: conservative
+}
+
+struct Comparison {
+    double delta_pct = 0.0;     // Candidate vs baseline mean
+    double ci_low_pct = 0.0;    // 95% interval of the difference
+    double ci_high_pct = 0.0;
+    bool has_interval = false;
+};
+
+Comparison compare(const BenchMetric& base, const BenchMetric& cand) {
+    Comparison c;
+    double mb = base.mean(), mc = cand.mean();
+    double scale = mb != 0.0 ? 100.0 / std::fabs(mb) : 0.0;
+    c.delta_pct = (mc - mb) * scale;
+    size_t nb = base.samples.size(), nc = cand.samples.size();
+    if (nb < 2 || nc < 2) return c;
+
+    double vb = base.variance() / nb, vc = cand.variance() / nc;
+    double se = std::sqrt(vb + vc);
+    double denom = vb * vb / (nb - 1) + vc * vc / (nc - 1);
+    double df = denom > 0.0 ? (vb + vc) * (vb + vc) / denom : static_cast<double>(nb + nc - 2);
+    double half = t_critical(df) * se;
+    c.ci_low_pct = (mc - mb - half) * scale;
+    c.ci_high_pct = (mc - mb + half) * scale;
+    c.has_interval = true;
+    return c;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    std::string base_path, cand_path;
+    double threshold = 5.0;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--threshold" && i + 1 < argc) {
+            threshold = std::atof(argv[++i]);
+        } else if (base_path.empty()) {
+            base_path = arg;
+        } else {
+            cand_path = arg;
+        }
+    }
+    if (base_path.empty() || cand_path.empty()) {
+        std::cerr << "usage: " << argv[0] << " BASELINE.json CANDIDATE.json [--threshold PCT]\n";
+        return 2;
+    }
+
+    BenchReport base, cand;
+    if (!base.load(base_path)) {
+        std::cerr << "cannot read " << base_path << "\n";
+        return 2;
+    }
+    if (!cand.load(cand_path)) {
+        std::cerr << "cannot read " << cand_path << "\n";
+        return 2;
+    }
+    auto config_value = [](const BenchReport& r, const char* key) -> std::string {
+        for (const auto& kv : r.config()) {
+            if (kv.first == key) return kv.second;
+        }
+        return "?";
+    };
+    std::cout << "Baseline:  " << base_path << " (git " << config_value(base, "git") << ")\n";
+    std::cout << "Candidate: " << cand_path << " (git " << config_value(cand, "git") << ")\n";
+    std::cout << "Threshold: " << threshold << "%, 95% confidence\n\n";
+
+    int regressions = 0, improvements = 0, missing = 0;
+    std::cout << std::left << std::setw(44) << "scenario/metric" << std::right
+              << std::setw(14) << "baseline" << std::setw(14) << "candidate"
+              << std::setw(9) << "delta" << std::setw(20) << "95% CI" << "  verdict\n";
+    for (const BenchMetric& b : base.metrics()) {
+        const BenchMetric* c = nullptr;
+        for (const BenchMetric& m : cand.metrics()) {
+            if (m.scenario == b.scenario && m.metric == b.metric) c = &m;
+        }
+        std::string name = b.scenario + "/" + b.metric;
+        if (!c) {
+            ++missing;
+            std::cout << std::left << std::setw(44) << name << std::right
+                      << "  (missing from candidate)\n";
+            continue;
+        }
+
+        Comparison r = compare(b, *c);
+        bool worse = b.higher_is_better ? r.delta_pct < 0 : r.delta_pct > 0;
+        bool beyond = std::fabs(r.delta_pct) > threshold;
+        bool significant = !r.has_interval || r.ci_low_pct > 0 || r.ci_high_pct < 0;
+        const char* verdict = "ok";
+        if (beyond && significant) {
+            verdict = worse ? "REGRESSION" : "improved";
+            (worse ? regressions : improvements)++;
+        } else if (beyond) {
+            verdict = "noise";
+        }
+
+        std::ostringstream ci;
+        if (r.has_interval) {
+            ci << std::fixed << std::setprecision(1) << "[" << r.ci_low_pct << ", "
+               << r.ci_high_pct << "]%";
+        } else {
+            ci << "n<2";
+        }
+        std::cout << std::left << std::setw(44) << name << std::right << std::setprecision(4)
+                  << std::setw(14) << b.mean() << std::setw(14) << c->mean()
+                  << std::fixed << std::setprecision(1) << std::setw(8) << r.delta_pct << "%"
+                  << std::setw(20) << ci.str() << "  " << verdict << "\n"
+                  << std::defaultfloat;
+    }
+
+    std::cout << "\n" << regressions << " regression(s), " << improvements << " improvement(s)";
+    if (missing) std::cout << ", " << missing << " metric(s) missing from candidate";
+    std::cout << "\n";
+    return regressions > 0 ? 1 : 0;
+}
@@ -0,0 +1,160 @@
+#ifndef HDR_HISTOGRAM_HPP
+#define HDR_HISTOGRAM_HPP
+
+#include "../src/latency_probe.hpp"
+#include <vector>
+#include <ostream>
+#include <iomanip>
+#include <algorithm>
+#include <limits>
+#include <cstdint>
+#include <cstddef>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// ============================================================================
+// HDR HISTOGRAM - Log-linear latency recording for the benchmarks
+// ============================================================================
+//
+// Values below 2^SUB_BITS are counted exactly. Above that, every power of
+// two is split into 2^(SUB_BITS-1) linear sub-buckets, so a reported value
+// is within 1/64 (~1.6%) of the true one at any magnitude. Recording is a
+// count-leading-zeros, a shift and an increment; nothing is sorted, so
+// millions of samples cost 30 KB instead of a growing vector.
+
+class HdrHistogram {
+public:
+    static constexpr unsigned SUB_BITS = 7;
+    static constexpr uint64_t SUB_COUNT = uint64_t(1) << SUB_BITS;    // 128
+    static constexpr uint64_t HALF_COUNT = SUB_COUNT / 2;             // 64
+    static constexpr size_t BUCKETS = (64 - SUB_BITS + 2) * HALF_COUNT;
+
+    HdrHistogram() : counts_(BUCKETS, 0) {}
+
+    void record(uint64_t value) {
+        ++counts_[index_of(value)];
+        ++count_;
+        sum_ += value;
+        min_ = std::min(min_, value);
+        max_ = std::max(max_, value);
+    }
+
+    void merge(const HdrHistogram& other) {
+        for (size_t i = 0; i < BUCKETS; ++i) counts_[i] += other.counts_[i];
+        count_ += other.count_;
+        sum_ += other.sum_;
+        min_ = std::min(min_, other.min_);
+        max_ = std::max(max_, other.max_);
+    }
+
+    void reset() {
+        std::fill(counts_.begin(), counts_.end(), 0);
+        count_ = sum_ = max_ = 0;
+        min_ = std::numeric_limits<uint64_t>::max();
+    }
+
+    uint64_t count() const { return count_; }
+    uint64_t min() const { return count_ ? min_ : 0; }
+    uint64_t max() const { return max_; }
+    double mean() const { return count_ ? static_cast<double>(sum_) / count_ : 0.0; }
+
+    // Highest value equivalent to the p-th percentile sample (0 < p <= 100),
+    // clamped to the recorded maximum
+    uint64_t value_at_percentile(double p) const {
+        if (count_ == 0) return 0;
+        uint64_t rank = static_cast<uint64_t>(p / 100.0 * static_cast<double>(count_) + 0.5);
+        rank = std::max<uint64_t>(1, std::min(rank, count_));
+        uint64_t seen = 0;
+        for (size_t i = 0; i < BUCKETS; ++i) {
+            seen += counts_[i];
+            if (seen >= rank) return std::min(max_, highest_equivalent(i));
+        }
+        return max_;
+    }
+
+    static size_t index_of(uint64_t value) {
+        if (value < SUB_COUNT) return static_cast<size_t>(value);
+        unsigned shift = 64 - static_cast<unsigned>(__builtin_clzll(value)) - SUB_BITS;
+        return static_cast<size_t>(shift * HALF_COUNT + (value >> shift));
+    }
+
+    static uint64_t highest_equivalent(size_t index) {
+        if (index < SUB_COUNT) return index;
+        unsigned shift = static_cast<unsigned>(index / HALF_COUNT - 1);
+        uint64_t sub = index % HALF_COUNT + HALF_COUNT;
+        uint64_t upper = (sub + 1) << shift;
+        return upper == 0 ? std::numeric_limits<uint64_t>::max() : upper - 1;
+    }
+
+private:
+    std::vector<uint64_t> counts_;
+    uint64_t count_ = 0;
+    uint64_t sum_ = 0;
+    uint64_t min_ = std::numeric_limits<uint64_t>::max();
+    uint64_t max_ = 0;
+};
+
+// ============================================================================
+// TSC TIMER - Fenced cycle counts with the timer's own cost removed
+// ============================================================================
+//
+// start() waits for earlier work to retire and keeps later work from
+// starting early; stop() waits for the measured work to retire. The
+// overhead is the cheapest of many empty start/stop pairs, so subtracting
+// it never inflates the measurement of a real call.
+
+struct TscTimer {
+    static uint64_t start() {
+#if defined(__x86_64__) || defined(__i386__)
+        uint64_t t = TscClock::now_serialized();
+        _mm_lfence();
+        return t;
+#else
+        return TscClock::now();
+#endif
+    }
+
+    static uint64_t stop() { return TscClock::now_serialized(); }
+
+    static uint64_t overhead() {
+        static const uint64_t cycles = measure_overhead();
+        return cycles;
+    }
+
+    // Cycles between start and end, less the timer overhead
+    static uint64_t elapsed(uint64_t start_tsc, uint64_t end_tsc) {
+        uint64_t raw = end_tsc - start_tsc;
+        return raw > overhead() ? raw - overhead() : 0;
+    }
+
+private:
+    static uint64_t measure_overhead() {
+        uint64_t best = std::numeric_limits<uint64_t>::max();
+        for (int i = 0; i < 100000; ++i) {
+            uint64_t s = start();
+            uint64_t e = stop();
+            best = std::min(best, e - s);
+        }
+        return best;
+    }
+};
+
+// Standard percentile block for a histogram of TscTimer cycle counts
+inline void print_latency(std::ostream& out, const HdrHistogram& cycles) {
+    auto ns = [](uint64_t c) { return TscClock::to_ns(c); };
+    out << std::fixed << std::setprecision(1);
+    out << "   Samples: " << cycles.count() << " (timer overhead "
+        << ns(TscTimer::overhead()) << " ns subtracted)\n";
+    out << "   Mean: " << ns(static_cast<uint64_t>(cycles.mean())) << " ns\n";
+    out << "   P50: " << ns(cycles.value_at_percentile(50)) << " ns\n";
+    out << "   P90: " << ns(cycles.value_at_percentile(90)) << " ns\n";
+    out << "   P99: " << ns(cycles.value_at_percentile(99)) << " ns\n";
+    out << "   P99.9: " << ns(cycles.value_at_percentile(99.9)) << " ns\n";
+    out << "   P99.99: " << ns(cycles.value_at_percentile(99.99)) << " ns\n";
+    out << "   Max: " << ns(cycles.max()) << " ns\n";
+    out << std::defaultfloat;
+}
+
+#endif
@@ -1,10 +1,124 @@
 #include "../src/orderbook.hpp"
+#include "../src/journal.hpp"
+#include "../src/async_journal.hpp"
+#include "../src/replay.hpp"
+#include "../src/pipeline.hpp"
+#include "../src/replica.hpp"
+#include "hdr_histogram.hpp"
+#include "workload.hpp"
+#include "perf_counters.hpp"
+#include "bench_report.hpp"
 #include <iostream>
 #include <chrono>
 #include <vector>
 #include <algorithm>
 #include <random>
 #include <iomanip>
+#include <cstring>
+#include <string>
+#include <optional>
+#include <cstdlib>
+#include <cstdio>
+#include <filesystem>
+#include <limits>
+#include <atomic>
+#include <thread>
+
+// Set by CMake (the hash in a header generated at build time); fallbacks
+// for builds outside it
+#if __has_include("git_hash.hpp")
+#include "git_hash.hpp"
+#endif
+#ifndef MATCHING_ENGINE_GIT_HASH
+#define MATCHING_ENGINE_GIT_HASH "unknown"
+#endif
+#ifndef MATCHING_ENGINE_BUILD_TYPE
+#define MATCHING_ENGINE_BUILD_TYPE "unknown"
+#endif
+
+// ============================================================================
+// COUNTER REGIONS - Optional hardware counters around timed code (--counters)
+// ============================================================================
+// begin()/end() pairs accumulate, so setup between measured calls can be
+// left out. Regions around per-call TscTimer loops include the timer reads.
+
+class CounterRegion {
+public:
+    static inline bool enabled = false;
+
+    CounterRegion() {
+        if (enabled) group_.emplace();
+    }
+
+    void begin() {
+        if (group_) group_->start();
+    }
+
+    void end() {
+        if (group_) total_.add(group_->stop());
+    }
+
+    // Prints per-op values and records them under `scenario`
+    void report(uint64_t ops, const std::string& scenario) const {
+        if (!group_) return;
+        if (!group_->available()) {
+            std::cout << "   Counters: unavailable (" << group_->error() << ")\n";
+            return;
+        }
+        print_counters(std::cout, total_, ops);
+        static const char* const names[] = {
+            "cycles_per_op", "instructions_per_op", "l1d_misses_per_op",
+            "llc_misses_per_op", "dtlb_misses_per_op", "branch_misses_per_op"
+        };
+        for (size_t i = 0; i < PerfSample::EVENTS && ops > 0; ++i) {
+            if (!total_.valid[i]) continue;
+            BenchReport::global().record(scenario, names[i],
+                                         static_cast<double>(total_.values[i]) / ops, "count", false);
+        }
+    }
+
+private:
+    std::optional<PerfCounterGroup> group_;
+    PerfSample total_;
+};
+
+// ============================================================================
+// RESULT RECORDING - Feeds BenchReport for --json
+// ============================================================================
+
+inline void record_rate(const std::string& scenario, const std::string& metric, double per_sec) {
+    BenchReport::global().record(scenario, metric, per_sec, "1/s", true);
+}
+
+inline void record_time(const std::string& scenario, const std::string& metric, double ns) {
+    BenchReport::global().record(scenario, metric, ns, "ns", false);
+}
+
+// Percentiles of a TscTimer cycle histogram, in ns
+inline void record_latency(const std::string& scenario, const HdrHistogram& cycles) {
+    auto ns = [&cycles](double p) { return TscClock::to_ns(cycles.value_at_percentile(p)); };
+    record_time(scenario, "mean_ns", TscClock::to_ns(static_cast<uint64_t>(cycles.mean())));
+    record_time(scenario, "p50_ns", ns(50));
+    record_time(scenario, "p90_ns", ns(90));
+    record_time(scenario, "p99_ns", ns(99));
+    record_time(scenario, "p99_9_ns", ns(99.9));
+    record_time(scenario, "p99_99_ns", ns(99.99));
+    record_time(scenario, "max_ns", TscClock::to_ns(cycles.max()));
+}
+
+inline void execute(OrderBook& book, const Command& cmd) {
+    switch (cmd.type) {
+        case CommandType::NEW_ORDER:
+            book.process_new_order(cmd.id, cmd.side, cmd.price, cmd.quantity, cmd.owner);
+            break;
+        case CommandType::CANCEL_ORDER:
+            book.process_cancel(cmd.id);
+            break;
+        case CommandType::MODIFY_ORDER:
+            book.process_modify(cmd.id, cmd.price, cmd.quantity);
+            break;
+    }
+}
 
 // ============================================================================
 // PERFORMANCE BENCHMARKS
@@ -12,21 +126,70 @@
 
 class Benchmark {
 public:
-    static void run_all_benchmarks() {
+    // With a workload, every benchmark that drives order flow replays it
+    // instead of its built-in pattern: throughput, latency, cancel, batch,
+    // mass cancel (on the book the workload leaves), sweep reporting and
+    // journal, plus StressTest. Exempt, as they measure a shape the
+    // generator does not produce: memory (no flow), MBO encoding (encoder
+    // only), mass quote (one maker's ladder refresh), cumulative depth
+    // (queries on a fixed ladder) and ComparisonTest (deliberate extremes).
+    // Benchmarks 12-17 always generate their own flow. A trace (a save_log
+    // file) replaces the generated flow of the open-loop benchmark.
+    static void run_all_benchmarks(const Workload* workload = nullptr,
+                                   const std::string& trace = "") {
         std::cout << "\n========== PERFORMANCE BENCHMARKS ==========\n\n";
+        workload_ = workload;
+        trace_ = trace;
         
         benchmark_throughput();
         benchmark_latency();
         benchmark_memory();
         benchmark_cancel();
+        benchmark_mbo_feed();
+        benchmark_batch();
+        benchmark_mass_cancel();
+        benchmark_mass_quote();
+        benchmark_sweep_reporting();
+        benchmark_journal();
+        benchmark_cumulative_depth();
+        benchmark_realistic_workload();
+        benchmark_open_loop();
+        benchmark_pipeline();
+        benchmark_async_journal();
+        benchmark_crc32c();
+        benchmark_replica();
     }
     
 private:
+    static inline const Workload* workload_ = nullptr;
+    static inline std::string trace_;
+
     static void benchmark_throughput() {
         std::cout << "Benchmark 1: Throughput Test\n";
+        if (workload_) {
+            const auto& cmds = workload_->commands;
+            OrderBook book(workload_->peak_resting + 1000);
+            CounterRegion counters;
+            counters.begin();
+            auto start = std::chrono::high_resolution_clock::now();
+            for (const Command& cmd : cmds) execute(book, cmd);
+            auto end = std::chrono::high_resolution_clock::now();
+            counters.end();
+            auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+            std::cout << "   Processed: " << cmds.size() << " workload commands\n";
+            std::cout << "   Time: " << duration.count() << " μs\n";
+            std::cout << "   Throughput: " << static_cast<size_t>(cmds.size() * 1000000.0 / (duration.count() + 1))
+                      << " cmds/sec\n";
+            record_rate("throughput", "cmds_per_sec", cmds.size() * 1e6 / (duration.count() + 1));
+            counters.report(cmds.size(), "throughput");
+            std::cout << "\n";
+            return;
+        }
         const int num_orders = 100000;
         // Pre-allocate capacity to avoid pool exhaustion
         OrderBook book(num_orders * 2); 
+        CounterRegion counters;
+        counters.begin();
         
         auto start = std::chrono::high_resolution_clock::now();
         
@@ -37,21 +200,41 @@ private:
         }
         
         auto end = std::chrono::high_resolution_clock::now();
+        counters.end();
         auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
         
         double throughput = (num_orders * 1000000.0) / duration.count();
         std::cout << "   Processed: " << num_orders << " orders\n";
         std::cout << "   Time: " << duration.count() << " μs\n";
         std::cout << "   Throughput: " << static_cast<size_t>(throughput) << " orders/sec\n";
-        std::cout << "   Avg latency: " << (double)duration.count() / num_orders << " μs/order\n\n";
+        std::cout << "   Avg latency: " << (double)duration.count() / num_orders << " μs/order\n";
+        record_rate("throughput", "cmds_per_sec", throughput);
+        counters.report(num_orders, "throughput");
+        std::cout << "\n";
     }
     
     static void benchmark_latency() {
         std::cout << "Benchmark 2: Latency Distribution\n";
+        if (workload_) {
+            OrderBook book(workload_->peak_resting + 1000);
+            HdrHistogram latencies;
+            CounterRegion counters;
+            counters.begin();
+            for (const Command& cmd : workload_->commands) {
+                uint64_t start = TscTimer::start();
+                execute(book, cmd);
+                latencies.record(TscTimer::elapsed(start, TscTimer::stop()));
+            }
+            counters.end();
+            print_latency(std::cout, latencies);
+            record_latency("latency", latencies);
+            counters.report(workload_->commands.size(), "latency");
+            std::cout << "\n";
+            return;
+        }
         // Capacity for setup + test orders
         OrderBook book(20000);
-        std::vector<long long> latencies;
-        latencies.reserve(10000);
+        HdrHistogram latencies;
         
         // Pre-populate book
         for (int i = 0; i < 1000; ++i) {
@@ -60,25 +243,20 @@ private:
         }
         
         // Measure latency of individual orders
+        CounterRegion counters;
+        counters.begin();
         for (int i = 0; i < 10000; ++i) {
-            auto start = std::chrono::high_resolution_clock::now();
+            uint64_t start = TscTimer::start();
             book.process_new_order(OrderId(10000+i), Side::BUY, 
                                  from_double(105.0), Quantity(10));
-            auto end = std::chrono::high_resolution_clock::now();
-            
-            latencies.push_back(
-                std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()
-            );
+            latencies.record(TscTimer::elapsed(start, TscTimer::stop()));
         }
+        counters.end();
         
-        std::sort(latencies.begin(), latencies.end());
-        
-        std::cout << "   Samples: " << latencies.size() << "\n";
-        std::cout << "   P50: " << latencies[latencies.size()/2] << " ns\n";
-        std::cout << "   P90: " << latencies[latencies.size()*9/10] << " ns\n";
-        std::cout << "   P99: " << latencies[latencies.size()*99/100] << " ns\n";
-        std::cout << "   P99.9: " << latencies[latencies.size()*999/1000] << " ns\n";
-        std::cout << "   Max: " << latencies.back() << " ns\n\n";
+        print_latency(std::cout, latencies);
+        record_latency("latency", latencies);
+        counters.report(10000, "latency");
+        std::cout << "\n";
     }
     
     static void benchmark_memory() {
@@ -98,11 +276,34 @@ private:
         std::cout << "   Pool Memory: " << pool_size / 1024.0 / 1024.0 << " MB\n";
         std::cout << "   Event Log Memory: " << event_log_size / 1024.0 / 1024.0 << " MB\n";
         std::cout << "   Total Pre-allocated: ~" << (pool_size + event_log_size + map_overhead) / 1024.0 / 1024.0 << " MB\n";
-        std::cout << "   Note: No runtime heap allocations occur during trading.\n\n";
+        std::cout << "   Note: Index and price-level nodes are still heap-allocated per resting\n"
+                  << "         order / new level (see matching_engine_alloc_tests).\n\n";
     }
     
     static void benchmark_cancel() {
         std::cout << "Benchmark 4: Cancel Performance\n";
+        if (workload_) {
+            // Cancels timed in place, on the book the flow has built so far
+            OrderBook book(workload_->peak_resting + 1000);
+            HdrHistogram latencies;
+            CounterRegion counters;
+            for (const Command& cmd : workload_->commands) {
+                if (cmd.type != CommandType::CANCEL_ORDER) {
+                    execute(book, cmd);
+                    continue;
+                }
+                counters.begin();
+                uint64_t start = TscTimer::start();
+                book.process_cancel(cmd.id);
+                latencies.record(TscTimer::elapsed(start, TscTimer::stop()));
+                counters.end();
+            }
+            print_latency(std::cout, latencies);
+            record_latency("cancel", latencies);
+            counters.report(latencies.count(), "cancel");
+            std::cout << "\n";
+            return;
+        }
         const int num_orders = 10000;
         OrderBook book(num_orders * 2);
         std::vector<OrderId> order_ids;
@@ -116,20 +317,897 @@ private:
             order_ids.push_back(OrderId(i+1));
         }
         
-        // Benchmark cancellations
-        auto start = std::chrono::high_resolution_clock::now();
-        
+        // Benchmark cancellations, timing each one
+        HdrHistogram latencies;
+        CounterRegion counters;
+        counters.begin();
         for (int i = 0; i < 1000; ++i) {
+            uint64_t start = TscTimer::start();
             book.process_cancel(order_ids[i]);
+            latencies.record(TscTimer::elapsed(start, TscTimer::stop()));
         }
+        counters.end();
+        
+        print_latency(std::cout, latencies);
+        record_latency("cancel", latencies);
+        counters.report(1000, "cancel");
+        std::cout << "   Note: O(1) complexity (Intrusive List Unlink)\n\n";
+    }
+    
+    static void benchmark_mbo_feed() {
+        std::cout << "Benchmark 5: MBO Feed Encoding\n";
+        const int num_messages = 1000000;
+        
+        // Packet buffers are reused: reset() when the pool is full
+        MboFeedEncoder encoder(1024);
+        std::vector<Order> orders;
+        for (int i = 0; i < 64; ++i) {
+            orders.emplace_back(OrderId(i + 1), Timestamp(0),
+                                (i % 2 == 0) ? Side::BUY : Side::SELL,
+                                from_double(100.0 + (i % 8) * 0.01), Quantity(100));
+        }
+        
+        CounterRegion counters;
+        counters.begin();
+        auto start = std::chrono::high_resolution_clock::now();
+        
+        for (int i = 0; i < num_messages; ++i) {
+            const Order& o = orders[i & 63];
+            Timestamp ts(static_cast<uint64_t>(i));
+            bool ok;
+            switch (i & 3) {
+                case 0:  ok = encoder.on_add(ts, o); break;
+                case 1:  ok = encoder.on_execute(ts, o, Quantity(10), ts.get()); break;
+                case 2:  ok = encoder.on_cancel(ts, o, Quantity(5)); break;
+                default: ok = encoder.on_delete(ts, o); break;
+            }
+            if (!ok) {
+                encoder.reset();
+                --i;
+            }
+        }
+        encoder.flush();
         
         auto end = std::chrono::high_resolution_clock::now();
+        counters.end();
         auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
         
-        std::cout << "   Cancelled: 1000 orders\n";
+        // Same volume through the snprintf text path for comparison
+        std::vector<Event> events;
+        events.reserve(num_messages);
+        for (int i = 0; i < num_messages; ++i) {
+            events.emplace_back(std::in_place_type<TradeEvent>, Timestamp(i), OrderId(i),
+                                OrderId(i + 1), from_double(100.0), Quantity(10));
+        }
+        char buffer[256];
+        volatile char sink = 0;  // Keep the formatting from being optimized out
+        auto text_start = std::chrono::high_resolution_clock::now();
+        for (const auto& e : events) {
+            event_to_buffer(e, buffer, sizeof(buffer));
+            sink = buffer[0];
+        }
+        auto text_end = std::chrono::high_resolution_clock::now();
+        (void)sink;
+        auto text_duration = std::chrono::duration_cast<std::chrono::microseconds>(text_end - text_start);
+        
+        std::cout << "   Encoded: " << encoder.messages_encoded() << " messages\n";
         std::cout << "   Time: " << duration.count() << " μs\n";
-        std::cout << "   Avg per cancel: " << (double)duration.count() / 1000.0 << " μs\n";
-        std::cout << "   Note: O(1) complexity (Intrusive List Unlink)\n\n";
+        std::cout << "   Binary encode: " 
+                  << static_cast<size_t>(num_messages * 1000000.0 / (duration.count() + 1)) 
+                  << " msgs/sec\n";
+        record_rate("mbo_feed", "binary_msgs_per_sec", num_messages * 1e6 / (duration.count() + 1));
+        record_rate("mbo_feed", "text_msgs_per_sec", num_messages * 1e6 / (text_duration.count() + 1));
+        counters.report(num_messages, "mbo_feed");
+        std::cout << "   snprintf to_buffer: " 
+                  << static_cast<size_t>(num_messages * 1000000.0 / (text_duration.count() + 1)) 
+                  << " msgs/sec\n\n";
+    }
+    
+    static void benchmark_batch() {
+        std::cout << "Benchmark 6: Batch Processing\n";
+        const size_t num_cmds = 200000;
+        
+        // Mixed flow: resting adds, crossing adds and cancels of live orders
+        std::vector<Command> cmds;
+        cmds.reserve(num_cmds);
+        std::mt19937_64 rng(42);
+        for (size_t i = 0; i < num_cmds && !workload_; ++i) {
+            uint64_t id = i + 1;
+            if (i > 100 && rng() % 3 == 0) {
+                cmds.push_back(Command::cancel(OrderId(id - 1 - rng() % 100)));
+            } else {
+                Side side = (rng() & 1) ? Side::BUY : Side::SELL;
+                int64_t offset = static_cast<int64_t>(rng() % 20) - 2;
+                double price = side == Side::BUY ? 100.0 - offset * 0.01 : 100.0 + offset * 0.01;
+                cmds.push_back(Command::new_order(OrderId(id), side, from_double(price),
+                                                  Quantity(1 + rng() % 100)));
+            }
+        }
+        
+        if (workload_) cmds = workload_->commands;
+        const size_t n = cmds.size();
+        
+        for (size_t batch_size : {1, 8, 64, 512}) {
+            OrderBook book(n + 1000);
+            CounterRegion counters;
+            counters.begin();
+            
+            auto start = std::chrono::high_resolution_clock::now();
+            for (size_t i = 0; i < n; i += batch_size) {
+                book.process_batch(cmds.data() + i, std::min(batch_size, n - i));
+            }
+            auto end = std::chrono::high_resolution_clock::now();
+            counters.end();
+            auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+            
+            std::cout << "   Batch " << std::setw(3) << batch_size << ": "
+                      << static_cast<size_t>(n * 1000000.0 / (duration.count() + 1))
+                      << " cmds/sec\n";
+            std::string scenario = "batch_" + std::to_string(batch_size);
+            record_rate(scenario, "cmds_per_sec", n * 1e6 / (duration.count() + 1));
+            counters.report(n, scenario);
+        }
+        std::cout << "\n";
+    }
+    
+    static void benchmark_mass_cancel() {
+        std::cout << "Benchmark 7: Mass Cancel vs Individual Cancels\n";
+        const int num_orders = 100000;
+        const int num_owners = 4;
+        
+        // With a workload, the book it leaves behind; ids are cancelled in
+        // submission order either way
+        const size_t capacity = workload_ ? workload_->peak_resting + 1000 : num_orders + 1000;
+        auto populate = [](OrderBook& book) {
+            if (workload_) {
+                for (const Command& cmd : workload_->commands) execute(book, cmd);
+                return;
+            }
+            for (int i = 0; i < num_orders; ++i) {
+                Side side = (i % 2 == 0) ? Side::BUY : Side::SELL;
+                double price = side == Side::BUY ? 99.0 - (i % 100) * 0.01 : 101.0 + (i % 100) * 0.01;
+                book.process_new_order(OrderId(i + 1), side, from_double(price), Quantity(10),
+                                       OwnerId(static_cast<uint32_t>(i % num_owners + 1)));
+            }
+        };
+        auto resting_ids = [](const OrderBook& book, bool owner_only) {
+            std::vector<uint64_t> ids;
+            for (Side side : {Side::BUY, Side::SELL}) {
+                book.for_each_order(side, [&](const Order& o) {
+                    if (!owner_only || o.owner == OwnerId(1)) ids.push_back(o.id.get());
+                });
+            }
+            std::sort(ids.begin(), ids.end());
+            return ids;
+        };
+        auto report = [](const char* label, const char* scenario, size_t cancelled, long long us) {
+            record_time(scenario, "ns_per_order", us * 1000.0 / cancelled);
+            std::cout << "   " << label << ": " << cancelled << " orders in " << us << " μs ("
+                      << std::fixed << std::setprecision(1) 
+                      << (us * 1000.0 / cancelled) << " ns/order)\n";
+            std::cout << std::defaultfloat;
+        };
+        
+        // Whole book: index cleared and pool reset without visiting orders.
+        // The loop cancels in submission order, its best case for locality.
+        {
+            OrderBook loop_book(capacity), mass_book(capacity);
+            populate(loop_book);
+            populate(mass_book);
+            const std::vector<uint64_t> ids = resting_ids(loop_book, false);
+            
+            CounterRegion loop_counters, mass_counters;
+            loop_counters.begin();
+            auto start = std::chrono::high_resolution_clock::now();
+            for (uint64_t id : ids) loop_book.process_cancel(OrderId(id));
+            auto mid = std::chrono::high_resolution_clock::now();
+            loop_counters.end();
+            mass_counters.begin();
+            size_t n = mass_book.process_mass_cancel(MassCancelFilter::all());
+            auto end = std::chrono::high_resolution_clock::now();
+            mass_counters.end();
+            
+            report("All, cancel loop  ", "cancel_loop_all", ids.size(),
+                   std::chrono::duration_cast<std::chrono::microseconds>(mid - start).count());
+            loop_counters.report(ids.size(), "cancel_loop_all");
+            report("All, mass cancel  ", "mass_cancel_all", n,
+                   std::chrono::duration_cast<std::chrono::microseconds>(end - mid).count());
+            mass_counters.report(n, "mass_cancel_all");
+        }
+        
+        // One owner (cancel-on-disconnect): every resting order is scanned,
+        // so this trades throughput for a single atomic command
+        {
+            OrderBook loop_book(capacity), mass_book(capacity);
+            populate(loop_book);
+            populate(mass_book);
+            const std::vector<uint64_t> ids = resting_ids(loop_book, true);
+            
+            CounterRegion loop_counters, mass_counters;
+            loop_counters.begin();
+            auto start = std::chrono::high_resolution_clock::now();
+            for (uint64_t id : ids) loop_book.process_cancel(OrderId(id));
+            auto mid = std::chrono::high_resolution_clock::now();
+            loop_counters.end();
+            mass_counters.begin();
+            size_t n = mass_book.process_mass_cancel(MassCancelFilter::for_owner(OwnerId(1)));
+            auto end = std::chrono::high_resolution_clock::now();
+            mass_counters.end();
+            
+            report("Owner, cancel loop", "cancel_loop_owner", ids.size(),
+                   std::chrono::duration_cast<std::chrono::microseconds>(mid - start).count());
+            loop_counters.report(ids.size(), "cancel_loop_owner");
+            report("Owner, mass cancel", "mass_cancel_owner", n,
+                   std::chrono::duration_cast<std::chrono::microseconds>(end - mid).count());
+            mass_counters.report(n, "mass_cancel_owner");
+        }
+        std::cout << "\n";
+    }
+    
+    static void benchmark_mass_quote() {
+        std::cout << "Benchmark 8: Mass Quote vs Cancel+New Refresh\n";
+        const int num_refreshes = 10000;
+        const int rungs = 20;
+        const int64_t tick = PRICE_SCALE / 100;
+        
+        // Mid follows a one-tick random walk; sizes drift slightly
+        std::mt19937 rng(42);
+        std::uniform_int_distribution<int> step(-1, 1);
+        std::vector<int64_t> mids(num_refreshes);
+        int64_t mid = from_double(100.0).get();
+        for (auto& m : mids) m = (mid += step(rng) * tick);
+        auto rung_qty = [](int r, int i) { return Quantity(10 + static_cast<uint64_t>((r / 4 + i) % 3)); };
+        
+        // Cancel+new: every rung of the previous ladder is pulled and re-entered
+        long long loop_us;
+        CounterRegion loop_counters, quote_counters;
+        {
+            OrderBook book(num_refreshes * 4 * rungs);
+            uint64_t next_id = 1;
+            loop_counters.begin();
+            auto start = std::chrono::high_resolution_clock::now();
+            for (int r = 0; r < num_refreshes; ++r) {
+                if (r > 0) {
+                    for (uint64_t id = next_id - 2 * rungs; id < next_id; ++id) book.process_cancel(OrderId(id));
+                }
+                for (int i = 0; i < rungs; ++i) {
+                    book.process_new_order(OrderId(next_id++), Side::BUY,
+                                           Price(mids[r] - (i + 1) * tick), rung_qty(r, i), OwnerId(1));
+                    book.process_new_order(OrderId(next_id++), Side::SELL,
+                                           Price(mids[r] + (i + 1) * tick), rung_qty(r, i), OwnerId(1));
+                }
+            }
+            auto end = std::chrono::high_resolution_clock::now();
+            loop_counters.end();
+            loop_us = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+        }
+        
+        // Mass quote: rungs at unchanged prices keep their order, only sizes move
+        long long quote_us;
+        {
+            OrderBook book(num_refreshes * 4 * rungs);
+            std::vector<QuoteEntry> bids, asks;
+            bids.reserve(rungs);
+            asks.reserve(rungs);
+            uint64_t next_id = 1;
+            quote_counters.begin();
+            auto start = std::chrono::high_resolution_clock::now();
+            for (int r = 0; r < num_refreshes; ++r) {
+                bids.clear();
+                asks.clear();
+                for (int i = 0; i < rungs; ++i) {
+                    bids.push_back({OrderId(next_id++), Price(mids[r] - (i + 1) * tick), rung_qty(r, i)});
+                    asks.push_back({OrderId(next_id++), Price(mids[r] + (i + 1) * tick), rung_qty(r, i)});
+                }
+                book.process_quote(OwnerId(1), bids.data(), bids.size(), asks.data(), asks.size());
+            }
+            auto end = std::chrono::high_resolution_clock::now();
+            quote_counters.end();
+            quote_us = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+        }
+        
+        auto report = [](const char* label, const char* scenario, long long us) {
+            record_rate(scenario, "refreshes_per_sec", num_refreshes * 1e6 / us);
+            std::cout << "   " << label << ": " << std::fixed << std::setprecision(0)
+                      << (num_refreshes * 1e6 / us) << " refreshes/sec ("
+                      << std::setprecision(1) << (us * 1000.0 / (num_refreshes * 2 * rungs))
+                      << " ns/rung)\n";
+            std::cout << std::defaultfloat;
+        };
+        report("Cancel+new", "quote_refresh_cancel_new", loop_us);
+        loop_counters.report(num_refreshes, "quote_refresh_cancel_new");
+        report("Mass quote", "quote_refresh_mass_quote", quote_us);
+        quote_counters.report(num_refreshes, "quote_refresh_mass_quote");
+        std::cout << "   Speedup: " << std::fixed << std::setprecision(1)
+                  << (static_cast<double>(loop_us) / quote_us) << "x\n\n";
+        std::cout << std::defaultfloat;
+    }
+    
+    static void benchmark_sweep_reporting() {
+        std::cout << "Benchmark 9: Deep Sweep, Per-Fill vs Per-Level Reporting\n";
+        if (workload_) {
+            benchmark_sweep_reporting_workload();
+            return;
+        }
+        const int levels = 10;
+        const int orders_per_level = 1000;
+        const int sweeps = 20;
+        const int resting = levels * orders_per_level;
+        
+        auto run = [&](FillReporting mode, const char* label) {
+            const std::string scenario = mode == FillReporting::PER_FILL ? "sweep_per_fill"
+                                                                         : "sweep_per_level";
+            OrderBook book(sweeps * (resting + 1) * 2);
+            book.set_fill_reporting(mode);
+            HdrHistogram latencies;
+            CounterRegion counters;
+            uint64_t id = 1;
+            for (int s = 0; s < sweeps; ++s) {
+                for (int i = 0; i < resting; ++i) {
+                    book.process_new_order(OrderId(id++), Side::SELL,
+                                           from_double(100.0 + (i / orders_per_level) * 0.01),
+                                           Quantity(1));
+                }
+                size_t log_before = book.get_event_log().size();
+                counters.begin();
+                uint64_t start = TscTimer::start();
+                book.process_new_order(OrderId(id++), Side::BUY, from_double(200.0),
+                                       Quantity(resting));
+                latencies.record(TscTimer::elapsed(start, TscTimer::stop()));
+                counters.end();
+                if (s == 0) {
+                    std::cout << "   " << label << ": " << (book.get_event_log().size() - log_before)
+                              << " log events/sweep, ";
+                }
+            }
+            double mean_ns = TscClock::to_ns(static_cast<uint64_t>(latencies.mean()));
+            std::cout << std::fixed << std::setprecision(1) << (mean_ns / 1000.0)
+                      << " μs/sweep (" << (mean_ns / resting) << " ns/fill, max "
+                      << (TscClock::to_ns(latencies.max()) / 1000.0) << " μs)\n";
+            std::cout << std::defaultfloat;
+            record_time(scenario, "ns_per_fill", mean_ns / resting);
+            record_time(scenario, "max_sweep_ns", TscClock::to_ns(latencies.max()));
+            counters.report(static_cast<uint64_t>(sweeps) * resting, scenario);  // Per fill
+        };
+        run(FillReporting::PER_FILL, "Per-fill ");
+        run(FillReporting::PER_LEVEL, "Per-level");
+        std::cout << "\n";
+    }
+    
+    // The workload replayed in each mode. Every command that trades is
+    // timed, and its time is charged to the passive fills it produced.
+    static void benchmark_sweep_reporting_workload() {
+        for (FillReporting mode : {FillReporting::PER_FILL, FillReporting::PER_LEVEL}) {
+            const bool per_fill = mode == FillReporting::PER_FILL;
+            const std::string scenario = per_fill ? "sweep_per_fill" : "sweep_per_level";
+            OrderBook book(workload_->peak_resting + 1000);
+            book.set_fill_reporting(mode);
+            HdrHistogram latencies;
+            uint64_t fills = 0, trade_cycles = 0, events = 0;
+            for (const Command& cmd : workload_->commands) {
+                size_t log_before = book.get_event_log().size();
+                uint64_t start = TscTimer::start();
+                execute(book, cmd);
+                uint64_t cycles = TscTimer::elapsed(start, TscTimer::stop());
+                
+                const auto& log = book.get_event_log();
+                uint64_t n = 0;
+                for (size_t i = log_before; i < log.size(); ++i) {
+                    if (std::holds_alternative<TradeEvent>(log[i])) ++n;
+                    else if (auto l = std::get_if<LevelTradeEvent>(&log[i])) n += l->fill_count;
+                }
+                if (n == 0) continue;
+                latencies.record(cycles);
+                fills += n;
+                trade_cycles += cycles;
+                events += log.size() - log_before;
+            }
+            double ns_per_fill = TscClock::to_ns(trade_cycles) / static_cast<double>(std::max<uint64_t>(fills, 1));
+            std::cout << "   " << (per_fill ? "Per-fill " : "Per-level") << ": " << std::fixed
+                      << std::setprecision(2) << static_cast<double>(events) / std::max<uint64_t>(latencies.count(), 1)
+                      << " log events/trading order, " << std::setprecision(1) << ns_per_fill
+                      << " ns/fill (max " << (TscClock::to_ns(latencies.max()) / 1000.0) << " μs)\n";
+            std::cout << std::defaultfloat;
+            record_time(scenario, "ns_per_fill", ns_per_fill);
+            record_time(scenario, "max_sweep_ns", TscClock::to_ns(latencies.max()));
+        }
+        std::cout << "\n";
+    }
+    
+    static void benchmark_journal() {
+        std::cout << "Benchmark 10: Binary Journal vs CSV Log\n";
+        const int num_orders = 200000;
+        
+        // Mixed session: random-walk prices, partial crosses, cancels (or
+        // the workload's session)
+        OrderBook book(workload_ ? workload_->peak_resting + 1000 : num_orders * 2);
+        std::mt19937 rng(7);
+        std::uniform_int_distribution<int> step(-2, 2), qty(1, 100), action(0, 3);
+        int64_t mid = from_double(100.0).get();
+        if (workload_) {
+            for (const Command& cmd : workload_->commands) execute(book, cmd);
+        }
+        for (int i = 0; i < num_orders && !workload_; ++i) {
+            if (i > 100 && action(rng) == 0) {
+                book.process_cancel(OrderId(i - 50));
+                continue;
+            }
+            mid += step(rng) * (PRICE_SCALE / 100);
+            Side side = (i % 2 == 0) ? Side::BUY : Side::SELL;
+            int64_t offset = step(rng) * (PRICE_SCALE / 100);
+            book.process_new_order(OrderId(i + 1), side, Price(mid + offset),
+                                   Quantity(static_cast<uint64_t>(qty(rng))));
+        }
+        const auto& log = book.get_event_log();
+        
+        size_t csv_bytes = 0;
+        char line[256];
+        for (const auto& event : log) {
+            event_to_buffer(event, line, sizeof(line));
+            csv_bytes += std::strlen(line) + 1;
+        }
+        
+        CounterRegion encode_counters, decode_counters;
+        encode_counters.begin();
+        auto start = std::chrono::high_resolution_clock::now();
+        JournalWriter writer;
+        writer.append(log);
+        JournalReader reader(writer.finish());
+        auto mid_time = std::chrono::high_resolution_clock::now();
+        encode_counters.end();
+        decode_counters.begin();
+        
+        // Decode several passes into a reused vector
+        const int passes = 10;
+        std::vector<Event> decoded;
+        decoded.reserve(log.size());
+        bool ok = true;
+        for (int p = 0; p < passes; ++p) {
+            decoded.clear();
+            ok = reader.read_all(decoded) && ok;
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        decode_counters.end();
+        
+        double encode_s = std::chrono::duration<double>(mid_time - start).count();
+        double decode_s = std::chrono::duration<double>(end - mid_time).count() / passes;
+        std::cout << "   Events: " << log.size() << (ok ? "" : " (DECODE FAILED)") << "\n";
+        std::cout << "   CSV: " << csv_bytes / 1024 << " KB, journal: "
+                  << reader.size_bytes() / 1024 << " KB (" << std::fixed << std::setprecision(1)
+                  << static_cast<double>(csv_bytes) / reader.size_bytes() << "x smaller, "
+                  << static_cast<double>(reader.size_bytes()) / log.size() << " bytes/event)\n";
+        std::cout << "   Encode: " << (log.size() / encode_s / 1e6) << " M events/sec\n";
+        record_rate("journal", "encode_events_per_sec", log.size() / encode_s);
+        record_rate("journal", "decode_events_per_sec", log.size() / decode_s);
+        BenchReport::global().record("journal", "bytes_per_event",
+                                     static_cast<double>(reader.size_bytes()) / log.size(), "B", false);
+        encode_counters.report(log.size(), "journal_encode");
+        std::cout << "   Decode: " << std::setprecision(1) << (log.size() / decode_s / 1e6)
+                  << " M events/sec, " << std::setprecision(2)
+                  << (log.size() * sizeof(Event) / decode_s / 1e9) << " GB/s as Event, "
+                  << (csv_bytes / decode_s / 1e9) << " GB/s as CSV\n";
+        std::cout << std::defaultfloat;
+        decode_counters.report(log.size() * passes, "journal_decode");
+        std::cout << "\n";
+    }
+    
+    static void benchmark_cumulative_depth() {
+        std::cout << "Benchmark 11: Cumulative Depth Queries (Fenwick vs Walk)\n";
+        const int levels = 2000;
+        const int queries = 100000;
+        const int64_t tick = PRICE_SCALE / 100;
+        const Instrument inst = Instrument::make(Price(tick), Quantity(1), from_double(100.0), 5000);
+        
+        std::mt19937 rng(11);
+        std::uniform_int_distribution<int> level_dist(0, levels - 1);
+        std::vector<Price> limits;
+        std::vector<Quantity> sizes;
+        for (int i = 0; i < queries; ++i) {
+            limits.push_back(Price(from_double(100.0).get() + (1 + level_dist(rng)) * tick));
+            sizes.push_back(Quantity(static_cast<uint64_t>(10 * (1 + level_dist(rng)))));
+        }
+        
+        auto run = [&](bool indexed, const char* label) {
+            OrderBook book(levels * 4);
+            book.set_instrument(inst);
+            book.enable_cumulative_depth(indexed);
+            
+            auto start = std::chrono::high_resolution_clock::now();
+            for (int i = 0; i < levels * 2; ++i) {
+                book.process_new_order(OrderId(i + 1), Side::SELL,
+                                       Price(from_double(100.0).get() + (1 + i / 2) * tick), Quantity(5));
+            }
+            auto built = std::chrono::high_resolution_clock::now();
+            
+            CounterRegion counters;
+            counters.begin();
+            uint64_t checksum = 0;
+            for (int i = 0; i < queries; ++i) {
+                checksum += book.cumulative_volume(Side::SELL, limits[i]).get();
+            }
+            auto mid = std::chrono::high_resolution_clock::now();
+            for (int i = 0; i < queries; ++i) {
+                checksum += static_cast<uint64_t>(book.price_for_depth(Side::SELL, sizes[i])->get());
+            }
+            auto end = std::chrono::high_resolution_clock::now();
+            counters.end();
+            
+            auto ns = [](auto a, auto b) { return std::chrono::duration<double, std::nano>(b - a).count(); };
+            std::cout << "   " << label << ": build " << std::fixed << std::setprecision(1)
+                      << ns(start, built) / (levels * 2) << " ns/order, volume-to-price "
+                      << ns(built, mid) / queries << " ns, price-for-depth "
+                      << ns(mid, end) / queries << " ns (checksum " << checksum % 1000 << ")\n";
+            std::cout << std::defaultfloat;
+            const std::string scenario = indexed ? "cumulative_depth_fenwick" : "cumulative_depth_walk";
+            record_time(scenario, "volume_query_ns", ns(built, mid) / queries);
+            record_time(scenario, "price_query_ns", ns(mid, end) / queries);
+            counters.report(2 * queries, scenario);  // Per query
+        };
+        run(false, "Walk   ");
+        run(true, "Fenwick");
+        std::cout << "\n";
+    }
+
+    static void benchmark_realistic_workload() {
+        std::cout << "Benchmark 12: Realistic Workload (Poisson, power-law prices, 95% cancels)\n";
+        WorkloadConfig config;
+        config.commands = 300000;
+        auto gen_start = std::chrono::high_resolution_clock::now();
+        Workload w = WorkloadGenerator(config).generate();
+        auto gen_end = std::chrono::high_resolution_clock::now();
+        std::cout << "   Generated " << w.commands.size() << " commands in "
+                  << std::chrono::duration_cast<std::chrono::milliseconds>(gen_end - gen_start).count()
+                  << " ms: " << w.adds << " adds, " << w.cancels << " cancels, "
+                  << w.marketable << " marketable (" << w.sweeps << " sweeps), peak "
+                  << w.peak_resting << " resting\n";
+        
+        // Per command type, so cancels do not hide the matching tail
+        OrderBook book(w.peak_resting + 1000);
+        HdrHistogram adds, cancels;
+        CounterRegion counters;
+        counters.begin();
+        auto start = std::chrono::high_resolution_clock::now();
+        for (const Command& cmd : w.commands) {
+            uint64_t t0 = TscTimer::start();
+            execute(book, cmd);
+            uint64_t cycles = TscTimer::elapsed(t0, TscTimer::stop());
+            (cmd.type == CommandType::CANCEL_ORDER ? cancels : adds).record(cycles);
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        counters.end();
+        auto us = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+        std::cout << "   Throughput (timed per call): "
+                  << static_cast<size_t>(w.commands.size() * 1000000.0 / (us + 1)) << " cmds/sec\n";
+        record_rate("realistic", "cmds_per_sec", w.commands.size() * 1e6 / (us + 1));
+        record_latency("realistic_new_order", adds);
+        record_latency("realistic_cancel", cancels);
+        counters.report(w.commands.size(), "realistic");
+        std::cout << "   New orders:\n";
+        print_latency(std::cout, adds);
+        std::cout << "   Cancels:\n";
+        print_latency(std::cout, cancels);
+        std::cout << "\n";
+    }
+
+    struct OpenLoopResult {
+        HdrHistogram response;  // From intended send time (CO-corrected)
+        HdrHistogram service;   // From actual start of processing
+        double achieved_rate = 0.0;
+    };
+
+    // Feeds the inputs on a fixed schedule of `rate` messages/sec. A message
+    // that falls behind schedule is sent as soon as the engine is free, and
+    // its latency still counts from when it should have been sent, so a
+    // stall is charged to every message queued behind it. rate <= 0 sends
+    // back to back (closed loop).
+    static OpenLoopResult run_open_loop(const std::vector<Event>& inputs, double rate) {
+        OpenLoopResult r;
+        // Room for the trades too: a log reallocation mid-run would show
+        // up as a multi-millisecond stall
+        OrderBook book(inputs.size() * 2 + 1000);
+        EventApplier applier(book);
+        const double interval = rate > 0 ? TscClock::ticks_per_ns() * 1e9 / rate : 0.0;
+        
+        const uint64_t first = TscTimer::start();
+        uint64_t done = first;
+        for (size_t i = 0; i < inputs.size(); ++i) {
+            uint64_t intended = first + static_cast<uint64_t>(i * interval);
+            uint64_t begin = TscTimer::start();
+            while (begin < intended) begin = TscTimer::start();
+            applier.apply(inputs[i]);
+            done = TscTimer::stop();
+            r.response.record(TscTimer::elapsed(rate > 0 ? intended : begin, done));
+            r.service.record(TscTimer::elapsed(begin, done));
+        }
+        r.achieved_rate = inputs.size() / (TscClock::to_ns(done - first) / 1e9);
+        return r;
+    }
+
+    static void benchmark_open_loop() {
+        std::cout << "Benchmark 13: Open-Loop Trace Replay (coordinated-omission corrected)\n";
+        std::vector<Event> inputs;
+        if (!trace_.empty()) {
+            inputs = ReplayEngine::load_log(trace_);
+            std::cout << "   Trace: " << trace_ << "\n";
+        } else {
+            // Record a session from the generator and reload it as a trace
+            WorkloadConfig config;
+            config.commands = 200000;
+            config.seed = 11;
+            Workload w = WorkloadGenerator(config).generate();
+            OrderBook recorder(w.peak_resting + 1000);
+            for (const Command& cmd : w.commands) execute(recorder, cmd);
+            const std::string path = "open_loop_trace.csv";
+            ReplayEngine::save_log(recorder.get_event_log(), path);
+            inputs = ReplayEngine::load_log(path);
+            std::remove(path.c_str());
+        }
+        if (inputs.empty()) {
+            std::cout << "   (empty trace)\n\n";
+            return;
+        }
+        
+        CounterRegion counters;
+        counters.begin();
+        OpenLoopResult closed = run_open_loop(inputs, 0.0);
+        counters.end();
+        const double capacity = closed.achieved_rate;
+        std::cout << "   Messages: " << inputs.size() << ", closed-loop capacity "
+                  << static_cast<size_t>(capacity) << " msgs/sec\n";
+        record_rate("open_loop", "capacity_msgs_per_sec", capacity);
+        counters.report(inputs.size(), "open_loop");
+        std::cout << "   " << std::setw(6) << "load" << std::setw(12) << "offered/s"
+                  << std::setw(12) << "achieved/s" << std::setw(11) << "p50 ns"
+                  << std::setw(11) << "p99 ns" << std::setw(12) << "p99.9 ns"
+                  << std::setw(12) << "max ns" << std::setw(13) << "svc p99 ns" << "\n";
+        
+        auto ns = [](uint64_t c) { return static_cast<uint64_t>(TscClock::to_ns(c)); };
+        for (double load : {0.25, 0.5, 0.7, 0.8, 0.9, 0.95, 1.0, 1.1}) {
+            OpenLoopResult r = run_open_loop(inputs, capacity * load);
+            const std::string scenario = "open_loop_" + std::to_string(static_cast<int>(load * 100));
+            record_time(scenario, "p50_ns", TscClock::to_ns(r.response.value_at_percentile(50)));
+            record_time(scenario, "p99_ns", TscClock::to_ns(r.response.value_at_percentile(99)));
+            record_time(scenario, "p99_9_ns", TscClock::to_ns(r.response.value_at_percentile(99.9)));
+            std::cout << "   " << std::setw(5) << static_cast<int>(load * 100) << "%"
+                      << std::setw(12) << static_cast<size_t>(capacity * load)
+                      << std::setw(12) << static_cast<size_t>(r.achieved_rate)
+                      << std::setw(11) << ns(r.response.value_at_percentile(50))
+                      << std::setw(11) << ns(r.response.value_at_percentile(99))
+                      << std::setw(12) << ns(r.response.value_at_percentile(99.9))
+                      << std::setw(12) << ns(r.response.max())
+                      << std::setw(13) << ns(r.service.value_at_percentile(99)) << "\n";
+        }
+        std::cout << "   (closed loop reports service time only: p99 "
+                  << ns(closed.service.value_at_percentile(99)) << " ns)\n\n";
+    }
+
+    // Inline: one thread matches and journals each command. Pipelined: the
+    // same commands through Pipeline's ingress/match/journal/publish threads,
+    // pinned to CPUs 1-4 when the machine has that many to spare. Both
+    // journal to an AsyncJournal file.
+    static void benchmark_pipeline() {
+        std::cout << "Benchmark 14: Pipelined Runtime (ingress -> match -> journal -> publish)\n";
+        WorkloadConfig wconfig;
+        wconfig.commands = 200000;
+        wconfig.seed = 14;
+        Workload w = WorkloadGenerator(wconfig).generate();
+        const size_t capacity = w.commands.size() * 2 + 1000;
+        
+        const std::string path = "bench_pipeline.jnl";
+        double inline_rate;
+        {
+            OrderBook book(capacity);
+            AsyncJournal journal(path);
+            auto start = std::chrono::high_resolution_clock::now();
+            for (const Command& cmd : w.commands) {
+                execute(book, cmd);
+                for (const Event& e : book.get_event_log()) journal.append(e);
+                book.clear_event_log();
+            }
+            auto end = std::chrono::high_resolution_clock::now();
+            auto us = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+            inline_rate = w.commands.size() * 1e6 / (us + 1);
+        }
+        
+        PipelineConfig config;
+        config.book_capacity = capacity;
+        config.journal_path = path;
+        const bool pinned = std::thread::hardware_concurrency() >= 5;
+        if (pinned) {
+            config.ingress_cpu = 1;
+            config.match_cpu = 2;
+            config.journal_cpu = 3;
+            config.publish_cpu = 4;
+        }
+        Pipeline pipeline(config);
+        uint64_t events = 0;
+        pipeline.subscribe([&events](const PipelineEvent&) { ++events; });
+        pipeline.start();
+        auto start = std::chrono::high_resolution_clock::now();
+        for (const Command& cmd : w.commands) pipeline.submit(cmd);
+        pipeline.stop();
+        auto end = std::chrono::high_resolution_clock::now();
+        auto us = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+        double pipeline_rate = w.commands.size() * 1e6 / (us + 1);
+        
+        std::cout << "   Inline (match + journal): " << static_cast<size_t>(inline_rate) << " cmds/sec\n";
+        std::cout << "   Pipelined (" << (pinned ? "pinned" : "unpinned, < 5 CPUs") << "): "
+                  << static_cast<size_t>(pipeline_rate) << " cmds/sec, " << events
+                  << " events published\n";
+        record_rate("pipeline_inline", "cmds_per_sec", inline_rate);
+        record_rate("pipeline", "cmds_per_sec", pipeline_rate);
+        for (size_t i = 0; i < Pipeline::HOPS; ++i) {
+            auto hop = pipeline.hop(static_cast<PipelineHop>(i));
+            const std::string scenario = std::string("pipeline_") + to_string(static_cast<PipelineHop>(i));
+            record_time(scenario, "mean_ns", TscClock::to_ns(static_cast<uint64_t>(hop.mean())));
+            record_time(scenario, "p99_ns", TscClock::to_ns(hop.percentile(99)));
+        }
+        std::cout << "   Per-hop latency (log2 buckets, one sample per command):\n";
+        pipeline.dump(std::cout);
+        std::cout << "\n";
+        std::remove(path.c_str());
+    }
+
+    // Continuous journal cost on the matching thread
+    static void benchmark_async_journal() {
+        std::cout << "Benchmark 15: Async Group-Commit Journal (1 ms fdatasync window)\n";
+        WorkloadConfig wconfig;
+        wconfig.commands = 300000;
+        wconfig.seed = 15;
+        Workload w = WorkloadGenerator(wconfig).generate();
+        const std::string path = "bench_async_journal.jnl";
+        
+        auto run = [&](const char* label, const char* scenario,
+                       std::optional<AsyncJournalConfig> config) {
+            OrderBook book(w.commands.size() * 2 + 1000);
+            std::optional<AsyncJournal> journal;
+            if (config) {
+                journal.emplace(path, *config);
+                book.attach_event_sink(&*journal);
+            }
+            CounterRegion counters;
+            counters.begin();
+            auto start = std::chrono::high_resolution_clock::now();
+            for (const Command& cmd : w.commands) execute(book, cmd);
+            auto end = std::chrono::high_resolution_clock::now();
+            counters.end();
+            auto us = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+            double rate = w.commands.size() * 1e6 / (us + 1);
+            std::cout << "   " << label << ": " << static_cast<size_t>(rate) << " cmds/sec";
+            record_rate(scenario, "cmds_per_sec", rate);
+            if (journal) {
+                // Time for the tail to become durable once appends stop
+                auto drain_start = std::chrono::high_resolution_clock::now();
+                journal->wait_durable(journal->appended(), std::chrono::seconds(30));
+                auto drained = std::chrono::high_resolution_clock::now();
+                book.attach_event_sink(nullptr);
+                journal->close();
+                auto stats = journal->stats();
+                double drain_us = std::chrono::duration<double, std::micro>(drained - drain_start).count();
+                std::cout << " [" << journal->backend() << "] " << stats.writes << " writes, "
+                          << stats.syncs << " syncs, " << stats.spilled << " spilled, ";
+                if (stats.segments) std::cout << stats.segments << " segments, ";
+                std::cout << "tail durable in " << static_cast<size_t>(drain_us) << " us";
+                record_time(scenario, "tail_durable_ns", drain_us * 1000.0);
+                std::filesystem::remove_all(path);
+            }
+            std::cout << "\n";
+            counters.report(w.commands.size(), scenario);
+        };
+        AsyncJournalConfig uring, pwrite, segmented;
+        pwrite.use_io_uring = false;
+        segmented.segment_bytes = 1 << 20;
+        run("No journal    ", "journal_none", std::nullopt);
+        run("io_uring      ", "journal_io_uring", uring);
+        run("pwrite        ", "journal_pwrite", pwrite);
+        run("1 MiB segments", "journal_segmented", segmented);
+        std::cout << "\n";
+    }
+
+    // Per-event cost of journal record checksums
+    static void benchmark_crc32c() {
+        std::cout << "Benchmark 16: CRC32C Record Checksums (" << ASYNC_JOURNAL_RECORD_HEADER_SIZE
+                  << "-byte headers, 4096-event records)\n";
+        WorkloadConfig wconfig;
+        wconfig.commands = 300000;
+        wconfig.seed = 16;
+        Workload w = WorkloadGenerator(wconfig).generate();
+        OrderBook book(w.peak_resting + 1000);
+        for (const Command& cmd : w.commands) execute(book, cmd);
+        const auto& log = book.get_event_log();
+
+        // The payloads the async journal writer would checksum
+        std::vector<std::vector<uint8_t>> payloads;
+        JournalBlockEncoder encoder;
+        size_t bytes = 0;
+        for (size_t i = 0; i < log.size(); i += 4096) {
+            encoder.reset();
+            for (size_t j = i; j < std::min(log.size(), i + 4096); ++j) encoder.add(log[j]);
+            payloads.push_back(encoder.payload());
+            bytes += encoder.payload().size();
+        }
+        uint8_t header[ASYNC_JOURNAL_RECORD_HEADER_SIZE] = {};
+
+        auto run = [&](const char* label, const char* scenario, auto&& crc) {
+            const int passes = 20;
+            volatile uint32_t sink = 0;  // Keep the checksums from being optimized out
+            auto start = std::chrono::high_resolution_clock::now();
+            for (int p = 0; p < passes; ++p) {
+                for (const auto& payload : payloads) {
+                    uint32_t c = crc(0, header, ASYNC_JOURNAL_CRC_OFFSET);
+                    sink = crc(c, payload.data(), payload.size());
+                }
+            }
+            auto end = std::chrono::high_resolution_clock::now();
+            double s = std::chrono::duration<double>(end - start).count() / passes;
+            double ns_per_event = s * 1e9 / log.size();
+            std::cout << "   " << label << ": " << std::fixed << std::setprecision(2) << ns_per_event
+                      << " ns/event, " << (bytes / s / 1e9) << " GB/s" << std::defaultfloat << "\n";
+            (void)sink;
+            record_time(scenario, "ns_per_event", ns_per_event);
+        };
+        std::cout << "   Events: " << log.size() << ", " << std::fixed << std::setprecision(1)
+                  << static_cast<double>(bytes) / log.size() << " payload bytes/event"
+                  << std::defaultfloat << "\n";
+#if MATCHING_ENGINE_HAS_CRC32_INSN
+        if (crc32c::hardware_available()) {
+            run("SSE4.2 crc32", "crc32c_hardware", crc32c::extend_hardware);
+        }
+#endif
+        run("Software    ", "crc32c_software", crc32c::extend_software);
+        std::cout << "\n";
+    }
+
+    // Read replica tailing the live journal
+    static void benchmark_replica() {
+        std::cout << "Benchmark 17: Journal-Tailing Read Replica\n";
+        WorkloadConfig wconfig;
+        wconfig.commands = 300000;
+        wconfig.seed = 17;
+        Workload w = WorkloadGenerator(wconfig).generate();
+        const std::string path = "bench_replica.jnl";
+        std::filesystem::remove_all(path);
+
+        JournalReplica replica(path, w.peak_resting + 1000);
+        std::atomic<uint64_t> expected{std::numeric_limits<uint64_t>::max()};
+        std::chrono::high_resolution_clock::time_point caught_up;
+        std::thread tail([&] {
+            while (replica.applied() != expected.load(std::memory_order_acquire)) {
+                if (replica.poll() == 0) replica.wait(std::chrono::milliseconds(1));
+            }
+            caught_up = std::chrono::high_resolution_clock::now();
+        });
+
+        OrderBook book(w.peak_resting + 1000);
+        AsyncJournal journal(path, AsyncJournalConfig());
+        book.attach_event_sink(&journal);
+        auto start = std::chrono::high_resolution_clock::now();
+        for (const Command& cmd : w.commands) execute(book, cmd);
+        auto end = std::chrono::high_resolution_clock::now();
+        book.attach_event_sink(nullptr);
+        journal.close();
+        expected.store(journal.appended(), std::memory_order_release);
+        tail.join();
+
+        double s = std::chrono::duration<double>(end - start).count();
+        double catch_up_us = std::chrono::duration<double, std::micro>(caught_up - end).count();
+        ReplicaLag worst = replica.max_lag();
+        bool same = replica.book().order_count() == book.order_count() &&
+                    replica.book().best_bid() == book.best_bid() &&
+                    replica.book().best_ask() == book.best_ask();
+        std::cout << "   Primary with journal + replica: " << static_cast<size_t>(w.commands.size() / s)
+                  << " cmds/sec\n";
+        std::cout << "   Replica applied " << replica.applied() << " events"
+                  << (same ? " (book matches)" : " (BOOK MISMATCH)") << ", caught up "
+                  << static_cast<size_t>(catch_up_us) << " us after the last command\n";
+        std::cout << "   Max lag: " << worst.events << " events, "
+                  << static_cast<size_t>(worst.ns / 1000) << " us (record sealed -> applied)\n";
+        record_rate("replica", "primary_cmds_per_sec", w.commands.size() / s);
+        record_time("replica", "max_lag_ns", static_cast<double>(worst.ns));
+        BenchReport::global().record("replica", "max_lag_events", static_cast<double>(worst.events),
+                                     "events", false);
+        std::filesystem::remove_all(path);
+        std::cout << "\n";
     }
 };
 
@@ -139,8 +1217,13 @@ private:
 
 class StressTest {
 public:
-    static void run_stress_test() {
+    // With a workload, its commands replace the synthetic flow
+    static void run_stress_test(const Workload* workload = nullptr) {
         std::cout << "\n========== STRESS TEST ==========\n\n";
+        if (workload) {
+            run_workload(*workload);
+            return;
+        }
         
         const int TOTAL_OPS = 1000000;
         std::cout << "Running 1 million order test...\n";
@@ -148,6 +1231,8 @@ public:
         // IMPORTANT: Pre-allocate enough space for the stress test
         // ObjectPool does NOT resize to guarantee pointer validity.
         OrderBook book(TOTAL_OPS + 100000);
+        CounterRegion counters;
+        counters.begin();
         
         auto start = std::chrono::high_resolution_clock::now();
         
@@ -170,14 +1255,36 @@ public:
         }
         
         auto end = std::chrono::high_resolution_clock::now();
+        counters.end();
         auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
         
         std::cout << "   ✓ Processed 1,000,000 orders\n";
         std::cout << "   Time: " << duration.count() / 1000.0 << " seconds\n";
         std::cout << "   Throughput: " << (size_t)(TOTAL_OPS * 1000.0 / duration.count()) << " orders/sec\n";
+        record_rate("stress", "orders_per_sec", TOTAL_OPS * 1000.0 / duration.count());
+        counters.report(TOTAL_OPS, "stress");
     }
 
 private:
+    static void run_workload(const Workload& workload) {
+        const size_t n = workload.commands.size();
+        std::cout << "Running " << n << " workload commands...\n";
+        OrderBook book(workload.peak_resting + 1000);
+        CounterRegion counters;
+        counters.begin();
+        auto start = std::chrono::high_resolution_clock::now();
+        for (const Command& cmd : workload.commands) execute(book, cmd);
+        auto end = std::chrono::high_resolution_clock::now();
+        counters.end();
+        auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
+        
+        std::cout << "   ✓ Processed " << n << " commands, " << book.order_count() << " resting\n";
+        std::cout << "   Time: " << duration.count() / 1000.0 << " seconds\n";
+        std::cout << "   Throughput: " << (size_t)(n * 1000.0 / (duration.count() + 1)) << " cmds/sec\n";
+        record_rate("stress", "orders_per_sec", n * 1000.0 / (duration.count() + 1));
+        counters.report(n, "stress");
+    }
+
     static Price from_double(double p) {
         return Price(static_cast<int64_t>(p * PRICE_SCALE));
     }
@@ -187,6 +1294,9 @@ private:
 // COMPARISON TEST
 // ============================================================================
 
+// Deliberate extremes (every order matches / every order rests / a fixed
+// mix), so these keep their synthetic flow even with --workload; the
+// realistic mix is Benchmark 12.
 class ComparisonTest {
 public:
     static void compare_scenarios() {
@@ -211,6 +1321,8 @@ private:
         const int num_pairs = 50000;
         OrderBook book(num_pairs * 2 + 1000);
         
+        CounterRegion counters;
+        counters.begin();
         auto start = std::chrono::high_resolution_clock::now();
         
         for (int i = 0; i < num_pairs; ++i) {
@@ -219,17 +1331,22 @@ private:
         }
         
         auto end = std::chrono::high_resolution_clock::now();
+        counters.end();
         auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
         
         std::cout << "   Time: " << duration.count() << " ms\n";
         std::cout << "   Throughput: " << (num_pairs * 2 * 1000) / (duration.count() + 1) // +1 avoid div by zero
                   << " orders/sec\n";
+        record_rate("scenario_all_match", "orders_per_sec", num_pairs * 2 * 1000.0 / (duration.count() + 1));
+        counters.report(num_pairs * 2, "scenario_all_match");
     }
     
     static void benchmark_scenario_all_rest() {
         const int num_orders = 100000;
         OrderBook book(num_orders + 1000);
         
+        CounterRegion counters;
+        counters.begin();
         auto start = std::chrono::high_resolution_clock::now();
         
         for (int i = 0; i < num_orders; ++i) {
@@ -239,17 +1356,22 @@ private:
         }
         
         auto end = std::chrono::high_resolution_clock::now();
+        counters.end();
         auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
         
         std::cout << "   Time: " << duration.count() << " ms\n";
         std::cout << "   Throughput: " << (num_orders * 1000) / (duration.count() + 1)
                   << " orders/sec\n";
+        record_rate("scenario_all_rest", "orders_per_sec", num_orders * 1000.0 / (duration.count() + 1));
+        counters.report(num_orders, "scenario_all_rest");
     }
     
     static void benchmark_scenario_mixed() {
         const int num_orders = 100000;
         OrderBook book(num_orders + 1000);
         
+        CounterRegion counters;
+        counters.begin();
         auto start = std::chrono::high_resolution_clock::now();
         
         for (int i = 0; i < num_orders; ++i) {
@@ -260,11 +1382,14 @@ private:
         }
         
         auto end = std::chrono::high_resolution_clock::now();
+        counters.end();
         auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
         
         std::cout << "   Time: " << duration.count() << " ms\n";
         std::cout << "   Throughput: " << (num_orders * 1000) / (duration.count() + 1)
                   << " orders/sec\n";
+        record_rate("scenario_mixed", "orders_per_sec", num_orders * 1000.0 / (duration.count() + 1));
+        counters.report(num_orders, "scenario_mixed");
     }
 };
 
@@ -272,15 +1397,72 @@ private:
 // MAIN
 // ============================================================================
 
-int main() {
+// Usage: matching_engine_benchmarks [--workload realistic] [--seed N] [--trace FILE]
+//                                   [--counters]
+int main(int argc, char** argv) {
     std::cout << "╔════════════════════════════════════════════════════════════╗\n";
     std::cout << "║           PERFORMANCE BENCHMARK SUITE                      ║\n";
     std::cout << "╚════════════════════════════════════════════════════════════╝\n";
     
+    bool realistic = false;
+    WorkloadConfig config;
+    std::string trace;
+    std::string json;
+    int repeat = 1;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--workload" && i + 1 < argc) {
+            realistic = std::string(argv[++i]) == "realistic";
+        } else if (arg == "--seed" && i + 1 < argc) {
+            config.seed = std::stoull(argv[++i]);
+        } else if (arg == "--trace" && i + 1 < argc) {
+            trace = argv[++i];
+        } else if (arg == "--counters") {
+            CounterRegion::enabled = true;
+        } else if (arg == "--json" && i + 1 < argc) {
+            json = argv[++i];
+        } else if (arg == "--repeat" && i + 1 < argc) {
+            repeat = std::max(1, std::atoi(argv[++i]));
+        }
+    }
+    
+    BenchReport& report = BenchReport::global();
+    report.set_config("git", MATCHING_ENGINE_GIT_HASH);
+    report.set_config("build_type", MATCHING_ENGINE_BUILD_TYPE);
+    report.set_config("compiler", __VERSION__);
+    report.set_config("probes", MATCHING_ENGINE_PROBES ? "on" : "off");
+    report.set_config("counters", CounterRegion::enabled ? "on" : "off");
+    report.set_config("workload", realistic ? "realistic" : "default");
+    report.set_config("seed", std::to_string(config.seed));
+    report.set_config("trace", trace.empty() ? "generated" : trace);
+    report.set_config("repeat", std::to_string(repeat));
+    
     try {
-        Benchmark::run_all_benchmarks();
-        ComparisonTest::compare_scenarios();
-        StressTest::run_stress_test();
+        std::optional<Workload> workload;
+        if (realistic) {
+            workload = WorkloadGenerator(config).generate();
+            std::cout << "\nWorkload: " << workload->commands.size() << " commands, seed "
+                      << config.seed << "\n";
+        }
+        for (int run = 1; run <= repeat; ++run) {
+            if (repeat > 1) std::cout << "\n========== RUN " << run << " of " << repeat << " ==========\n";
+            Benchmark::run_all_benchmarks(workload ? &*workload : nullptr, trace);
+            ComparisonTest::compare_scenarios();
+            StressTest::run_stress_test(workload ? &*workload : nullptr);
+        }
+#if MATCHING_ENGINE_PROBES
+        std::cout << "\n========== LATENCY PROBES (whole run) ==========\n";
+        LatencyProbes::dump(std::cout);
+#endif
+        
+        if (!json.empty()) {
+            if (!report.save(json)) {
+                std::cerr << "Cannot write " << json << "\n";
+                return 1;
+            }
+            std::cout << "\nResults written to " << json << " (" << report.metrics().size()
+                      << " metrics)\n";
+        }
         
         std::cout << "\n✅ All benchmarks completed successfully!\n";
         return 0;
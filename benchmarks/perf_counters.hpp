@@ -0,0 +1,204 @@
+#ifndef PERF_COUNTERS_HPP
+#define PERF_COUNTERS_HPP
+
+#include <array>
+#include <string>
+#include <ostream>
+#include <iomanip>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <cerrno>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// ============================================================================
+// PERF COUNTERS - Hardware counter groups via perf_event_open
+// ============================================================================
+//
+// One group per benchmark region, counting user-space events of the calling
+// thread only. Counters the CPU or kernel refuse (virtual machines often
+// expose none; perf_event_paranoid may forbid them) are left out and the
+// rest still count. If even the cycles leader cannot open, the group is
+// unavailable and reports why instead of numbers. When the kernel has to
+// multiplex, values are scaled by time enabled / time running.
+
+enum class PerfEvent : uint8_t {
+    CYCLES = 0,
+    INSTRUCTIONS = 1,
+    L1D_MISSES = 2,         // L1D read misses
+    LLC_MISSES = 3,         // Last-level cache misses
+    DTLB_MISSES = 4,        // dTLB read misses
+    BRANCH_MISSES = 5,
+    COUNT = 6
+};
+
+struct PerfSample {
+    static constexpr size_t EVENTS = static_cast<size_t>(PerfEvent::COUNT);
+
+    std::array<uint64_t, EVENTS> values{};
+    std::array<bool, EVENTS> valid{};
+
+    bool has(PerfEvent e) const { return valid[static_cast<size_t>(e)]; }
+    uint64_t get(PerfEvent e) const { return values[static_cast<size_t>(e)]; }
+
+    // Sums another region into this one; an event counts if either has it
+    void add(const PerfSample& other) {
+        for (size_t i = 0; i < EVENTS; ++i) {
+            values[i] += other.values[i];
+            valid[i] = valid[i] || other.valid[i];
+        }
+    }
+};
+
+class PerfCounterGroup {
+public:
+    PerfCounterGroup() {
+        fds_.fill(-1);
+#if defined(__linux__)
+        for (size_t i = 0; i < PerfSample::EVENTS; ++i) {
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            configure(static_cast<PerfEvent>(i), attr);
+            attr.disabled = leader() < 0 ? 1 : 0;   // The leader gates the group
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_ID |
+                               PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            long fd = syscall(SYS_perf_event_open, &attr, 0, -1, leader(), 0);
+            if (fd < 0) {
+                if (i == 0) {
+                    error_ = std::string("perf_event_open: ") + std::strerror(errno);
+                    return;
+                }
+                continue;
+            }
+            fds_[i] = static_cast<int>(fd);
+            ioctl(fds_[i], PERF_EVENT_IOC_ID, &ids_[i]);
+        }
+#else
+        error_ = "perf_event_open is Linux-only";
+#endif
+    }
+
+    ~PerfCounterGroup() {
+#if defined(__linux__)
+        for (int fd : fds_) {
+            if (fd >= 0) close(fd);
+        }
+#endif
+    }
+
+    PerfCounterGroup(const PerfCounterGroup&) = delete;
+    PerfCounterGroup& operator=(const PerfCounterGroup&) = delete;
+
+    bool available() const { return leader() >= 0; }
+    const std::string& error() const { return error_; }
+
+    void start() {
+#if defined(__linux__)
+        if (!available()) return;
+        ioctl(leader(), PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(leader(), PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#endif
+    }
+
+    PerfSample stop() {
+        PerfSample sample;
+#if defined(__linux__)
+        if (!available()) return sample;
+        ioctl(leader(), PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+
+        // { nr, time_enabled, time_running, { value, id } [nr] }
+        uint64_t buf[3 + 2 * PerfSample::EVENTS] = {};
+        if (read(leader(), buf, sizeof(buf)) < 0 || buf[2] == 0) return sample;
+        double scale = static_cast<double>(buf[1]) / static_cast<double>(buf[2]);
+        for (uint64_t n = 0; n < buf[0] && n < PerfSample::EVENTS; ++n) {
+            uint64_t value = buf[3 + 2 * n];
+            uint64_t id = buf[4 + 2 * n];
+            for (size_t i = 0; i < PerfSample::EVENTS; ++i) {
+                if (fds_[i] >= 0 && ids_[i] == id) {
+                    sample.values[i] = static_cast<uint64_t>(value * scale);
+                    sample.valid[i] = true;
+                }
+            }
+        }
+#endif
+        return sample;
+    }
+
+private:
+    int leader() const { return fds_[0]; }
+
+#if defined(__linux__)
+    static void configure(PerfEvent event, perf_event_attr& attr) {
+        auto cache = [](uint64_t cache_id) {
+            return cache_id | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                   (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        };
+        switch (event) {
+            case PerfEvent::CYCLES:
+                attr.type = PERF_TYPE_HARDWARE;
+                attr.config = PERF_COUNT_HW_CPU_CYCLES;
+                break;
+            case PerfEvent::INSTRUCTIONS:
+                attr.type = PERF_TYPE_HARDWARE;
+                attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+                break;
+            case PerfEvent::L1D_MISSES:
+                attr.type = PERF_TYPE_HW_CACHE;
+                attr.config = cache(PERF_COUNT_HW_CACHE_L1D);
+                break;
+            case PerfEvent::LLC_MISSES:
+                attr.type = PERF_TYPE_HARDWARE;
+                attr.config = PERF_COUNT_HW_CACHE_MISSES;
+                break;
+            case PerfEvent::DTLB_MISSES:
+                attr.type = PERF_TYPE_HW_CACHE;
+                attr.config = cache(PERF_COUNT_HW_CACHE_DTLB);
+                break;
+            case PerfEvent::BRANCH_MISSES:
+                attr.type = PERF_TYPE_HARDWARE;
+                attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+                break;
+            case PerfEvent::COUNT:
+                break;
+        }
+    }
+#endif
+
+    std::array<int, PerfSample::EVENTS> fds_;
+    std::array<uint64_t, PerfSample::EVENTS> ids_{};
+    std::string error_;
+};
+
+// One line of per-operation counter values; events that did not open are
+// left out
+inline void print_counters(std::ostream& out, const PerfSample& s, uint64_t ops) {
+    if (ops == 0 || !s.has(PerfEvent::CYCLES)) {
+        out << "   Counters: unavailable\n";
+        return;
+    }
+    auto per_op = [ops](uint64_t v) { return static_cast<double>(v) / ops; };
+    out << std::fixed << std::setprecision(2) << "   Counters/op: cycles "
+        << per_op(s.get(PerfEvent::CYCLES));
+    if (s.has(PerfEvent::INSTRUCTIONS)) {
+        out << ", instr " << per_op(s.get(PerfEvent::INSTRUCTIONS)) << " (IPC "
+            << static_cast<double>(s.get(PerfEvent::INSTRUCTIONS)) / s.get(PerfEvent::CYCLES) << ")";
+    }
+    if (s.has(PerfEvent::L1D_MISSES)) out << ", L1D miss " << per_op(s.get(PerfEvent::L1D_MISSES));
+    if (s.has(PerfEvent::LLC_MISSES)) out << ", LLC miss " << per_op(s.get(PerfEvent::LLC_MISSES));
+    if (s.has(PerfEvent::DTLB_MISSES)) out << ", dTLB miss " << per_op(s.get(PerfEvent::DTLB_MISSES));
+    if (s.has(PerfEvent::BRANCH_MISSES)) {
+        out << ", br miss " << per_op(s.get(PerfEvent::BRANCH_MISSES));
+    }
+    out << "\n" << std::defaultfloat;
+}
+
+#endif
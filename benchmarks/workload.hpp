@@ -0,0 +1,273 @@
+#ifndef WORKLOAD_HPP
+#define WORKLOAD_HPP
+
+#include "../src/orderbook.hpp"
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <algorithm>
+#include <random>
+#include <cmath>
+#include <cstdint>
+#include <cstddef>
+
+// ============================================================================
+// WORKLOAD GENERATOR - Seeded synthetic order flow with venue-like shape
+// ============================================================================
+//
+// Commands are generated against a shadow OrderBook, so every cancel names
+// an order that is actually resting and every aggressive order prices off
+// the real touch. The flow is:
+//   - Poisson arrivals: exponential gaps at arrival_rate per second
+//   - Passive adds at a power-law distance (in ticks) behind the best
+//     non-crossing price
+//   - Lognormal sizes, rounded to whole units
+//   - cancels_per_trade cancels for each marketable order (20 -> ~95% of
+//     removals are cancels)
+//   - Cancels biased to the back of the queue: a randomly drawn resting
+//     order picks the price level (so busy levels see more cancels), and
+//     the rearmost of cancel_tournament random positions in that level's
+//     queue is pulled
+//   - Occasional sweeps that clear the opposite side to sweep_ticks deep
+// Adds are steered so the book hovers around target_resting orders.
+//
+// Randomness comes only from std::mt19937_64, whose sequence the standard
+// fixes, through local transforms rather than the implementation-defined
+// std:: distributions: a seed yields the same commands with any standard
+// library (up to libm rounding in log/exp/pow).
+
+struct WorkloadConfig {
+    uint64_t seed = 42;
+    size_t commands = 1000000;
+    double arrival_rate = 1e6;              // Commands per second
+    Price mid = Price(100 * PRICE_SCALE);   // Reference price while a side is empty
+    Price tick = Price(PRICE_SCALE / 100);
+    size_t target_resting = 10000;
+    double distance_alpha = 1.2;            // Pareto tail of ticks behind the touch
+    int32_t max_distance_ticks = 500;
+    double size_log_mean = 3.0;             // Median size e^3 ~ 20
+    double size_log_sigma = 1.0;
+    uint64_t max_size = 10000;
+    double cancels_per_trade = 20.0;
+    size_t cancel_tournament = 4;           // 1 = uniform queue position
+    double sweep_probability = 0.01;        // Share of marketable orders
+    int32_t sweep_ticks = 5;
+    uint32_t owners = 64;
+};
+
+struct Workload {
+    std::vector<Command> commands;
+    std::vector<uint64_t> arrival_ns;       // Intended send time of each command
+    size_t adds = 0;
+    size_t cancels = 0;
+    size_t marketable = 0;                  // Includes sweeps
+    size_t sweeps = 0;
+    size_t peak_resting = 0;                // Pool capacity needed to replay
+
+    double duration_seconds() const {
+        return arrival_ns.empty() ? 0.0 : arrival_ns.back() / 1e9;
+    }
+};
+
+class WorkloadGenerator {
+public:
+    explicit WorkloadGenerator(const WorkloadConfig& config)
+        : config_(config), rng_(config.seed), shadow_(config.commands + 1) {}
+
+    Workload generate() {
+        Workload w;
+        w.commands.reserve(config_.commands);
+        w.arrival_ns.reserve(config_.commands);
+        double clock_ns = 0.0;
+
+        for (size_t i = 0; i < config_.commands; ++i) {
+            clock_ns += -std::log(1.0 - uniform()) * 1e9 / config_.arrival_rate;
+            w.arrival_ns.push_back(static_cast<uint64_t>(clock_ns));
+
+            Command cmd = next_command(w);
+            w.commands.push_back(cmd);
+            apply(cmd);
+            w.peak_resting = std::max(w.peak_resting, live_.size());
+        }
+        return w;
+    }
+
+private:
+    struct Resting {
+        uint64_t id;
+        Side side;
+        int64_t price;
+        uint64_t remaining;
+    };
+
+    // Resting ids of one price level, front of the queue first
+    using LevelKey = std::pair<Side, int64_t>;
+
+    Command next_command(Workload& w) {
+        // More adds while the book is thin, fewer while it is deep
+        double fill = static_cast<double>(live_.size()) / config_.target_resting;
+        double p_add = std::min(0.95, std::max(0.05, 1.0 - 0.5 * fill));
+        if (live_.empty() || uniform() < p_add) {
+            ++w.adds;
+            return passive_add();
+        }
+        if (uniform() * (config_.cancels_per_trade + 1.0) >= 1.0) {
+            ++w.cancels;
+            return cancel_from_back();
+        }
+        ++w.marketable;
+        if (uniform() < config_.sweep_probability) {
+            ++w.sweeps;
+            return sweep();
+        }
+        return take();
+    }
+
+    Command passive_add() {
+        Side side = (rng_() & 1) ? Side::BUY : Side::SELL;
+        int64_t ticks = distance();
+        int64_t price = side == Side::BUY
+            ? inside(Side::BUY) - ticks * config_.tick.get()
+            : inside(Side::SELL) + ticks * config_.tick.get();
+        return Command::new_order(OrderId(next_id_++), side, Price(price), size(), owner());
+    }
+
+    // Limit at the opposite touch, so it trades but cannot walk the book
+    Command take() {
+        Side side = (rng_() & 1) ? Side::BUY : Side::SELL;
+        Side contra = side == Side::BUY ? Side::SELL : Side::BUY;
+        return Command::new_order(OrderId(next_id_++), side, Price(touch(contra)), size(), owner());
+    }
+
+    // Takes everything on the opposite side within sweep_ticks of its touch
+    Command sweep() {
+        Side side = (rng_() & 1) ? Side::BUY : Side::SELL;
+        Side contra = side == Side::BUY ? Side::SELL : Side::BUY;
+        int64_t depth = int64_t(config_.sweep_ticks) * config_.tick.get();
+        Price limit(side == Side::BUY ? touch(contra) + depth : touch(contra) - depth);
+        Quantity qty = shadow_.cumulative_volume(contra, limit);
+        if (qty.get() == 0) qty = size();
+        return Command::new_order(OrderId(next_id_++), side, limit, qty, owner());
+    }
+
+    Command cancel_from_back() {
+        const Resting& drawn = live_[rng_() % live_.size()];
+        const std::vector<uint64_t>& queue = queues_.at({drawn.side, drawn.price});
+        size_t position = rng_() % queue.size();
+        for (size_t k = 1; k < config_.cancel_tournament; ++k) {
+            position = std::max<size_t>(position, rng_() % queue.size());
+        }
+        return Command::cancel(OrderId(queue[position]));
+    }
+
+    // Mirrors the command into the shadow book and the resting set
+    void apply(const Command& cmd) {
+        if (cmd.type == CommandType::CANCEL_ORDER) {
+            shadow_.process_cancel(cmd.id);
+            erase(cmd.id.get());
+            return;
+        }
+        size_t log_before = shadow_.get_event_log().size();
+        shadow_.process_new_order(cmd.id, cmd.side, cmd.price, cmd.quantity, cmd.owner);
+
+        uint64_t remaining = cmd.quantity.get();
+        const auto& log = shadow_.get_event_log();
+        for (size_t i = log_before; i < log.size(); ++i) {
+            const auto* trade = std::get_if<TradeEvent>(&log[i]);
+            if (!trade) continue;
+            remaining -= trade->quantity.get();
+            auto it = slot_.find(trade->passive_order_id.get());
+            if (it != slot_.end()) {
+                Resting& passive = live_[it->second];
+                passive.remaining -= trade->quantity.get();
+                if (passive.remaining == 0) erase(passive.id);
+            }
+        }
+        if (remaining > 0) {
+            slot_[cmd.id.get()] = live_.size();
+            live_.push_back({cmd.id.get(), cmd.side, cmd.price.get(), remaining});
+            queues_[{cmd.side, cmd.price.get()}].push_back(cmd.id.get());
+        }
+    }
+
+    void erase(uint64_t id) {
+        auto it = slot_.find(id);
+        if (it == slot_.end()) return;
+        size_t index = it->second;
+        slot_.erase(it);
+        auto level = queues_.find({live_[index].side, live_[index].price});
+        std::vector<uint64_t>& queue = level->second;
+        queue.erase(std::find(queue.begin(), queue.end(), id));
+        if (queue.empty()) queues_.erase(level);
+        if (index + 1 != live_.size()) {
+            live_[index] = live_.back();
+            slot_[live_[index].id] = index;
+        }
+        live_.pop_back();
+    }
+
+    // Most aggressive passive price: one tick inside the opposite touch, so
+    // a wide spread refills from the front as it does on a live book
+    int64_t inside(Side side) const {
+        auto other = side == Side::BUY ? shadow_.best_ask() : shadow_.best_bid();
+        if (!other) return touch(side);
+        return side == Side::BUY ? other->get() - config_.tick.get()
+                                 : other->get() + config_.tick.get();
+    }
+
+    int64_t touch(Side side) const {
+        auto best = side == Side::BUY ? shadow_.best_bid() : shadow_.best_ask();
+        if (best) return best->get();
+        // Empty side: one tick off the other touch, else off the reference mid
+        auto other = side == Side::BUY ? shadow_.best_ask() : shadow_.best_bid();
+        int64_t anchor = other ? other->get() : config_.mid.get();
+        return side == Side::BUY ? anchor - config_.tick.get() : anchor + config_.tick.get();
+    }
+
+    // Discrete Pareto: P(d >= k) = (k + 1)^-alpha
+    int64_t distance() {
+        double d = std::floor(std::pow(1.0 - uniform(), -1.0 / config_.distance_alpha)) - 1.0;
+        return static_cast<int64_t>(std::min(d, static_cast<double>(config_.max_distance_ticks)));
+    }
+
+    Quantity size() {
+        double v = std::exp(config_.size_log_mean + config_.size_log_sigma * normal());
+        uint64_t q = static_cast<uint64_t>(std::llround(v));
+        return Quantity(std::max<uint64_t>(1, std::min(q, config_.max_size)));
+    }
+
+    OwnerId owner() {
+        return OwnerId(static_cast<uint32_t>(1 + rng_() % config_.owners));
+    }
+
+    // [0, 1) with 53 random bits
+    double uniform() {
+        return static_cast<double>(rng_() >> 11) * (1.0 / 9007199254740992.0);
+    }
+
+    // Box-Muller; the second value of each pair is kept for the next call
+    double normal() {
+        if (has_spare_) {
+            has_spare_ = false;
+            return spare_;
+        }
+        double u1 = 1.0 - uniform();
+        double u2 = uniform();
+        double r = std::sqrt(-2.0 * std::log(u1));
+        spare_ = r * std::sin(6.283185307179586 * u2);
+        has_spare_ = true;
+        return r * std::cos(6.283185307179586 * u2);
+    }
+
+    WorkloadConfig config_;
+    std::mt19937_64 rng_;
+    OrderBook shadow_;
+    std::vector<Resting> live_;
+    std::unordered_map<uint64_t, size_t> slot_;
+    std::map<LevelKey, std::vector<uint64_t>> queues_;
+    uint64_t next_id_ = 1;
+    double spare_ = 0.0;
+    bool has_spare_ = false;
+};
+
+#endif
@@ -0,0 +1,26 @@
+# ============================================================================
+# git_hash.cmake - Writes the current revision into a header (cmake -P)
+# ============================================================================
+# Run at build time by the matching_engine_benchmarks target with
+# -DSOURCE_DIR=<repo> -DOUTPUT=<header>. The header is only rewritten when
+# the revision changes, so a rebuild without a new commit recompiles nothing.
+
+execute_process(
+    COMMAND git rev-parse --short HEAD
+    WORKING_DIRECTORY ${SOURCE_DIR}
+    OUTPUT_VARIABLE GIT_HASH
+    OUTPUT_STRIP_TRAILING_WHITESPACE
+    ERROR_QUIET
+)
+if(NOT GIT_HASH)
+    set(GIT_HASH "unknown")
+endif()
+
+set(CONTENT "// Generated by cmake/git_hash.cmake at build time; do not edit\n#define MATCHING_ENGINE_GIT_HASH \"${GIT_HASH}\"\n")
+set(PREVIOUS "")
+if(EXISTS ${OUTPUT})
+    file(READ ${OUTPUT} PREVIOUS)
+endif()
+if(NOT CONTENT STREQUAL PREVIOUS)
+    file(WRITE ${OUTPUT} "${CONTENT}")
+endif()
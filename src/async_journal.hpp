@@ -0,0 +1,1305 @@
+#ifndef ASYNC_JOURNAL_HPP
+#define ASYNC_JOURNAL_HPP
+
+#include "types.hpp"
+#include "events.hpp"
+#include "journal.hpp"
+#include "spsc_ring.hpp"
+#include "crc32c.hpp"
+#include <atomic>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <stdexcept>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#endif
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#define MATCHING_ENGINE_HAS_IO_URING 1
+#else
+#define MATCHING_ENGINE_HAS_IO_URING 0
+#endif
+
+// ============================================================================
+// ASYNC JOURNAL - Continuous group-commit event log
+// ============================================================================
+//
+// The engine thread appends events as they happen; a background writer
+// drains them into 4 KiB-aligned buffers, each holding one or more records,
+// and writes a buffer at a time at the end of the file: through io_uring
+// where the kernel allows it, else with pwrite. fdatasync runs at most once
+// per sync_interval (group commit), linked behind the write on io_uring.
+//
+//   File header   magic u32, version u16, flags u16                   8 bytes
+//   Record        payload_bytes u32, event_count u32, first_seq u64,
+//                 wall_ns u64, crc32c u32, reserved u32, payload   32 + n bytes
+//
+// The payload is a JournalBlockEncoder block, so each record decodes on its
+// own. Sequence numbers count appended events from 1; wall_ns is the
+// system clock when the writer sealed the record. The CRC32C covers the
+// first 24 header bytes and the payload.
+//
+// A crash can leave a torn tail: a partial record, or a full-length one
+// whose pages never reached the disk. A record is valid when it fits in
+// the file, its CRC matches, its first_seq continues the previous record
+// and its payload decodes. recover() keeps the longest valid prefix and
+// truncates the rest; config.resume does that on open and appends after it.
+//
+// With config.segment_bytes set, the filename names a directory and the
+// log is split into segment files named by their first sequence number
+// (00000000000000000001.seg, ...). Before a record would take the current
+// segment past segment_bytes, the writer thread seals it with an index and
+// footer and carries on in a new one; append() never notices. An event too
+// large for a whole segment (a long quote ladder) gets a fresh segment to
+// itself, which then exceeds segment_bytes; a write buffer too small for
+// one event grows to fit it.
+//
+//   Segment header  file header with flags bit 0 set, first_seq u64,
+//                   base_hash u64                                    24 bytes
+//   Index entry     first_seq u64, offset u64                          16 bytes
+//   Footer          first_seq u64, last_seq u64, first_ts u64, last_ts u64,
+//                   first_wall_ns u64, last_wall_ns u64, state_hash u64,
+//                   index_offset u64, index_count u32, crc32c u32,
+//                   magic u32, reserved u32                            80 bytes
+//
+// The index points at the first record at or after every index_events
+// sequence numbers. state_hash folds in every record CRC since sequence 1
+// (base_hash is the previous segment's), so a footer vouches for the whole
+// history before it. The footer CRC covers the index and the footer up to
+// itself. A segment without a valid footer is the live one, or was cut
+// short by a crash, and is read by scanning its records.
+//
+// Two watermarks trail the appended sequence: written() (handed to the
+// kernel) and durable() (covered by a completed fdatasync). Acknowledgement
+// threads block in wait_durable(); append() never does. A failed write or
+// sync is final: nothing more is written, both watermarks stay where they
+// were, and later events are drained and dropped. If the writer falls
+// behind and the queue fills, further events go to a locked spill list,
+// bounded only by memory, which the writer takes over once it has drained
+// the queue.
+
+constexpr uint32_t ASYNC_JOURNAL_MAGIC = 0x4C4A454D;  // "MEJL"
+constexpr uint16_t ASYNC_JOURNAL_VERSION = 1;
+constexpr size_t ASYNC_JOURNAL_HEADER_SIZE = 8;
+constexpr size_t ASYNC_JOURNAL_RECORD_HEADER_SIZE = 32;
+constexpr size_t ASYNC_JOURNAL_CRC_OFFSET = 24;         // Bytes before it are checksummed
+constexpr uint16_t ASYNC_JOURNAL_SEGMENT_FLAG = 1;
+constexpr size_t ASYNC_JOURNAL_SEGMENT_HEADER_SIZE = 24;
+constexpr size_t ASYNC_JOURNAL_INDEX_ENTRY_SIZE = 16;
+constexpr size_t ASYNC_JOURNAL_FOOTER_SIZE = 80;
+constexpr size_t ASYNC_JOURNAL_FOOTER_CRC_OFFSET = 68;
+constexpr uint32_t ASYNC_JOURNAL_FOOTER_MAGIC = 0x4653454D;     // "MESF"
+constexpr uint64_t ASYNC_JOURNAL_HASH_SEED = 0xCBF29CE484222325ull;
+
+struct AsyncJournalConfig {
+    size_t queue_capacity = 1 << 16;                    // Events in flight to the writer
+    size_t buffer_bytes = 1 << 20;                      // Per write buffer (two of them)
+    uint32_t record_events = 4096;                      // Max events per record
+    std::chrono::microseconds sync_interval{1000};      // 0 = fdatasync every write
+    bool sync = true;                                   // false: durable() tracks written()
+    bool use_io_uring = true;                           // false: always pwrite
+    bool resume = false;                                // Recover an existing file, append after it
+    uint64_t segment_bytes = 0;                         // > 0: a directory of segments this size
+    uint32_t index_events = 4096;                       // Segment index spacing
+};
+
+// Result of checking a journal file record by record
+struct AsyncJournalScan {
+    uint64_t file_bytes = 0;
+    uint64_t valid_bytes = 0;       // End of the last valid record
+    uint64_t records = 0;           // Valid records
+    uint64_t events = 0;            // Events in them
+    uint64_t last_seq = 0;          // Of the last valid event
+    uint64_t last_wall_ns = 0;
+    uint64_t state_hash = 0;        // History hash through last_seq
+    bool clean() const { return valid_bytes == file_bytes; }
+};
+
+// One segment of a segmented journal, from its footer or, while it has
+// none, from scanning it
+struct JournalSegmentInfo {
+    std::string path;
+    uint64_t first_seq = 1;
+    uint64_t last_seq = 0;          // first_seq - 1 while empty
+    uint64_t first_ts = 0;          // Event timestamps
+    uint64_t last_ts = 0;
+    uint64_t first_wall_ns = 0;     // Records sealed by the writer
+    uint64_t last_wall_ns = 0;
+    uint64_t base_hash = ASYNC_JOURNAL_HASH_SEED;
+    uint64_t state_hash = ASYNC_JOURNAL_HASH_SEED;
+    uint64_t records_end = 0;       // Index offset, or end of the valid records
+    bool sealed = false;
+    std::vector<std::pair<uint64_t, uint64_t>> index;  // (first_seq, offset)
+
+    bool empty() const { return last_seq < first_seq; }
+};
+
+namespace async_journal {
+
+// A record that passed every check, with its events decoded
+struct RecordView {
+    uint64_t offset;
+    uint64_t first_seq;
+    uint64_t wall_ns;
+    uint32_t crc;
+    const std::vector<Event>& events;
+};
+
+// FNV-1a over the record CRC bytes
+inline uint64_t chain_hash(uint64_t hash, uint32_t crc) {
+    for (int i = 0; i < 4; ++i) {
+        hash ^= (crc >> (8 * i)) & 0xFF;
+        hash *= 0x100000001B3ull;
+    }
+    return hash;
+}
+
+// Walks records starting at data[0], which sits at file offset `base`,
+// until one is invalid. on_record(const RecordView&) sees every valid one
+// and can stop the walk early by returning false.
+template<typename F>
+AsyncJournalScan scan_records(const uint8_t* data, size_t size, uint64_t base,
+                              uint64_t first_seq, uint64_t hash, F&& on_record) {
+    AsyncJournalScan result;
+    result.file_bytes = base + size;
+    result.last_seq = first_seq - 1;
+    result.state_hash = hash;
+    std::vector<Event> events;
+    size_t pos = 0;
+    while (size - pos >= ASYNC_JOURNAL_RECORD_HEADER_SIZE) {
+        const uint8_t* header = data + pos;
+        const uint32_t payload_bytes = journal::get_u32(header);
+        const uint32_t count = journal::get_u32(header + 4);
+        const uint8_t* payload = header + ASYNC_JOURNAL_RECORD_HEADER_SIZE;
+        if (count == 0 || journal::get_u64(header + 8) != result.last_seq + 1 ||
+            size - pos - ASYNC_JOURNAL_RECORD_HEADER_SIZE < payload_bytes) {
+            break;
+        }
+        const uint32_t crc = crc32c::extend(crc32c::value(header, ASYNC_JOURNAL_CRC_OFFSET),
+                                            payload, payload_bytes);
+        events.clear();
+        if (crc != journal::get_u32(header + ASYNC_JOURNAL_CRC_OFFSET) ||
+            !JournalBlockDecoder::decode(payload, payload_bytes, count, events)) {
+            break;
+        }
+        const uint64_t offset = base + pos;
+        pos += ASYNC_JOURNAL_RECORD_HEADER_SIZE + payload_bytes;
+        result.records++;
+        result.events += count;
+        result.last_seq += count;
+        result.last_wall_ns = journal::get_u64(header + 16);
+        result.state_hash = chain_hash(result.state_hash, crc);
+        if (!on_record(RecordView{offset, result.last_seq - count + 1, result.last_wall_ns,
+                                  crc, events})) {
+            break;
+        }
+    }
+    result.valid_bytes = base + pos;
+    return result;
+}
+
+inline void put_file_header(uint8_t* p, uint16_t flags) {
+    journal::put_u32(p, ASYNC_JOURNAL_MAGIC);
+    journal::put_u16(p + 4, ASYNC_JOURNAL_VERSION);
+    journal::put_u16(p + 6, flags);
+}
+
+inline bool check_file_header(const uint8_t* p, size_t size, uint16_t flags) {
+    return size >= ASYNC_JOURNAL_HEADER_SIZE && journal::get_u32(p) == ASYNC_JOURNAL_MAGIC &&
+           journal::get_u16(p + 4) == ASYNC_JOURNAL_VERSION && journal::get_u16(p + 6) == flags;
+}
+
+inline std::string segment_path(const std::string& directory, uint64_t first_seq) {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%020llu.seg", static_cast<unsigned long long>(first_seq));
+    return (std::filesystem::path(directory) / name).string();
+}
+
+// Index entries followed by the footer, for the segment's current state
+inline std::vector<uint8_t> encode_footer(const JournalSegmentInfo& info) {
+    std::vector<uint8_t> out(info.index.size() * ASYNC_JOURNAL_INDEX_ENTRY_SIZE +
+                             ASYNC_JOURNAL_FOOTER_SIZE);
+    uint8_t* p = out.data();
+    for (const auto& entry : info.index) {
+        journal::put_u64(p, entry.first);
+        journal::put_u64(p + 8, entry.second);
+        p += ASYNC_JOURNAL_INDEX_ENTRY_SIZE;
+    }
+    journal::put_u64(p, info.first_seq);
+    journal::put_u64(p + 8, info.last_seq);
+    journal::put_u64(p + 16, info.first_ts);
+    journal::put_u64(p + 24, info.last_ts);
+    journal::put_u64(p + 32, info.first_wall_ns);
+    journal::put_u64(p + 40, info.last_wall_ns);
+    journal::put_u64(p + 48, info.state_hash);
+    journal::put_u64(p + 56, info.records_end);
+    journal::put_u32(p + 64, static_cast<uint32_t>(info.index.size()));
+    journal::put_u32(p + ASYNC_JOURNAL_FOOTER_CRC_OFFSET,
+                     crc32c::value(out.data(), static_cast<size_t>(p - out.data()) +
+                                               ASYNC_JOURNAL_FOOTER_CRC_OFFSET));
+    journal::put_u32(p + 72, ASYNC_JOURNAL_FOOTER_MAGIC);
+    journal::put_u32(p + 76, 0);
+    return out;
+}
+
+// `tail` holds everything from the footer's index_offset to the end of a
+// file of `file_bytes`. False unless it is a complete, intact footer.
+inline bool decode_footer(const uint8_t* tail, size_t size, uint64_t file_bytes,
+                          JournalSegmentInfo& info) {
+    if (size < ASYNC_JOURNAL_FOOTER_SIZE) return false;
+    const uint8_t* p = tail + size - ASYNC_JOURNAL_FOOTER_SIZE;
+    const uint64_t index_offset = journal::get_u64(p + 56);
+    const uint32_t count = journal::get_u32(p + 64);
+    if (journal::get_u32(p + 72) != ASYNC_JOURNAL_FOOTER_MAGIC ||
+        size != static_cast<uint64_t>(count) * ASYNC_JOURNAL_INDEX_ENTRY_SIZE + ASYNC_JOURNAL_FOOTER_SIZE ||
+        index_offset + size != file_bytes ||
+        crc32c::value(tail, size - ASYNC_JOURNAL_FOOTER_SIZE + ASYNC_JOURNAL_FOOTER_CRC_OFFSET) !=
+            journal::get_u32(p + ASYNC_JOURNAL_FOOTER_CRC_OFFSET)) {
+        return false;
+    }
+    info.index.clear();
+    for (uint32_t i = 0; i < count; ++i) {
+        const uint8_t* e = tail + i * ASYNC_JOURNAL_INDEX_ENTRY_SIZE;
+        info.index.emplace_back(journal::get_u64(e), journal::get_u64(e + 8));
+    }
+    info.first_seq = journal::get_u64(p);
+    info.last_seq = journal::get_u64(p + 8);
+    info.first_ts = journal::get_u64(p + 16);
+    info.last_ts = journal::get_u64(p + 24);
+    info.first_wall_ns = journal::get_u64(p + 32);
+    info.last_wall_ns = journal::get_u64(p + 40);
+    info.state_hash = journal::get_u64(p + 48);
+    info.records_end = index_offset;
+    info.sealed = true;
+    return true;
+}
+
+// Reads `size` bytes at `offset` (fewer at the end of the file). Throws
+// std::runtime_error if the file cannot be opened.
+inline std::vector<uint8_t> read_range(const std::string& path, uint64_t offset,
+                                       uint64_t size = std::numeric_limits<uint64_t>::max()) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        throw std::runtime_error("Cannot open file: " + path);
+    }
+    file.seekg(0, std::ios::end);
+    const uint64_t end = static_cast<uint64_t>(file.tellg());
+    if (offset >= end) return {};
+    std::vector<uint8_t> bytes(static_cast<size_t>(std::min(size, end - offset)));
+    file.seekg(static_cast<std::streamoff>(offset));
+    file.read(reinterpret_cast<char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    bytes.resize(static_cast<size_t>(file.gcount()));
+    return bytes;
+}
+
+}  // namespace async_journal
+
+#if MATCHING_ENGINE_HAS_IO_URING
+// ============================================================================
+// URING QUEUE - Minimal io_uring over raw syscalls (no liburing)
+// ============================================================================
+// One submitter thread. Ring indices shared with the kernel are accessed
+// with acquire/release atomics, as the io_uring ABI requires.
+
+class UringQueue {
+public:
+    UringQueue() = default;
+    UringQueue(const UringQueue&) = delete;
+    UringQueue& operator=(const UringQueue&) = delete;
+
+    ~UringQueue() {
+        if (sqes_) munmap(sqes_, sqes_bytes_);
+        if (cq_ring_ && cq_ring_ != sq_ring_) munmap(cq_ring_, cq_bytes_);
+        if (sq_ring_) munmap(sq_ring_, sq_bytes_);
+        if (fd_ >= 0) close(fd_);
+    }
+
+    // False (errno set) if the kernel refuses io_uring
+    bool init(unsigned entries) {
+        io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+        long fd = syscall(__NR_io_uring_setup, entries, &params);
+        if (fd < 0) return false;
+        fd_ = static_cast<int>(fd);
+
+        sq_bytes_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cq_bytes_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        const bool single = params.features & IORING_FEAT_SINGLE_MMAP;
+        if (single) sq_bytes_ = cq_bytes_ = std::max(sq_bytes_, cq_bytes_);
+
+        sq_ring_ = map(sq_bytes_, IORING_OFF_SQ_RING);
+        if (!sq_ring_) return false;
+        cq_ring_ = single ? sq_ring_ : map(cq_bytes_, IORING_OFF_CQ_RING);
+        if (!cq_ring_) return false;
+        sqes_bytes_ = params.sq_entries * sizeof(io_uring_sqe);
+        sqes_ = static_cast<io_uring_sqe*>(map(sqes_bytes_, IORING_OFF_SQES));
+        if (!sqes_) return false;
+
+        auto* sq = static_cast<uint8_t*>(sq_ring_);
+        sq_head_ = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+        sq_tail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        sq_mask_ = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        sq_array_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        sq_entries_ = params.sq_entries;
+        auto* cq = static_cast<uint8_t*>(cq_ring_);
+        cq_head_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        cq_tail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        cq_mask_ = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        cqes_ = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+        local_tail_ = *sq_tail_;
+        return true;
+    }
+
+    // Null if the submission queue is full
+    io_uring_sqe* next_sqe() {
+        unsigned head = __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+        if (local_tail_ - head >= sq_entries_) return nullptr;
+        unsigned index = local_tail_ & sq_mask_;
+        io_uring_sqe* sqe = &sqes_[index];
+        std::memset(sqe, 0, sizeof(*sqe));
+        sq_array_[index] = index;
+        ++local_tail_;
+        return sqe;
+    }
+
+    // Submits everything queued since the last call and waits for at least
+    // wait_nr completions. Returns the io_uring_enter result (-errno on error).
+    int submit(unsigned wait_nr) {
+        unsigned to_submit = local_tail_ - __atomic_load_n(sq_tail_, __ATOMIC_RELAXED);
+        __atomic_store_n(sq_tail_, local_tail_, __ATOMIC_RELEASE);
+        long r;
+        do {
+            r = syscall(__NR_io_uring_enter, fd_, to_submit, wait_nr,
+                        wait_nr ? IORING_ENTER_GETEVENTS : 0, nullptr, 0);
+        } while (r < 0 && errno == EINTR);
+        return r < 0 ? -errno : static_cast<int>(r);
+    }
+
+    bool pop(io_uring_cqe& out) {
+        unsigned head = *cq_head_;
+        if (head == __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE)) return false;
+        out = cqes_[head & cq_mask_];
+        __atomic_store_n(cq_head_, head + 1, __ATOMIC_RELEASE);
+        return true;
+    }
+
+private:
+    void* map(size_t bytes, off_t offset) {
+        void* p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                       fd_, offset);
+        return p == MAP_FAILED ? nullptr : p;
+    }
+
+    int fd_ = -1;
+    void* sq_ring_ = nullptr;
+    void* cq_ring_ = nullptr;
+    io_uring_sqe* sqes_ = nullptr;
+    size_t sq_bytes_ = 0, cq_bytes_ = 0, sqes_bytes_ = 0;
+    unsigned* sq_head_ = nullptr;
+    unsigned* sq_tail_ = nullptr;
+    unsigned* sq_array_ = nullptr;
+    unsigned sq_mask_ = 0, sq_entries_ = 0, local_tail_ = 0;
+    unsigned* cq_head_ = nullptr;
+    unsigned* cq_tail_ = nullptr;
+    unsigned cq_mask_ = 0;
+    io_uring_cqe* cqes_ = nullptr;
+};
+#endif
+
+namespace async_journal {
+
+// Folds one valid record into the segment's coverage
+inline void extend_segment(JournalSegmentInfo& info, uint64_t offset, uint64_t first_seq,
+                           uint64_t last_seq, uint64_t first_ts, uint64_t last_ts,
+                           uint64_t wall_ns, uint32_t crc, bool indexed) {
+    if (info.empty()) {
+        info.first_ts = first_ts;
+        info.first_wall_ns = wall_ns;
+    }
+    if (indexed) info.index.emplace_back(first_seq, offset);
+    info.last_seq = last_seq;
+    info.last_ts = last_ts;
+    info.last_wall_ns = wall_ns;
+    info.state_hash = chain_hash(info.state_hash, crc);
+}
+
+inline void truncate_file(const std::string& path, uint64_t size) {
+    int fd = ::open(path.c_str(), O_WRONLY | O_CLOEXEC);
+    bool ok = fd >= 0 && ::ftruncate(fd, static_cast<off_t>(size)) == 0 && ::fsync(fd) == 0;
+    if (fd >= 0) ::close(fd);
+    if (!ok) {
+        throw std::runtime_error("Cannot truncate journal: " + path);
+    }
+}
+
+}  // namespace async_journal
+
+// ============================================================================
+// JOURNAL SEGMENTS - Read side of a segmented journal directory
+// ============================================================================
+// open() reads only the header and footer of a sealed segment; one without
+// a footer is scanned. Seeking binary-searches the footers for the segment
+// holding a sequence number, then its index for the record to decode from.
+
+class JournalSegments {
+public:
+    // Throws std::runtime_error if the directory or a segment cannot be
+    // read, a .seg file is not a journal segment, or a segment does not
+    // start where the previous one ended. A last segment shorter than its
+    // header (the writer stopped while creating it) is ignored.
+    static JournalSegments open(const std::string& directory) {
+        std::vector<std::string> paths;
+        for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+            if (entry.path().extension() == ".seg") paths.push_back(entry.path().string());
+        }
+        std::sort(paths.begin(), paths.end());
+
+        JournalSegments result;
+        for (size_t i = 0; i < paths.size(); ++i) {
+            std::vector<uint8_t> header =
+                async_journal::read_range(paths[i], 0, ASYNC_JOURNAL_SEGMENT_HEADER_SIZE);
+            if (header.size() < ASYNC_JOURNAL_SEGMENT_HEADER_SIZE && i + 1 == paths.size()) break;
+            if (header.size() < ASYNC_JOURNAL_SEGMENT_HEADER_SIZE ||
+                !async_journal::check_file_header(header.data(), header.size(),
+                                                  ASYNC_JOURNAL_SEGMENT_FLAG)) {
+                throw std::runtime_error("Not a journal segment: " + paths[i]);
+            }
+            JournalSegmentInfo info;
+            info.path = paths[i];
+            info.first_seq = journal::get_u64(header.data() + 8);
+            info.last_seq = info.first_seq - 1;
+            info.base_hash = info.state_hash = journal::get_u64(header.data() + 16);
+            if (!result.segments_.empty() && info.first_seq != result.segments_.back().last_seq + 1) {
+                throw std::runtime_error("Journal segment out of sequence: " + paths[i]);
+            }
+            if (!read_footer(info)) scan(info);
+            result.segments_.push_back(std::move(info));
+        }
+        return result;
+    }
+
+    const std::vector<JournalSegmentInfo>& segments() const { return segments_; }
+    uint64_t first_seq() const { return segments_.empty() ? 1 : segments_.front().first_seq; }
+    uint64_t last_seq() const { return segments_.empty() ? 0 : segments_.back().last_seq; }
+
+    // Index of the segment holding `seq`, or segments().size()
+    size_t find_segment(uint64_t seq) const {
+        auto it = std::upper_bound(segments_.begin(), segments_.end(), seq,
+            [](uint64_t s, const JournalSegmentInfo& info) { return s < info.first_seq; });
+        if (it == segments_.begin() || seq > std::prev(it)->last_seq) return segments_.size();
+        return static_cast<size_t>(std::prev(it) - segments_.begin());
+    }
+
+    // Appends the events from sequence `seq` on, at most max_events of
+    // them, to `out`. Returns false if a record fails its checks.
+    bool read_from(uint64_t seq, std::vector<Event>& out,
+                   size_t max_events = std::numeric_limits<size_t>::max()) const {
+        seq = std::max(seq, first_seq());
+        size_t remaining = max_events;
+        for (size_t i = find_segment(seq); i < segments_.size() && remaining > 0; ++i) {
+            const JournalSegmentInfo& info = segments_[i];
+            if (info.empty()) continue;
+            // Start at the last indexed record at or before seq
+            uint64_t offset = ASYNC_JOURNAL_SEGMENT_HEADER_SIZE, record_seq = info.first_seq;
+            auto entry = std::upper_bound(info.index.begin(), info.index.end(), seq,
+                [](uint64_t s, const std::pair<uint64_t, uint64_t>& e) { return s < e.first; });
+            if (entry != info.index.begin()) {
+                record_seq = std::prev(entry)->first;
+                offset = std::prev(entry)->second;
+            }
+            std::vector<uint8_t> bytes = async_journal::read_range(info.path, offset,
+                                                                   info.records_end - offset);
+            bool done = false;
+            AsyncJournalScan scan = async_journal::scan_records(
+                bytes.data(), bytes.size(), offset, record_seq, 0,
+                [&](const async_journal::RecordView& r) {
+                    for (size_t k = 0; k < r.events.size() && remaining > 0; ++k) {
+                        if (r.first_seq + k < seq) continue;
+                        out.push_back(r.events[k]);
+                        --remaining;
+                    }
+                    done = remaining == 0;
+                    return !done;
+                });
+            if (!done && scan.valid_bytes != info.records_end) return false;
+            seq = info.last_seq + 1;
+        }
+        return true;
+    }
+
+    bool read_all(std::vector<Event>& out) const {
+        return read_from(first_seq(), out);
+    }
+
+    // Re-reads every record and checks the history hash chain through all
+    // footers. False at the first mismatch.
+    bool verify() const {
+        for (size_t i = 0; i < segments_.size(); ++i) {
+            const JournalSegmentInfo& info = segments_[i];
+            if (i > 0 && info.base_hash != segments_[i - 1].state_hash) return false;
+            std::vector<uint8_t> bytes = async_journal::read_range(
+                info.path, ASYNC_JOURNAL_SEGMENT_HEADER_SIZE,
+                info.records_end - ASYNC_JOURNAL_SEGMENT_HEADER_SIZE);
+            AsyncJournalScan scan = async_journal::scan_records(
+                bytes.data(), bytes.size(), ASYNC_JOURNAL_SEGMENT_HEADER_SIZE, info.first_seq,
+                info.base_hash, [](const async_journal::RecordView&) { return true; });
+            if (scan.valid_bytes != info.records_end || scan.last_seq != info.last_seq ||
+                scan.state_hash != info.state_hash) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+private:
+    static bool read_footer(JournalSegmentInfo& info) {
+        const uint64_t size = std::filesystem::file_size(info.path);
+        if (size < ASYNC_JOURNAL_SEGMENT_HEADER_SIZE + ASYNC_JOURNAL_FOOTER_SIZE) return false;
+        std::vector<uint8_t> footer = async_journal::read_range(
+            info.path, size - ASYNC_JOURNAL_FOOTER_SIZE, ASYNC_JOURNAL_FOOTER_SIZE);
+        if (footer.size() != ASYNC_JOURNAL_FOOTER_SIZE) return false;
+        const uint64_t index_offset = journal::get_u64(footer.data() + 56);
+        if (index_offset < ASYNC_JOURNAL_SEGMENT_HEADER_SIZE ||
+            index_offset > size - ASYNC_JOURNAL_FOOTER_SIZE) {
+            return false;
+        }
+        std::vector<uint8_t> tail = async_journal::read_range(info.path, index_offset);
+        JournalSegmentInfo sealed = info;
+        if (!async_journal::decode_footer(tail.data(), tail.size(), size, sealed) ||
+            sealed.first_seq != info.first_seq) {
+            return false;
+        }
+        info = std::move(sealed);
+        return true;
+    }
+
+    // Live or torn segment: every valid record, each one indexed
+    static void scan(JournalSegmentInfo& info) {
+        std::vector<uint8_t> bytes = async_journal::read_range(info.path, 0);
+        AsyncJournalScan result = async_journal::scan_records(
+            bytes.data() + ASYNC_JOURNAL_SEGMENT_HEADER_SIZE,
+            bytes.size() - ASYNC_JOURNAL_SEGMENT_HEADER_SIZE, ASYNC_JOURNAL_SEGMENT_HEADER_SIZE,
+            info.first_seq, info.base_hash, [&info](const async_journal::RecordView& r) {
+                async_journal::extend_segment(info, r.offset, r.first_seq,
+                                              r.first_seq + r.events.size() - 1,
+                                              get_timestamp(r.events.front()).get(),
+                                              get_timestamp(r.events.back()).get(),
+                                              r.wall_ns, r.crc, true);
+                return true;
+            });
+        info.records_end = result.valid_bytes;
+    }
+
+    std::vector<JournalSegmentInfo> segments_;
+};
+
+// ============================================================================
+// ASYNC JOURNAL WRITER
+// ============================================================================
+
+class AsyncJournal : public EventSink {
+public:
+    struct Stats {
+        uint64_t records = 0;
+        uint64_t writes = 0;        // Buffers handed to the kernel
+        uint64_t syncs = 0;
+        uint64_t bytes = 0;         // Including file headers and footers
+        uint64_t spilled = 0;       // Appends that found the queue full
+        uint64_t segments = 0;      // Segments sealed
+    };
+
+    // Creates (truncates) the file and starts the writer thread. With
+    // config.resume a non-empty file is recovered instead, and sequence
+    // numbers continue from its last valid event. With
+    // config.segment_bytes, `filename` is a directory, created if needed:
+    // resume continues in its last segment (or after it, if sealed), while
+    // otherwise its segments are deleted. Throws std::runtime_error if the
+    // journal cannot be opened or is not an async journal.
+    explicit AsyncJournal(const std::string& filename,
+                          const AsyncJournalConfig& config = AsyncJournalConfig())
+        : config_(config), queue_(config.queue_capacity) {
+        config_.record_events = std::max<uint32_t>(1, config_.record_events);
+        config_.index_events = std::max<uint32_t>(1, config_.index_events);
+        if (segmented()) {
+            config_.segment_bytes = std::max<uint64_t>(config_.segment_bytes,
+                ASYNC_JOURNAL_SEGMENT_HEADER_SIZE + ASYNC_JOURNAL_RECORD_HEADER_SIZE + MIN_SEGMENT_ROOM);
+        }
+        const size_t bytes = std::max<size_t>(config_.buffer_bytes, 64 * 1024);
+        for (Buffer& b : buffers_) b.allocate((bytes + ALIGN - 1) / ALIGN * ALIGN);
+
+        if (segmented()) {
+            open_directory(filename);
+        } else {
+            open_file(filename);
+        }
+#if MATCHING_ENGINE_HAS_IO_URING
+        uring_ok_.store(config_.use_io_uring && uring_.init(8), std::memory_order_relaxed);
+#endif
+        stats_.bytes = offset_;
+        writer_ = std::thread([this] { writer_loop(); });
+    }
+
+    ~AsyncJournal() {
+        close();
+        for (Buffer& b : buffers_) b.release();
+    }
+
+    AsyncJournal(const AsyncJournal&) = delete;
+    AsyncJournal& operator=(const AsyncJournal&) = delete;
+
+    // ========================================================================
+    // APPENDING THREAD
+    // ========================================================================
+    // Queues the event and returns its sequence number. Never waits on the
+    // writer or the disk.
+    uint64_t append(const Event& event) {
+        Entry entry;
+        entry.event = event;
+        if (spilling_.load(std::memory_order_acquire) || !queue_.try_push(entry)) {
+            // Once spilling, everything spills until the writer takes the
+            // list, so events stay in order
+            std::lock_guard<std::mutex> lock(spill_mutex_);
+            spill_.push_back(event);
+            spilling_.store(true, std::memory_order_release);
+            spilled_.store(spilled_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+        uint64_t seq = appended_.load(std::memory_order_relaxed) + 1;
+        appended_.store(seq, std::memory_order_release);
+        return seq;
+    }
+
+    // EventSink: the book's logged events are appended as they come
+    void on_event(const Event& event) override { append(event); }
+
+    // Writes out everything appended, runs a final fdatasync and stops the
+    // writer. Call from the appending thread. Idempotent.
+    void close() {
+        if (!writer_.joinable()) return;
+        closing_.store(true, std::memory_order_release);
+        writer_.join();
+        if (fd_ >= 0) ::close(fd_);
+        fd_ = -1;
+    }
+
+    // ========================================================================
+    // WATERMARKS (any thread)
+    // ========================================================================
+    uint64_t appended() const { return appended_.load(std::memory_order_acquire); }
+    uint64_t written() const { return written_.load(std::memory_order_acquire); }
+    uint64_t durable() const { return durable_.load(std::memory_order_acquire); }
+
+    // Blocks until event `seq` is durable. False on timeout or write error.
+    bool wait_durable(uint64_t seq, std::chrono::microseconds timeout) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        return durable_cv_.wait_for(lock, timeout, [this, seq] {
+            return durable() >= seq || failed();
+        }) && durable() >= seq;
+    }
+
+    // Set once a write or sync fails; the writer stops writing and the
+    // watermarks never advance again
+    bool failed() const { return error_.load(std::memory_order_acquire) != 0; }
+    int error() const { return error_.load(std::memory_order_acquire); }
+
+    const char* backend() const {
+        return uring_ok_.load(std::memory_order_relaxed) ? "io_uring" : "pwrite";
+    }
+
+    // Writer-side counters; exact once closed
+    Stats stats() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Stats s = stats_;
+        s.spilled = spilled_.load(std::memory_order_relaxed);
+        return s;
+    }
+
+    // ========================================================================
+    // READING
+    // ========================================================================
+    // Appends the events of every valid record to `out`, stopping at the
+    // first torn or corrupt one. Returns false if anything follows the
+    // valid prefix. Throws std::runtime_error if the file cannot be opened
+    // or the header is wrong.
+    static bool read(const std::string& filename, std::vector<Event>& out) {
+        return scan(load(filename), [&out](const async_journal::RecordView& r) {
+            out.insert(out.end(), r.events.begin(), r.events.end());
+            return true;
+        }).clean();
+    }
+
+    // Checks every record without keeping the events
+    static AsyncJournalScan verify(const std::string& filename) {
+        return scan(load(filename), [](const async_journal::RecordView&) { return true; });
+    }
+
+    // Truncates the file after its last valid record and syncs it, so
+    // appending can continue there after a crash. Throws like read(), or
+    // if the truncation fails.
+    static AsyncJournalScan recover(const std::string& filename) {
+        AsyncJournalScan result = verify(filename);
+        if (!result.clean()) async_journal::truncate_file(filename, result.valid_bytes);
+        return result;
+    }
+
+private:
+    static std::vector<uint8_t> load(const std::string& filename) {
+        std::ifstream file(filename, std::ios::binary);
+        if (!file) {
+            throw std::runtime_error("Cannot open file: " + filename);
+        }
+        std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(file)),
+                                   std::istreambuf_iterator<char>());
+        if (!async_journal::check_file_header(bytes.data(), bytes.size(), 0)) {
+            throw std::runtime_error("Not an async journal: " + filename);
+        }
+        return bytes;
+    }
+
+    template<typename F>
+    static AsyncJournalScan scan(const std::vector<uint8_t>& bytes, F&& on_record) {
+        return async_journal::scan_records(bytes.data() + ASYNC_JOURNAL_HEADER_SIZE,
+                                           bytes.size() - ASYNC_JOURNAL_HEADER_SIZE,
+                                           ASYNC_JOURNAL_HEADER_SIZE, 1, ASYNC_JOURNAL_HASH_SEED,
+                                           std::forward<F>(on_record));
+    }
+
+    static constexpr size_t ALIGN = 4096;
+    static constexpr size_t MIN_SEGMENT_ROOM = 256;     // Record payload bytes a segment holds at least
+    static constexpr uint64_t WRITE_TAG = 1;
+    static constexpr uint64_t SYNC_TAG = 2;
+
+    struct Entry {
+        Event event = Event(std::in_place_type<CancelOrderEvent>, Timestamp(0), OrderId(0));
+    };
+
+    struct Buffer {
+        uint8_t* data = nullptr;
+        size_t capacity = 0;
+        size_t size = 0;
+        uint64_t last_seq = 0;          // Highest sequence in the buffer
+        uint64_t records = 0;
+
+        void allocate(size_t bytes) {
+            data = static_cast<uint8_t*>(std::aligned_alloc(ALIGN, bytes));
+            if (!data) throw std::bad_alloc();
+            capacity = bytes;
+        }
+
+        // Empty buffers only: the contents are not kept
+        void grow(size_t bytes) {
+            release();
+            allocate((bytes + ALIGN - 1) / ALIGN * ALIGN);
+        }
+
+        void release() {
+            std::free(data);
+            data = nullptr;
+        }
+    };
+
+    // ========================================================================
+    // FILES AND SEGMENTS
+    // ========================================================================
+    bool segmented() const { return config_.segment_bytes > 0; }
+
+    void start_at(uint64_t last_seq) {
+        next_seq_ = last_seq + 1;
+        appended_.store(last_seq, std::memory_order_relaxed);
+        written_.store(last_seq, std::memory_order_relaxed);
+        durable_.store(last_seq, std::memory_order_relaxed);
+    }
+
+    void open_file(const std::string& filename) {
+        bool fresh = true;
+        struct stat st;
+        if (config_.resume && ::stat(filename.c_str(), &st) == 0 && st.st_size > 0) {
+            AsyncJournalScan scan = recover(filename);
+            fresh = false;
+            offset_ = scan.valid_bytes;
+            start_at(scan.last_seq);
+        }
+        fd_ = ::open(filename.c_str(), O_WRONLY | O_CREAT | (fresh ? O_TRUNC : 0) | O_CLOEXEC, 0644);
+        if (fd_ < 0) {
+            throw std::runtime_error("Cannot open file: " + filename);
+        }
+        if (fresh) {
+            uint8_t header[ASYNC_JOURNAL_HEADER_SIZE];
+            async_journal::put_file_header(header, 0);
+            if (!write_fully(header, sizeof(header), 0)) {
+                ::close(fd_);
+                throw std::runtime_error("Cannot write journal header: " + filename);
+            }
+            offset_ = sizeof(header);
+        }
+    }
+
+    void open_directory(const std::string& directory) {
+        directory_ = directory;
+        std::filesystem::create_directories(directory_);
+        if (config_.resume) {
+            JournalSegments existing = JournalSegments::open(directory_);
+            if (!existing.segments().empty()) {
+                const JournalSegmentInfo& last = existing.segments().back();
+                start_at(last.last_seq);
+                state_hash_ = last.state_hash;
+                if (!last.sealed) {
+                    continue_segment(last);
+                    return;
+                }
+            }
+        } else {
+            for (const auto& entry : std::filesystem::directory_iterator(directory_)) {
+                if (entry.path().extension() == ".seg") std::filesystem::remove(entry.path());
+            }
+        }
+        if (!open_segment()) {
+            throw std::runtime_error("Cannot create journal segment in: " + directory_);
+        }
+    }
+
+    // Reopens an unsealed segment after its last valid record, rebuilding
+    // the index the footer will need
+    void continue_segment(const JournalSegmentInfo& live) {
+        begin_segment(live.path, live.first_seq, live.base_hash);
+        std::vector<uint8_t> bytes = async_journal::read_range(live.path, 0);
+        AsyncJournalScan scan = async_journal::scan_records(
+            bytes.data() + ASYNC_JOURNAL_SEGMENT_HEADER_SIZE,
+            bytes.size() - ASYNC_JOURNAL_SEGMENT_HEADER_SIZE, ASYNC_JOURNAL_SEGMENT_HEADER_SIZE,
+            live.first_seq, live.base_hash, [this](const async_journal::RecordView& r) {
+                note_record(r.offset, r.first_seq, static_cast<uint32_t>(r.events.size()),
+                            get_timestamp(r.events.front()).get(),
+                            get_timestamp(r.events.back()).get(), r.wall_ns, r.crc);
+                return true;
+            });
+        if (!scan.clean()) async_journal::truncate_file(live.path, scan.valid_bytes);
+        fd_ = ::open(live.path.c_str(), O_WRONLY | O_CLOEXEC);
+        if (fd_ < 0) {
+            throw std::runtime_error("Cannot open file: " + live.path);
+        }
+        offset_ = scan.valid_bytes;
+    }
+
+    void begin_segment(const std::string& path, uint64_t first_seq, uint64_t base_hash) {
+        segment_ = JournalSegmentInfo();
+        segment_.path = path;
+        segment_.first_seq = first_seq;
+        segment_.last_seq = first_seq - 1;
+        segment_.base_hash = segment_.state_hash = base_hash;
+        next_index_seq_ = first_seq;
+    }
+
+    // Creates the segment starting at the next sequence number and syncs
+    // the directory, so the new file survives a crash
+    bool open_segment() {
+        begin_segment(async_journal::segment_path(directory_, next_seq_), next_seq_, state_hash_);
+        fd_ = ::open(segment_.path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd_ < 0) return false;
+        uint8_t header[ASYNC_JOURNAL_SEGMENT_HEADER_SIZE];
+        async_journal::put_file_header(header, ASYNC_JOURNAL_SEGMENT_FLAG);
+        journal::put_u64(header + 8, segment_.first_seq);
+        journal::put_u64(header + 16, segment_.base_hash);
+        if (!write_fully(header, sizeof(header), 0)) return false;
+        offset_ = sizeof(header);
+        int dir = ::open(directory_.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        const bool synced = dir >= 0 && ::fsync(dir) == 0;
+        if (dir >= 0) ::close(dir);
+        return synced;
+    }
+
+    // Writes the index and footer after the last record, syncs and closes
+    // the segment. Nothing may be in flight.
+    bool seal_segment() {
+        segment_.records_end = offset_;
+        const std::vector<uint8_t> footer = async_journal::encode_footer(segment_);
+        if (!write_fully(footer.data(), footer.size(), offset_) ||
+            (config_.sync && ::fdatasync(fd_) != 0)) {
+            fail(errno);
+            return false;
+        }
+        offset_ += footer.size();
+        segment_.sealed = true;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stats_.bytes += footer.size();
+            stats_.segments++;
+            if (config_.sync) stats_.syncs++;
+        }
+        last_sync_ = std::chrono::steady_clock::now();
+        advance_durable(written());
+        ::close(fd_);
+        fd_ = -1;
+        return true;
+    }
+
+    // Full once the held event, or any event, no longer fits after the
+    // last record
+    bool segment_full() const {
+        return !segment_.empty() &&
+               offset_ + ASYNC_JOURNAL_RECORD_HEADER_SIZE + (held_ ? held_bytes_ : 1) > config_.segment_bytes;
+    }
+
+    void note_record(uint64_t offset, uint64_t first_seq, uint32_t count, uint64_t first_ts,
+                     uint64_t last_ts, uint64_t wall_ns, uint32_t crc) {
+        const bool indexed = first_seq >= next_index_seq_;
+        if (indexed) next_index_seq_ = first_seq + config_.index_events;
+        async_journal::extend_segment(segment_, offset, first_seq, first_seq + count - 1,
+                                      first_ts, last_ts, wall_ns, crc, indexed);
+        state_hash_ = segment_.state_hash;
+    }
+
+    // ========================================================================
+    // WRITER THREAD
+    // ========================================================================
+    // Fills one buffer while the other is in flight. A pending sync with no
+    // new data is issued on its own once the interval has passed. A full
+    // segment is sealed once its last write completes.
+    void writer_loop() {
+        size_t current = 0;
+        bool in_flight = false;
+        for (;;) {
+            const bool closing = closing_.load(std::memory_order_acquire);
+            if (failed()) {
+                // Events after the failure are lost; keep taking them so
+                // append() does not spill, until close()
+                Entry entry;
+                while (next_event(entry)) {}
+                if (closing) break;
+                std::this_thread::sleep_for(std::chrono::microseconds(50));
+                continue;
+            }
+            if (segmented() && segment_full()) {
+                if (in_flight) {
+                    complete();
+                    in_flight = false;
+                }
+                if (!failed() && seal_segment() && !open_segment()) fail(errno);
+            }
+            Buffer& buffer = buffers_[current];
+            fill(buffer);
+
+            if (buffer.size > 0) {
+                if (in_flight) {
+                    complete();
+                    in_flight = false;
+                    if (failed()) continue;  // Drops the filled buffer too
+                }
+                const bool sync_now = config_.sync && sync_due();
+                begin_write(buffer, sync_now);
+                in_flight = true;
+                current ^= 1;
+                continue;
+            }
+            if (in_flight) {
+                complete();
+                in_flight = false;
+                continue;
+            }
+            if (held_) continue;    // It waits on a full segment, sealed next
+            if (config_.sync && durable() < written() && (closing || sync_due())) {
+                sync_only();
+                continue;
+            }
+            if (closing) {
+                if (segmented() && !segment_.empty()) seal_segment();
+                break;
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+    }
+
+    // Moves queued events into `buffer` as records of up to record_events,
+    // stopping where the current segment is full. Each event is encoded
+    // before it is committed to a record; one that does not fit is held
+    // for the next fill, which makes room for it.
+    void fill(Buffer& buffer) {
+        buffer.size = 0;
+        buffer.records = 0;
+        if (held_ && ASYNC_JOURNAL_RECORD_HEADER_SIZE + held_bytes_ > buffer.capacity) {
+            buffer.grow(ASYNC_JOURNAL_RECORD_HEADER_SIZE + held_bytes_);
+        }
+        size_t limit = buffer.capacity;
+        if (segmented()) {
+            uint64_t left = offset_ >= config_.segment_bytes ? 0 : config_.segment_bytes - offset_;
+            if (held_ && segment_.empty()) {
+                left = std::max<uint64_t>(left, ASYNC_JOURNAL_RECORD_HEADER_SIZE + held_bytes_);
+            }
+            limit = static_cast<size_t>(std::min<uint64_t>(limit, left));
+        }
+        Entry entry;
+        uint64_t last_ts = 0;
+        while (limit > buffer.size + ASYNC_JOURNAL_RECORD_HEADER_SIZE) {
+            const size_t room = limit - buffer.size - ASYNC_JOURNAL_RECORD_HEADER_SIZE;
+            const uint64_t first_seq = next_seq_;
+            encoder_.reset();
+            while (encoder_.event_count() < config_.record_events && next_event(entry)) {
+                const JournalBlockEncoder::Mark mark = encoder_.mark();
+                encoder_.add(entry.event);
+                if (encoder_.payload().size() > room) {
+                    encoder_.rewind(mark);
+                    hold(entry);
+                    break;
+                }
+                last_ts = get_timestamp(entry.event).get();
+                ++next_seq_;
+            }
+            if (encoder_.event_count() == 0) break;
+
+            uint8_t* p = buffer.data + buffer.size;
+            const auto& payload = encoder_.payload();
+            const uint64_t sealed_ns = wall_ns();
+            journal::put_u32(p, static_cast<uint32_t>(payload.size()));
+            journal::put_u32(p + 4, encoder_.event_count());
+            journal::put_u64(p + 8, first_seq);
+            journal::put_u64(p + 16, sealed_ns);
+            const uint32_t crc = crc32c::extend(crc32c::value(p, ASYNC_JOURNAL_CRC_OFFSET),
+                                                payload.data(), payload.size());
+            journal::put_u32(p + ASYNC_JOURNAL_CRC_OFFSET, crc);
+            journal::put_u32(p + ASYNC_JOURNAL_CRC_OFFSET + 4, 0);
+            if (segmented()) {
+                note_record(offset_ + buffer.size, first_seq, encoder_.event_count(),
+                            encoder_.first_timestamp().get(), last_ts, sealed_ns, crc);
+            }
+            std::memcpy(p + ASYNC_JOURNAL_RECORD_HEADER_SIZE, payload.data(), payload.size());
+            buffer.size += ASYNC_JOURNAL_RECORD_HEADER_SIZE + payload.size();
+            ++buffer.records;
+            if (held_) break;
+        }
+        buffer.last_seq = next_seq_ - 1;
+    }
+
+    // Keeps an event that did not fit, with its size as the first event of
+    // a record
+    void hold(const Entry& entry) {
+        held_ = true;
+        held_entry_ = entry;
+        sizer_.reset();
+        sizer_.add(entry.event);
+        held_bytes_ = sizer_.payload().size();
+    }
+
+    void begin_write(const Buffer& buffer, bool sync_now) {
+        flight_ = Flight{buffer.data, buffer.size, offset_, buffer.last_seq, buffer.records, sync_now};
+        offset_ += buffer.size;
+#if MATCHING_ENGINE_HAS_IO_URING
+        if (uring_ok_.load(std::memory_order_relaxed)) {
+            io_uring_sqe* write = uring_.next_sqe();
+            write->opcode = IORING_OP_WRITE;
+            write->fd = fd_;
+            write->addr = reinterpret_cast<uint64_t>(buffer.data);
+            write->len = static_cast<uint32_t>(buffer.size);
+            write->off = flight_.offset;
+            write->user_data = WRITE_TAG;
+            if (sync_now) {
+                write->flags |= IOSQE_IO_LINK;
+                io_uring_sqe* sync = uring_.next_sqe();
+                sync->opcode = IORING_OP_FSYNC;
+                sync->fd = fd_;
+                sync->fsync_flags = IORING_FSYNC_DATASYNC;
+                sync->user_data = SYNC_TAG;
+            }
+            if (uring_.submit(0) >= 0) return;
+            uring_ok_.store(false, std::memory_order_relaxed);  // complete() pwrites instead
+        }
+#endif
+    }
+
+    // Waits for the in-flight write (and its sync) and advances the marks
+    void complete() {
+        bool wrote = false, synced = false;
+#if MATCHING_ENGINE_HAS_IO_URING
+        if (uring_ok_.load(std::memory_order_relaxed)) {
+            unsigned expected = flight_.sync ? 2 : 1;
+            size_t done = 0;
+            for (unsigned seen = 0; seen < expected;) {
+                io_uring_cqe cqe;
+                if (!uring_.pop(cqe)) {
+                    if (uring_.submit(1) < 0) break;
+                    continue;
+                }
+                ++seen;
+                if (cqe.user_data == WRITE_TAG && cqe.res > 0) done = static_cast<size_t>(cqe.res);
+                if (cqe.user_data == WRITE_TAG && (cqe.res == -EINVAL || cqe.res == -EOPNOTSUPP)) {
+                    uring_ok_.store(false, std::memory_order_relaxed);  // Kernel lacks the opcode
+                }
+                if (cqe.user_data == SYNC_TAG) synced = cqe.res == 0;
+            }
+            // Short write or unsupported opcode: finish with pwrite, and the
+            // linked sync (cancelled in that case) with fdatasync
+            wrote = done == flight_.size ||
+                    write_fully(flight_.data + done, flight_.size - done, flight_.offset + done);
+            if (flight_.sync && !synced && wrote) synced = ::fdatasync(fd_) == 0;
+        } else
+#endif
+        {
+            wrote = write_fully(flight_.data, flight_.size, flight_.offset);
+            if (flight_.sync && wrote) synced = ::fdatasync(fd_) == 0;
+        }
+
+        if (!wrote || (flight_.sync && !synced)) {
+            fail(errno ? errno : EIO);
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stats_.records += flight_.records;
+            stats_.writes++;
+            stats_.bytes += flight_.size;
+            if (flight_.sync) stats_.syncs++;
+        }
+        written_.store(flight_.last_seq, std::memory_order_release);
+        if (flight_.sync) {
+            last_sync_ = std::chrono::steady_clock::now();
+            advance_durable(flight_.last_seq);
+        } else if (!config_.sync) {
+            advance_durable(flight_.last_seq);
+        }
+    }
+
+    void sync_only() {
+        const uint64_t target = written();
+        if (::fdatasync(fd_) != 0) {
+            fail(errno);
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stats_.syncs++;
+        }
+        last_sync_ = std::chrono::steady_clock::now();
+        advance_durable(target);
+    }
+
+    bool sync_due() const {
+        return std::chrono::steady_clock::now() - last_sync_ >= config_.sync_interval;
+    }
+
+    void advance_durable(uint64_t seq) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            durable_.store(seq, std::memory_order_release);
+        }
+        durable_cv_.notify_all();
+    }
+
+    void fail(int error) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            error_.store(error ? error : EIO, std::memory_order_release);
+        }
+        durable_cv_.notify_all();
+    }
+
+    bool write_fully(const uint8_t* data, size_t size, uint64_t offset) {
+        while (size > 0) {
+            ssize_t n = ::pwrite(fd_, data, size, static_cast<off_t>(offset));
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return false;
+            data += n;
+            size -= static_cast<size_t>(n);
+            offset += static_cast<uint64_t>(n);
+        }
+        return true;
+    }
+
+    // A held event first, then the queue, then the spill list. The spill
+    // flag is read before the final queue pop, so every entry queued ahead
+    // of the first spill is taken before the list.
+    bool next_event(Entry& entry) {
+        if (held_) {
+            entry = held_entry_;
+            held_ = false;
+            return true;
+        }
+        if (!backlog_.empty()) {
+            entry.event = backlog_.front();
+            backlog_.pop_front();
+            return true;
+        }
+        if (!spilling_.load(std::memory_order_acquire)) return queue_.try_pop(entry);
+        if (queue_.try_pop(entry)) return true;
+        {
+            std::lock_guard<std::mutex> lock(spill_mutex_);
+            backlog_.swap(spill_);
+            spilling_.store(false, std::memory_order_release);
+        }
+        return next_event(entry);
+    }
+
+    static uint64_t wall_ns() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count());
+    }
+
+    struct Flight {
+        const uint8_t* data = nullptr;
+        size_t size = 0;
+        uint64_t offset = 0;
+        uint64_t last_seq = 0;
+        uint64_t records = 0;
+        bool sync = false;
+    };
+
+    AsyncJournalConfig config_;
+    SpscRing<Entry> queue_;
+    std::deque<Event> spill_;               // Guarded by spill_mutex_
+    std::mutex spill_mutex_;
+    std::atomic<bool> spilling_{false};
+    int fd_ = -1;
+#if MATCHING_ENGINE_HAS_IO_URING
+    UringQueue uring_;
+#endif
+    std::atomic<bool> uring_ok_{false};
+
+    // Writer thread only
+    Buffer buffers_[2];
+    JournalBlockEncoder encoder_;
+    JournalBlockEncoder sizer_;             // Measures held events
+    Entry held_entry_;                      // Taken but not yet in a record
+    size_t held_bytes_ = 0;
+    bool held_ = false;
+    std::deque<Event> backlog_;             // Spilled events taken over
+    Flight flight_;
+    uint64_t offset_ = 0;
+    uint64_t next_seq_ = 1;
+    std::string directory_;                 // Segmented journals only
+    JournalSegmentInfo segment_;            // The one being written
+    uint64_t next_index_seq_ = 1;
+    uint64_t state_hash_ = ASYNC_JOURNAL_HASH_SEED;
+    std::chrono::steady_clock::time_point last_sync_ = std::chrono::steady_clock::now();
+
+    std::atomic<uint64_t> appended_{0};
+    std::atomic<uint64_t> written_{0};
+    std::atomic<uint64_t> durable_{0};
+    std::atomic<uint64_t> spilled_{0};
+    std::atomic<int> error_{0};
+    std::atomic<bool> closing_{false};
+    mutable std::mutex mutex_;
+    std::condition_variable durable_cv_;
+    Stats stats_;
+    std::thread writer_;
+};
+
+#endif
@@ -0,0 +1,48 @@
+#ifndef COMMAND_HPP
+#define COMMAND_HPP
+
+#include "types.hpp"
+
+// ============================================================================
+// COMMAND - Fixed-size inbound instruction for batched processing
+// ============================================================================
+
+enum class CommandType : uint8_t {
+    NEW_ORDER = 0,
+    CANCEL_ORDER = 1,
+    MODIFY_ORDER = 2
+};
+
+struct Command {
+    CommandType type;
+    Side side;
+    OwnerId owner;
+    OrderId id;
+    Price price;
+    Quantity quantity;
+
+    static constexpr Command new_order(OrderId id, Side side, Price price, Quantity qty,
+                                       OwnerId owner = OwnerId(0)) {
+        return Command{CommandType::NEW_ORDER, side, owner, id, price, qty};
+    }
+
+    static constexpr Command cancel(OrderId id) {
+        return Command{CommandType::CANCEL_ORDER, Side::BUY, OwnerId(0), id, Price(0), Quantity(0)};
+    }
+
+    static constexpr Command modify(OrderId id, Price price, Quantity qty) {
+        return Command{CommandType::MODIFY_ORDER, Side::BUY, OwnerId(0), id, price, qty};
+    }
+};
+
+// ============================================================================
+// QUOTE ENTRY - One rung of a market maker's two-sided ladder
+// ============================================================================
+
+struct QuoteEntry {
+    OrderId id;         // Used only if the rung enters as a new order
+    Price price;
+    Quantity quantity;  // 0 pulls the rung
+};
+
+#endif
@@ -0,0 +1,100 @@
+#ifndef CRC32C_HPP
+#define CRC32C_HPP
+
+#include <array>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#include <nmmintrin.h>
+#define MATCHING_ENGINE_HAS_CRC32_INSN 1
+#else
+#define MATCHING_ENGINE_HAS_CRC32_INSN 0
+#endif
+
+// ============================================================================
+// CRC32C - Castagnoli checksum for journal records
+// ============================================================================
+//
+// extend() uses the SSE4.2 crc32 instruction when the CPU has it (checked
+// once at run time, so builds without -msse4.2 still get it) and a table
+// driven software loop otherwise. Both give the same result, e.g.
+// value("123456789", 9) == 0xE3069283.
+//
+// The running value is the finished CRC of the bytes so far: start from 0,
+// and extend(value(a), b) == value(a + b).
+
+namespace crc32c {
+
+constexpr uint32_t POLY = 0x82F63B78;  // Reflected Castagnoli polynomial
+
+inline const std::array<uint32_t, 256>& table() {
+    static const std::array<uint32_t, 256> t = [] {
+        std::array<uint32_t, 256> out{};
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k) c = (c >> 1) ^ (POLY & (0u - (c & 1)));
+            out[i] = c;
+        }
+        return out;
+    }();
+    return t;
+}
+
+inline uint32_t extend_software(uint32_t crc, const void* data, size_t len) {
+    const auto& t = table();
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    uint32_t c = ~crc;
+    while (len--) c = t[(c ^ *p++) & 0xFF] ^ (c >> 8);
+    return ~c;
+}
+
+#if MATCHING_ENGINE_HAS_CRC32_INSN
+__attribute__((target("sse4.2")))
+inline uint32_t extend_hardware(uint32_t crc, const void* data, size_t len) {
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+#if defined(__x86_64__)
+    uint64_t c = ~crc;
+    for (; len >= 8; len -= 8, p += 8) {
+        uint64_t word;
+        std::memcpy(&word, p, sizeof(word));
+        c = _mm_crc32_u64(c, word);
+    }
+    uint32_t c32 = static_cast<uint32_t>(c);
+#else
+    uint32_t c32 = ~crc;
+#endif
+    for (; len >= 4; len -= 4, p += 4) {
+        uint32_t word;
+        std::memcpy(&word, p, sizeof(word));
+        c32 = _mm_crc32_u32(c32, word);
+    }
+    while (len--) c32 = _mm_crc32_u8(c32, *p++);
+    return ~c32;
+}
+#endif
+
+inline bool hardware_available() {
+#if MATCHING_ENGINE_HAS_CRC32_INSN
+    static const bool available = __builtin_cpu_supports("sse4.2");
+    return available;
+#else
+    return false;
+#endif
+}
+
+inline uint32_t extend(uint32_t crc, const void* data, size_t len) {
+#if MATCHING_ENGINE_HAS_CRC32_INSN
+    if (hardware_available()) return extend_hardware(crc, data, len);
+#endif
+    return extend_software(crc, data, len);
+}
+
+inline uint32_t value(const void* data, size_t len) {
+    return extend(0, data, len);
+}
+
+}  // namespace crc32c
+
+#endif
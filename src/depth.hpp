@@ -0,0 +1,163 @@
+#ifndef DEPTH_HPP
+#define DEPTH_HPP
+
+#include "types.hpp"
+#include <vector>
+#include <optional>
+#include <cstddef>
+
+// ============================================================================
+// L2 DEPTH - Aggregated price levels and incremental level deltas
+// ============================================================================
+
+struct DepthLevel {
+    Price price;
+    Quantity total_volume;
+    size_t order_count;
+};
+
+enum class DeltaAction : uint8_t {
+    NEW = 0,
+    CHANGE = 1,
+    DELETE = 2
+};
+
+// One record per level mutation, in the order the engine applied them.
+// A publisher can apply these to its own top-N view without diffing snapshots.
+struct LevelDelta {
+    Timestamp timestamp;
+    Side side;
+    DeltaAction action;
+    Price price;
+    Quantity total_volume;   // Volume after the change (0 for DELETE)
+    size_t order_count;      // Orders after the change (0 for DELETE)
+};
+
+// Sum of price * qty over a sweep. 128 bits: a single level of a large
+// order at a high scaled price already exceeds 64 bits.
+__extension__ typedef __int128 Notional;
+
+// Outcome of a dry-run match (OrderBook::simulate_fill)
+struct FillEstimate {
+    Quantity filled{0};
+    Notional notional = 0;          // Sum of price * qty, in scaled price units
+    std::optional<Price> worst_price;   // Last level traded at, if any
+    size_t levels_touched = 0;
+
+    // Volume-weighted average price in price units (not scaled); 0 if unfilled
+    double vwap() const {
+        if (filled.get() == 0) return 0.0;
+        return static_cast<double>(notional) / static_cast<double>(filled.get()) / PRICE_SCALE;
+    }
+};
+
+// ============================================================================
+// DEPTH CACHE - Top-N snapshot rebuilt only when a top-N level changes
+// ============================================================================
+
+class DepthCache {
+private:
+    std::vector<DepthLevel> levels_;
+    size_t depth_;
+    bool dirty_;
+
+public:
+    explicit DepthCache(size_t depth) : depth_(depth), dirty_(true) {
+        levels_.reserve(depth);
+    }
+
+    size_t depth() const { return depth_; }
+
+    void set_depth(size_t depth) {
+        depth_ = depth;
+        levels_.reserve(depth);
+        dirty_ = true;
+    }
+
+    bool dirty() const { return dirty_; }
+
+    // `better_or_equal(a, b)` is true when price a ranks at or ahead of b on
+    // this side. A change can only affect the snapshot if the side currently
+    // has fewer than N levels or the price ranks within the cached N-th level.
+    // A depth-0 snapshot is always empty and never goes stale.
+    template<typename BetterOrEqual>
+    void on_level_changed(Price price, BetterOrEqual better_or_equal) {
+        if (dirty_ || depth_ == 0) return;
+        if (levels_.size() < depth_ || better_or_equal(price, levels_.back().price)) {
+            dirty_ = true;
+        }
+    }
+
+    // Rebuilds from levels ordered best-first. `levels` is any range of
+    // (key, LimitLevel) pairs, i.e. one side of the book.
+    template<typename LevelMap>
+    const std::vector<DepthLevel>& get(const LevelMap& levels) {
+        if (dirty_) {
+            levels_.clear();
+            for (auto it = levels.begin(); it != levels.end() && levels_.size() < depth_; ++it) {
+                const auto& level = it->second;
+                levels_.push_back({level.price, level.total_volume, level.order_count});
+            }
+            dirty_ = false;
+        }
+        return levels_;
+    }
+};
+
+// ============================================================================
+// CUMULATIVE DEPTH - Fenwick tree over tick-indexed level volumes
+// ============================================================================
+// Positions are 0-based tick offsets from the bottom of the price band.
+// Point updates and prefix sums are O(log n); the point values are kept
+// alongside so a level's new volume can be set without knowing the delta.
+
+class CumulativeDepth {
+private:
+    std::vector<uint64_t> tree_;     // 1-based Fenwick array
+    std::vector<uint64_t> volume_;   // Current volume per position
+    uint64_t total_ = 0;
+    size_t top_bit_ = 0;             // Highest power of two <= size
+
+public:
+    void reset(size_t n) {
+        tree_.assign(n + 1, 0);
+        volume_.assign(n, 0);
+        total_ = 0;
+        top_bit_ = 1;
+        while (top_bit_ * 2 <= n) top_bit_ *= 2;
+    }
+
+    size_t size() const { return volume_.size(); }
+    uint64_t total() const { return total_; }
+
+    void set(size_t pos, uint64_t volume) {
+        const uint64_t old = volume_[pos];
+        if (old == volume) return;
+        volume_[pos] = volume;
+        total_ += volume - old;     // Modular arithmetic handles decreases
+        for (size_t i = pos + 1; i < tree_.size(); i += i & (~i + 1)) {
+            tree_[i] += volume - old;
+        }
+    }
+
+    // Sum of positions [0, pos]
+    uint64_t prefix(size_t pos) const {
+        uint64_t sum = 0;
+        for (size_t i = pos + 1; i > 0; i -= i & (~i + 1)) sum += tree_[i];
+        return sum;
+    }
+
+    // Largest count c such that positions [0, c) sum to at most `target`
+    size_t max_prefix_within(uint64_t target) const {
+        size_t pos = 0;
+        for (size_t step = top_bit_; step > 0; step >>= 1) {
+            if (pos + step < tree_.size() && tree_[pos + step] <= target) {
+                pos += step;
+                target -= tree_[pos];
+            }
+        }
+        return pos;
+    }
+};
+
+#endif
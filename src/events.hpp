@@ -2,8 +2,13 @@
 #define EVENTS_HPP
 
 #include "types.hpp"
+#include "instrument.hpp"
+#include "command.hpp"
 #include <variant>
 #include <array>
+#include <vector>
+#include <memory>
+#include <limits>
 
 // ============================================================================
 // EVENT SYSTEM
@@ -13,11 +18,17 @@ enum class EventType : uint8_t {
     NEW_ORDER = 0,
     CANCEL_ORDER = 1,
     TRADE = 2,
-    SNAPSHOT = 3
+    SNAPSHOT = 3,
+    MODIFY_ORDER = 4,
+    MASS_CANCEL = 5,
+    QUOTE = 6,
+    LEVEL_TRADE = 7,
+    INSTRUMENT = 8,
+    REJECT = 9
 };
 
 // ============================================================================
-// EVENT STRUCTS - POD types
+// EVENT STRUCTS - POD types (QuoteEvent aside, which shares its ladder)
 // ============================================================================
 
 struct NewOrderEvent {
@@ -25,18 +36,20 @@ struct NewOrderEvent {
     Timestamp timestamp;
     OrderId order_id;
     Side side;
+    OwnerId owner;
     Price price;
     Quantity quantity;
     
-    NewOrderEvent(Timestamp ts, OrderId id, Side s, Price p, Quantity q)
+    NewOrderEvent(Timestamp ts, OrderId id, Side s, Price p, Quantity q,
+                  OwnerId o = OwnerId(0))
         : type(EventType::NEW_ORDER), timestamp(ts), 
-          order_id(id), side(s), price(p), quantity(q) {}
+          order_id(id), side(s), owner(o), price(p), quantity(q) {}
     
     // Fast string formatting (avoid std::stringstream)
     void to_buffer(char* buffer, size_t size) const {
-        snprintf(buffer, size, "NEW_ORDER,%lu,%lu,%s,%ld,%lu",
+        snprintf(buffer, size, "NEW_ORDER,%lu,%lu,%s,%ld,%lu,%u",
                 timestamp.get(), order_id.get(), to_string(side),
-                price.get(), quantity.get());
+                price.get(), quantity.get(), owner.get());
     }
 };
 
@@ -54,6 +67,122 @@ struct CancelOrderEvent {
     }
 };
 
+struct ModifyOrderEvent {
+    EventType type;
+    Timestamp timestamp;
+    OrderId order_id;
+    Price price;
+    Quantity quantity;      // New remaining quantity
+    
+    ModifyOrderEvent(Timestamp ts, OrderId id, Price p, Quantity q)
+        : type(EventType::MODIFY_ORDER), timestamp(ts), 
+          order_id(id), price(p), quantity(q) {}
+    
+    void to_buffer(char* buffer, size_t size) const {
+        snprintf(buffer, size, "MODIFY_ORDER,%lu,%lu,%ld,%lu",
+                timestamp.get(), order_id.get(), price.get(), quantity.get());
+    }
+};
+
+// Scope of a mass cancel. All criteria must match; defaults match everything.
+// The owner wildcard is a reserved id of its own, so for_owner(OwnerId(0))
+// cancels only orders entered without an owner.
+struct MassCancelFilter {
+    static constexpr uint8_t BUY_SIDE = 1;
+    static constexpr uint8_t SELL_SIDE = 2;
+    static constexpr OwnerId ANY_OWNER = OwnerId(std::numeric_limits<uint32_t>::max());
+    
+    uint8_t sides = BUY_SIDE | SELL_SIDE;
+    OwnerId owner = ANY_OWNER;
+    Price min_price = Price(std::numeric_limits<int64_t>::min());  // Inclusive
+    Price max_price = Price(std::numeric_limits<int64_t>::max());  // Inclusive
+    
+    static MassCancelFilter all() { return {}; }
+    
+    static MassCancelFilter for_side(Side side) {
+        MassCancelFilter f;
+        f.sides = side == Side::BUY ? BUY_SIDE : SELL_SIDE;
+        return f;
+    }
+    
+    static MassCancelFilter for_owner(OwnerId owner) {
+        MassCancelFilter f;
+        f.owner = owner;
+        return f;
+    }
+    
+    static MassCancelFilter for_price_range(Side side, Price lo, Price hi) {
+        MassCancelFilter f = for_side(side);
+        f.min_price = lo;
+        f.max_price = hi;
+        return f;
+    }
+    
+    bool includes(Side side) const {
+        return sides & (side == Side::BUY ? BUY_SIDE : SELL_SIDE);
+    }
+    
+    bool any_owner() const {
+        return owner == ANY_OWNER;
+    }
+};
+
+// One compact record for the whole operation; replay re-expands it
+// against the replayed book, which is in the same state by construction.
+struct MassCancelEvent {
+    EventType type;
+    Timestamp timestamp;
+    MassCancelFilter filter;
+    
+    MassCancelEvent(Timestamp ts, const MassCancelFilter& f)
+        : type(EventType::MASS_CANCEL), timestamp(ts), filter(f) {}
+    
+    void to_buffer(char* buffer, size_t size) const {
+        snprintf(buffer, size, "MASS_CANCEL,%lu,%u,%u,%ld,%ld",
+                timestamp.get(), static_cast<unsigned>(filter.sides), filter.owner.get(),
+                filter.min_price.get(), filter.max_price.get());
+    }
+};
+
+// Both ladders of a two-sided quote, bids first. Immutable once logged
+// and shared by every copy of its QuoteEvent.
+struct QuoteLadder {
+    uint32_t bid_count = 0;
+    std::vector<QuoteEntry> rungs;
+    
+    const QuoteEntry* bids() const { return rungs.data(); }
+    const QuoteEntry* asks() const { return rungs.data() + bid_count; }
+    size_t ask_count() const { return rungs.size() - bid_count; }
+};
+
+// A whole two-sided quote as one input, so it is journaled, replicated and
+// replayed all or nothing. Copies share the ladder (never null).
+struct QuoteEvent {
+    EventType type;
+    Timestamp timestamp;
+    OwnerId owner;
+    std::shared_ptr<const QuoteLadder> ladder;
+    
+    QuoteEvent(Timestamp ts, OwnerId o, std::shared_ptr<const QuoteLadder> l)
+        : type(EventType::QUOTE), timestamp(ts), owner(o), ladder(std::move(l)) {}
+    
+    // Rungs follow the header as id,price,qty triples. Those that do not
+    // fit in `size` are cut off; csv_bytes() is always enough.
+    void to_buffer(char* buffer, size_t size) const {
+        int n = snprintf(buffer, size, "QUOTE,%lu,%u,%u,%zu",
+                         timestamp.get(), owner.get(), ladder->bid_count, ladder->ask_count());
+        for (const QuoteEntry& r : ladder->rungs) {
+            if (n < 0 || static_cast<size_t>(n) >= size) return;
+            n += snprintf(buffer + n, size - static_cast<size_t>(n), ",%lu,%ld,%lu",
+                          r.id.get(), r.price.get(), r.quantity.get());
+        }
+    }
+    
+    size_t csv_bytes() const {
+        return 64 + 64 * ladder->rungs.size();
+    }
+};
+
 struct TradeEvent {
     EventType type;
     Timestamp timestamp;
@@ -75,11 +204,71 @@ struct TradeEvent {
     }
 };
 
+// Summary of every fill one aggressive order took at one price level,
+// logged instead of per-fill TradeEvents in FillReporting::PER_LEVEL mode.
+// Timestamp is that of the last fill at the level.
+struct LevelTradeEvent {
+    EventType type;
+    Timestamp timestamp;
+    OrderId aggressive_order_id;
+    Side aggressor_side;
+    Price price;
+    Quantity quantity;      // Total traded at this level
+    uint32_t fill_count;    // Passive orders hit
+    
+    LevelTradeEvent(Timestamp ts, OrderId aggressive, Side s, Price p, Quantity q,
+                    uint32_t fills)
+        : type(EventType::LEVEL_TRADE), timestamp(ts), aggressive_order_id(aggressive),
+          aggressor_side(s), price(p), quantity(q), fill_count(fills) {}
+    
+    void to_buffer(char* buffer, size_t size) const {
+        snprintf(buffer, size, "LEVEL_TRADE,%lu,%lu,%s,%ld,%lu,%u",
+                timestamp.get(), aggressive_order_id.get(), to_string(aggressor_side),
+                price.get(), quantity.get(), fill_count);
+    }
+};
+
+// Reference data change; an input, so replay re-applies it in sequence
+struct InstrumentEvent {
+    EventType type;
+    Timestamp timestamp;
+    Instrument instrument;
+    
+    InstrumentEvent(Timestamp ts, const Instrument& inst)
+        : type(EventType::INSTRUMENT), timestamp(ts), instrument(inst) {}
+    
+    void to_buffer(char* buffer, size_t size) const {
+        snprintf(buffer, size, "INSTRUMENT,%lu,%ld,%lu,%ld,%ld,%ld",
+                timestamp.get(), instrument.tick_size.get(), instrument.lot_size.get(),
+                instrument.base_price.get(), instrument.min_price.get(),
+                instrument.max_price.get());
+    }
+};
+
+// An order, modify or quote rung refused by reference data validation.
+// Derived from the input it follows, like a trade.
+struct RejectOrderEvent {
+    EventType type;
+    Timestamp timestamp;
+    OrderId order_id;
+    RejectReason reason;
+    
+    RejectOrderEvent(Timestamp ts, OrderId id, RejectReason r)
+        : type(EventType::REJECT), timestamp(ts), order_id(id), reason(r) {}
+    
+    void to_buffer(char* buffer, size_t size) const {
+        snprintf(buffer, size, "REJECT,%lu,%lu,%s",
+                timestamp.get(), order_id.get(), to_string(reason));
+    }
+};
+
 // ============================================================================
 // EVENT VARIANT - Type-safe union without virtual functions
 // ============================================================================
 
-using Event = std::variant<NewOrderEvent, CancelOrderEvent, TradeEvent>;
+using Event = std::variant<NewOrderEvent, CancelOrderEvent, TradeEvent,
+                           ModifyOrderEvent, MassCancelEvent, QuoteEvent,
+                           LevelTradeEvent, InstrumentEvent, RejectOrderEvent>;
 
 // Helper for getting event type
 inline EventType get_event_type(const Event& event) {
@@ -98,4 +287,17 @@ inline void event_to_buffer(const Event& event, char* buffer, size_t size) {
     }, event);
 }
 
+// ============================================================================
+// EVENT SINK - Receives every event as the book logs it
+// ============================================================================
+// The book calls on_event() on the matching thread, so implementations
+// must hand the event off rather than block (AsyncJournal queues it for
+// its writer thread).
+
+class EventSink {
+public:
+    virtual ~EventSink() = default;
+    virtual void on_event(const Event& event) = 0;
+};
+
 #endif
\ No newline at end of file
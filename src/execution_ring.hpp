@@ -0,0 +1,260 @@
+#ifndef EXECUTION_RING_HPP
+#define EXECUTION_RING_HPP
+
+#include "types.hpp"
+#include <atomic>
+#include <array>
+#include <memory>
+#include <cstring>
+#include <cstddef>
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+
+// ============================================================================
+// EXECUTION REPORT - Fixed-size record published to downstream consumers
+// ============================================================================
+
+enum class ReportType : uint8_t {
+    ACK_NEW = 0,
+    ACK_CANCEL = 1,
+    REJECT_CANCEL = 2,
+    FILL = 3,
+    ACK_MODIFY = 4,
+    REJECT_MODIFY = 5,
+    ACK_MASS_CANCEL = 6,    // quantity = number of orders cancelled, each of
+                            // which got its own ACK_CANCEL first
+    ACK_QUOTE = 7,          // quantity = number of rungs quoted; each rung
+                            // then gets its own ACK_NEW / ACK_MODIFY /
+                            // ACK_CANCEL / REJECT_NEW
+    REJECT_QUOTE = 8,       // quantity = RejectReason
+    LEVEL_FILL = 9,         // Per-level summary: order_id = aggressor,
+                            // fill_count = number of passive fills
+    REJECT_NEW = 10         // quantity = RejectReason (so does a validation
+                            // REJECT_MODIFY)
+};
+
+// Side of a report about no known order (e.g. a cancel or modify for an
+// unknown id); never the side of a real order
+constexpr Side NO_SIDE = static_cast<Side>(0xFF);
+
+struct ExecutionReport {
+    ReportType type;
+    Side side;
+    uint32_t fill_count;        // Passive fills summarised by LEVEL_FILL, 0 otherwise
+    uint64_t timestamp;
+    uint64_t order_id;
+    uint64_t contra_order_id;   // Aggressive order for FILL, 0 otherwise
+    int64_t price;
+    uint64_t quantity;
+};
+
+static_assert(std::is_trivially_copyable_v<ExecutionReport>,
+              "ExecutionReport is copied word-by-word through the ring");
+static_assert(sizeof(ExecutionReport) == 48,
+              "fill_count must stay in the padding after side");
+
+// ============================================================================
+// EXECUTION RING - Lock-free single-producer / multi-consumer broadcast ring
+// ============================================================================
+//
+// Every consumer sees every record (broadcast, not work-sharing). The producer
+// never waits for consumers: each slot carries its own sequence stamp, so a
+// consumer that falls more than Capacity records behind detects the overwrite
+// on read and reports it as an overrun instead of stalling the engine.
+//
+// Slot payloads are stored as relaxed atomic words, which keeps the seqlock
+// style read (stamp, copy, stamp) free of data races.
+
+enum class PollResult : uint8_t {
+    OK = 0,
+    EMPTY = 1,
+    OVERRUN = 2
+};
+
+template<size_t Capacity, size_t MaxConsumers = 8>
+class ExecutionRing {
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0,
+                  "Capacity must be a power of two");
+
+    static constexpr size_t WORDS = (sizeof(ExecutionReport) + 7) / 8;
+    static constexpr uint64_t BUSY = ~uint64_t(0);
+
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> stamp{0};      // sequence + 1 when complete
+        std::atomic<uint64_t> words[WORDS];
+    };
+
+    struct alignas(64) ConsumerCursor {
+        std::atomic<uint64_t> position{0};   // Next sequence the consumer reads
+        std::atomic<uint64_t> overruns{0};   // Records lost to overwrites
+        std::atomic<bool> claimed{false};    // Slot owned by a Consumer
+        std::atomic<bool> active{false};     // Position valid for lag checks
+    };
+
+    std::unique_ptr<Slot[]> slots_;
+    alignas(64) std::atomic<uint64_t> published_{0};  // Records published so far
+    alignas(64) std::array<ConsumerCursor, MaxConsumers> cursors_;
+
+public:
+    static constexpr size_t capacity = Capacity;
+
+    ExecutionRing() : slots_(new Slot[Capacity]) {}
+
+    ExecutionRing(const ExecutionRing&) = delete;
+    ExecutionRing& operator=(const ExecutionRing&) = delete;
+
+    // ========================================================================
+    // PRODUCER (matching thread only)
+    // ========================================================================
+    void publish(const ExecutionReport& report) {
+        uint64_t seq = published_.load(std::memory_order_relaxed);
+        Slot& slot = slots_[seq & (Capacity - 1)];
+
+        uint64_t words[WORDS] = {};
+        std::memcpy(words, &report, sizeof(report));
+
+        slot.stamp.store(BUSY, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (size_t i = 0; i < WORDS; ++i) {
+            slot.words[i].store(words[i], std::memory_order_relaxed);
+        }
+        slot.stamp.store(seq + 1, std::memory_order_release);
+        published_.store(seq + 1, std::memory_order_release);
+    }
+
+    uint64_t published() const {
+        return published_.load(std::memory_order_acquire);
+    }
+
+    // ========================================================================
+    // CONSUMER REGISTRATION
+    // ========================================================================
+    class Consumer {
+        ExecutionRing* ring_;
+        ConsumerCursor* cursor_;
+        uint64_t next_;
+
+    public:
+        Consumer(ExecutionRing* ring, ConsumerCursor* cursor, uint64_t start)
+            : ring_(ring), cursor_(cursor), next_(start) {}
+
+        Consumer(Consumer&& other) noexcept
+            : ring_(other.ring_), cursor_(other.cursor_), next_(other.next_) {
+            other.cursor_ = nullptr;
+        }
+
+        Consumer(const Consumer&) = delete;
+        Consumer& operator=(const Consumer&) = delete;
+        Consumer& operator=(Consumer&&) = delete;
+
+        ~Consumer() {
+            if (cursor_) {
+                cursor_->active.store(false, std::memory_order_release);
+                cursor_->claimed.store(false, std::memory_order_release);
+            }
+        }
+
+        // Reads the next record. On OVERRUN the cursor skips past the
+        // overwritten records and their count is added to overruns(); the
+        // caller decides whether to resync from a snapshot or give up.
+        PollResult poll(ExecutionReport& out) {
+            uint64_t published = ring_->published_.load(std::memory_order_acquire);
+            if (next_ >= published) return PollResult::EMPTY;
+
+            if (published - next_ > Capacity) {
+                return skip_to_oldest(published);
+            }
+
+            Slot& slot = ring_->slots_[next_ & (Capacity - 1)];
+            uint64_t before = slot.stamp.load(std::memory_order_acquire);
+            if (before != next_ + 1) {
+                return skip_to_oldest(ring_->published_.load(std::memory_order_acquire));
+            }
+
+            uint64_t words[WORDS];
+            for (size_t i = 0; i < WORDS; ++i) {
+                words[i] = slot.words[i].load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            uint64_t after = slot.stamp.load(std::memory_order_relaxed);
+            if (after != before) {
+                return skip_to_oldest(ring_->published_.load(std::memory_order_acquire));
+            }
+
+            std::memcpy(&out, words, sizeof(out));
+            ++next_;
+            cursor_->position.store(next_, std::memory_order_release);
+            return PollResult::OK;
+        }
+
+        uint64_t position() const { return next_; }
+
+        uint64_t overruns() const {
+            return cursor_->overruns.load(std::memory_order_relaxed);
+        }
+
+    private:
+        PollResult skip_to_oldest(uint64_t published) {
+            // Leave half the ring as headroom so the producer does not lap
+            // the consumer again on the very next read.
+            uint64_t oldest = published > Capacity / 2 ? published - Capacity / 2 : 0;
+            if (oldest <= next_) oldest = next_ + 1;
+            cursor_->overruns.fetch_add(oldest - next_, std::memory_order_relaxed);
+            next_ = oldest;
+            cursor_->position.store(next_, std::memory_order_release);
+            return PollResult::OVERRUN;
+        }
+    };
+
+    // Registers a consumer starting at the current head. Returns a consumer
+    // bound to a free cursor slot; throws if all MaxConsumers are in use.
+    // The slot is claimed first and only marked active once its start
+    // position is stored, so lag checks never read a stale position.
+    Consumer subscribe() {
+        for (auto& cursor : cursors_) {
+            bool expected = false;
+            if (cursor.claimed.compare_exchange_strong(expected, true,
+                                                       std::memory_order_acq_rel)) {
+                uint64_t start = published_.load(std::memory_order_acquire);
+                cursor.position.store(start, std::memory_order_relaxed);
+                cursor.overruns.store(0, std::memory_order_relaxed);
+                cursor.active.store(true, std::memory_order_release);
+                return Consumer(this, &cursor, start);
+            }
+        }
+        throw std::runtime_error("ExecutionRing: no free consumer slot");
+    }
+
+    // ========================================================================
+    // SLOW CONSUMER DETECTION (any thread, never blocks the producer)
+    // ========================================================================
+    // Number of active consumers lagging by more than `threshold` records.
+    size_t slow_consumers(uint64_t threshold) const {
+        uint64_t published = published_.load(std::memory_order_acquire);
+        size_t count = 0;
+        for (const auto& cursor : cursors_) {
+            if (!cursor.active.load(std::memory_order_acquire)) continue;
+            uint64_t pos = cursor.position.load(std::memory_order_acquire);
+            if (published - pos > threshold) ++count;
+        }
+        return count;
+    }
+
+    // Largest lag among active consumers, in records.
+    uint64_t max_lag() const {
+        uint64_t published = published_.load(std::memory_order_acquire);
+        uint64_t lag = 0;
+        for (const auto& cursor : cursors_) {
+            if (!cursor.active.load(std::memory_order_acquire)) continue;
+            uint64_t pos = cursor.position.load(std::memory_order_acquire);
+            lag = std::max(lag, published - pos);
+        }
+        return lag;
+    }
+};
+
+// Default ring used by OrderBook (64K records, ~4 MB)
+using ExecutionStream = ExecutionRing<1 << 16>;
+
+#endif
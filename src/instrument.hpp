@@ -0,0 +1,120 @@
+#ifndef INSTRUMENT_HPP
+#define INSTRUMENT_HPP
+
+#include "types.hpp"
+#include <limits>
+
+// ============================================================================
+// INSTRUMENT - Tick/lot reference data and static price bands
+// ============================================================================
+//
+// Valid prices are base_price + k * tick_size for integer k, within
+// [min_price, max_price]. Orders and levels keep their full 64-bit Price;
+// the 32-bit tick index k is only a position, recorded per level for the
+// tick-indexed cumulative depth, so the band may span at most 2^31 - 1
+// ticks either side of the base. The default instrument accepts every
+// price and any non-zero size, which is the engine's behaviour without
+// reference data, and has no meaningful tick index.
+
+enum class RejectReason : uint8_t {
+    NONE = 0,
+    ZERO_QUANTITY = 1,
+    ODD_LOT = 2,            // Quantity not a multiple of the lot size
+    OFF_TICK = 3,           // Price not on the tick grid
+    OUTSIDE_BAND = 4,       // Price outside [min_price, max_price]
+    POOL_EXHAUSTED = 5,     // No free order slot for a remainder to rest in
+    NO_OWNER = 6,           // Quote without an owner to track its ladder by
+    CROSSED_QUOTE = 7,      // Quote whose best bid rung reaches its best ask
+    RESERVED_OWNER = 8      // Order under the mass-cancel wildcard owner
+};
+
+inline const char* to_string(RejectReason reason) {
+    switch (reason) {
+        case RejectReason::NONE: return "NONE";
+        case RejectReason::ZERO_QUANTITY: return "ZERO_QUANTITY";
+        case RejectReason::ODD_LOT: return "ODD_LOT";
+        case RejectReason::OFF_TICK: return "OFF_TICK";
+        case RejectReason::OUTSIDE_BAND: return "OUTSIDE_BAND";
+        case RejectReason::POOL_EXHAUSTED: return "POOL_EXHAUSTED";
+        case RejectReason::NO_OWNER: return "NO_OWNER";
+        case RejectReason::CROSSED_QUOTE: return "CROSSED_QUOTE";
+        case RejectReason::RESERVED_OWNER: return "RESERVED_OWNER";
+    }
+    return "UNKNOWN";
+}
+
+struct Instrument {
+    Price tick_size = Price(1);
+    Quantity lot_size = Quantity(1);
+    Price base_price = Price(0);                                // Tick index 0
+    Price min_price = Price(std::numeric_limits<int64_t>::min());  // Inclusive
+    Price max_price = Price(std::numeric_limits<int64_t>::max());  // Inclusive
+
+    static Instrument unrestricted() { return {}; }
+
+    // Band of `ticks_each_side` ticks around base_price. A band whose edges
+    // do not fit a Price comes back inverted, which valid() refuses.
+    static Instrument make(Price tick, Quantity lot, Price base, int32_t ticks_each_side) {
+        Instrument inst;
+        inst.tick_size = tick;
+        inst.lot_size = lot;
+        inst.base_price = base;
+        int64_t width, low, high;
+        if (__builtin_mul_overflow(int64_t(ticks_each_side), tick.get(), &width) ||
+            __builtin_sub_overflow(base.get(), width, &low) ||
+            __builtin_add_overflow(base.get(), width, &high)) {
+            inst.min_price = Price(std::numeric_limits<int64_t>::max());
+            inst.max_price = Price(std::numeric_limits<int64_t>::min());
+            return inst;
+        }
+        inst.min_price = Price(low);
+        inst.max_price = Price(high);
+        return inst;
+    }
+
+    // True if the parameters are usable: positive tick and lot, an ordered
+    // band, and every in-band tick index representable in 32 bits
+    bool valid() const {
+        if (tick_size.get() <= 0 || lot_size.get() == 0 || min_price > max_price) return false;
+        if (restricts_prices()) {
+            return span_ticks(min_price) && span_ticks(max_price);
+        }
+        return true;
+    }
+
+    // False for the default instrument, whose tick indices are meaningless
+    bool restricts_prices() const {
+        return min_price.get() != std::numeric_limits<int64_t>::min() ||
+               max_price.get() != std::numeric_limits<int64_t>::max();
+    }
+
+    RejectReason validate(Price price, Quantity qty) const {
+        if (qty.get() == 0) return RejectReason::ZERO_QUANTITY;
+        if (lot_size.get() != 1 && qty.get() % lot_size.get() != 0) return RejectReason::ODD_LOT;
+        if (price < min_price || price > max_price) return RejectReason::OUTSIDE_BAND;
+        if (tick_size.get() != 1 && (price.get() - base_price.get()) % tick_size.get() != 0) {
+            return RejectReason::OFF_TICK;
+        }
+        return RejectReason::NONE;
+    }
+
+    // Only meaningful for validated prices of a price-restricting instrument
+    int32_t to_tick(Price price) const {
+        return static_cast<int32_t>((price.get() - base_price.get()) / tick_size.get());
+    }
+
+    Price from_tick(int32_t tick) const {
+        return Price(base_price.get() + int64_t(tick) * tick_size.get());
+    }
+
+private:
+    bool span_ticks(Price bound) const {
+        int64_t diff;
+        if (__builtin_sub_overflow(bound.get(), base_price.get(), &diff)) return false;
+        int64_t ticks = diff / tick_size.get();
+        return ticks >= std::numeric_limits<int32_t>::min() &&
+               ticks <= std::numeric_limits<int32_t>::max();
+    }
+};
+
+#endif
@@ -0,0 +1,640 @@
+#ifndef JOURNAL_HPP
+#define JOURNAL_HPP
+
+#include "types.hpp"
+#include "events.hpp"
+#include <vector>
+#include <string>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <algorithm>
+#include <cstring>
+#include <cstddef>
+
+// ============================================================================
+// JOURNAL - Block-compressed binary event log
+// ============================================================================
+//
+// A compact alternative to the CSV log. Events are grouped into blocks;
+// within a block timestamps, order ids and prices are stored as zigzag
+// varint deltas from the previous event, everything else as plain varints.
+// Delta state restarts at every block, so any block decodes on its own and
+// the index at the end of the file allows seeking by timestamp.
+//
+//   File header   magic u32, version u16, reserved u16                8 bytes
+//   Block         payload_bytes u32, event_count u32, first_ts u64,
+//                 payload                                          16 + n bytes
+//   Index entry   offset u64, first_event u64, first_ts u64,
+//                 event_count u32, payload_bytes u32                  32 bytes
+//   Footer        index_offset u64, block_count u32, magic u32        16 bytes
+//
+// Fixed-width integers are little-endian. Each event starts with a tag byte:
+// the EventType in the low bits, the side (where the event has one) in bit 7.
+
+constexpr uint32_t JOURNAL_MAGIC = 0x314A454D;        // "MEJ1"
+constexpr uint32_t JOURNAL_INDEX_MAGIC = 0x58444E49;  // "INDX"
+constexpr uint16_t JOURNAL_VERSION = 1;
+
+constexpr size_t JOURNAL_FILE_HEADER_SIZE = 8;
+constexpr size_t JOURNAL_BLOCK_HEADER_SIZE = 16;
+constexpr size_t JOURNAL_INDEX_ENTRY_SIZE = 32;
+constexpr size_t JOURNAL_FOOTER_SIZE = 16;
+constexpr size_t JOURNAL_DEFAULT_BLOCK_EVENTS = 4096;
+
+namespace journal {
+
+constexpr uint8_t SIDE_BIT = 0x80;
+
+inline void put_u16(uint8_t* p, uint16_t v) {
+    p[0] = static_cast<uint8_t>(v);
+    p[1] = static_cast<uint8_t>(v >> 8);
+}
+
+inline void put_u32(uint8_t* p, uint32_t v) {
+    for (int i = 0; i < 4; ++i) p[i] = static_cast<uint8_t>(v >> (8 * i));
+}
+
+inline void put_u64(uint8_t* p, uint64_t v) {
+    for (int i = 0; i < 8; ++i) p[i] = static_cast<uint8_t>(v >> (8 * i));
+}
+
+inline uint16_t get_u16(const uint8_t* p) {
+    return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+inline uint32_t get_u32(const uint8_t* p) {
+    uint32_t v = 0;
+    for (int i = 3; i >= 0; --i) v = (v << 8) | p[i];
+    return v;
+}
+
+inline uint64_t get_u64(const uint8_t* p) {
+    uint64_t v = 0;
+    for (int i = 7; i >= 0; --i) v = (v << 8) | p[i];
+    return v;
+}
+
+inline uint64_t zigzag(int64_t v) {
+    return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63);
+}
+
+inline int64_t unzigzag(uint64_t v) {
+    return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1);
+}
+
+// Appends v in 7-bit groups, low group first; at most 10 bytes
+inline void put_varint(std::vector<uint8_t>& out, uint64_t v) {
+    while (v >= 0x80) {
+        out.push_back(static_cast<uint8_t>(v | 0x80));
+        v >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(v));
+}
+
+// Returns false on truncated or over-long input
+inline bool get_varint(const uint8_t*& p, const uint8_t* end, uint64_t& v) {
+    if (p < end && *p < 0x80) {     // Common case: one byte
+        v = *p++;
+        return true;
+    }
+    v = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (p == end) return false;
+        uint8_t byte = *p++;
+        v |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if (byte < 0x80) return true;
+    }
+    return false;
+}
+
+} // namespace journal
+
+// Position and coverage of one block, as stored in the file index
+struct JournalBlockInfo {
+    uint64_t offset;            // Of the block header, from the start of the file
+    uint64_t first_event;       // Sequence number of the block's first event
+    Timestamp first_timestamp;
+    uint32_t event_count;
+    uint32_t payload_bytes;
+};
+
+// ============================================================================
+// BLOCK ENCODER - Events to delta/varint payload
+// ============================================================================
+
+class JournalBlockEncoder {
+private:
+    std::vector<uint8_t> payload_;
+    uint32_t event_count_ = 0;
+    Timestamp first_timestamp_{0};
+    uint64_t prev_ts_ = 0;
+    uint64_t prev_id_ = 0;
+    int64_t prev_price_ = 0;
+
+public:
+    void reset() {
+        payload_.clear();
+        event_count_ = 0;
+        first_timestamp_ = Timestamp(0);
+        prev_ts_ = 0;
+        prev_id_ = 0;
+        prev_price_ = 0;
+    }
+
+    const std::vector<uint8_t>& payload() const { return payload_; }
+    uint32_t event_count() const { return event_count_; }
+    Timestamp first_timestamp() const { return first_timestamp_; }
+
+    void add(const Event& event) {
+        if (event_count_++ == 0) first_timestamp_ = get_timestamp(event);
+        std::visit([this](const auto& e) { encode(e); }, event);
+    }
+
+    // Encoder state between two adds; rewind() drops the events added
+    // since mark() was taken, delta chains included
+    struct Mark {
+        size_t bytes;
+        uint32_t event_count;
+        Timestamp first_timestamp;
+        uint64_t prev_ts;
+        uint64_t prev_id;
+        int64_t prev_price;
+    };
+
+    Mark mark() const {
+        return {payload_.size(), event_count_, first_timestamp_, prev_ts_, prev_id_, prev_price_};
+    }
+
+    void rewind(const Mark& m) {
+        payload_.resize(m.bytes);
+        event_count_ = m.event_count;
+        first_timestamp_ = m.first_timestamp;
+        prev_ts_ = m.prev_ts;
+        prev_id_ = m.prev_id;
+        prev_price_ = m.prev_price;
+    }
+
+private:
+    void tag(EventType type, Side side = Side::BUY) {
+        payload_.push_back(static_cast<uint8_t>(type) |
+                           (side == Side::SELL ? journal::SIDE_BIT : 0));
+    }
+
+    void timestamp(Timestamp ts) {
+        journal::put_varint(payload_, journal::zigzag(
+            static_cast<int64_t>(ts.get() - prev_ts_)));
+        prev_ts_ = ts.get();
+    }
+
+    void id(OrderId id) {
+        journal::put_varint(payload_, journal::zigzag(
+            static_cast<int64_t>(id.get() - prev_id_)));
+        prev_id_ = id.get();
+    }
+
+    void price(Price p) {
+        journal::put_varint(payload_, journal::zigzag(p.get() - prev_price_));
+        prev_price_ = p.get();
+    }
+
+    void value(uint64_t v) {
+        journal::put_varint(payload_, v);
+    }
+
+    void encode(const NewOrderEvent& e) {
+        tag(e.type, e.side);
+        timestamp(e.timestamp);
+        id(e.order_id);
+        price(e.price);
+        value(e.quantity.get());
+        value(e.owner.get());
+    }
+
+    void encode(const CancelOrderEvent& e) {
+        tag(e.type);
+        timestamp(e.timestamp);
+        id(e.order_id);
+    }
+
+    void encode(const TradeEvent& e) {
+        tag(e.type);
+        timestamp(e.timestamp);
+        id(e.passive_order_id);
+        id(e.aggressive_order_id);
+        price(e.price);
+        value(e.quantity.get());
+    }
+
+    void encode(const ModifyOrderEvent& e) {
+        tag(e.type);
+        timestamp(e.timestamp);
+        id(e.order_id);
+        price(e.price);
+        value(e.quantity.get());
+    }
+
+    // Rare: the range bounds are stored whole, outside the price delta chain
+    void encode(const MassCancelEvent& e) {
+        tag(e.type);
+        timestamp(e.timestamp);
+        value(e.filter.sides);
+        value(e.filter.owner.get());
+        value(journal::zigzag(e.filter.min_price.get()));
+        value(journal::zigzag(e.filter.max_price.get()));
+    }
+
+    // Rung ids and prices continue the delta chains
+    void encode(const QuoteEvent& e) {
+        tag(e.type);
+        timestamp(e.timestamp);
+        value(e.owner.get());
+        value(e.ladder->bid_count);
+        value(e.ladder->ask_count());
+        for (const QuoteEntry& r : e.ladder->rungs) {
+            id(r.id);
+            price(r.price);
+            value(r.quantity.get());
+        }
+    }
+
+    void encode(const InstrumentEvent& e) {
+        tag(e.type);
+        timestamp(e.timestamp);
+        value(static_cast<uint64_t>(e.instrument.tick_size.get()));
+        value(e.instrument.lot_size.get());
+        value(journal::zigzag(e.instrument.base_price.get()));
+        value(journal::zigzag(e.instrument.min_price.get()));
+        value(journal::zigzag(e.instrument.max_price.get()));
+    }
+
+    void encode(const RejectOrderEvent& e) {
+        tag(e.type);
+        timestamp(e.timestamp);
+        id(e.order_id);
+        value(static_cast<uint64_t>(e.reason));
+    }
+
+    void encode(const LevelTradeEvent& e) {
+        tag(e.type, e.aggressor_side);
+        timestamp(e.timestamp);
+        id(e.aggressive_order_id);
+        price(e.price);
+        value(e.quantity.get());
+        value(e.fill_count);
+    }
+};
+
+// ============================================================================
+// BLOCK DECODER - Payload back to events
+// ============================================================================
+
+class JournalBlockDecoder {
+private:
+    const uint8_t* p_;
+    const uint8_t* end_;
+    uint64_t prev_ts_ = 0;
+    uint64_t prev_id_ = 0;
+    int64_t prev_price_ = 0;
+    bool ok_ = true;
+
+    JournalBlockDecoder(const uint8_t* data, size_t len) : p_(data), end_(data + len) {}
+
+public:
+    // Appends `count` events to `out`. Returns false (having appended only
+    // the events decoded so far) if the payload is truncated or corrupt.
+    static bool decode(const uint8_t* data, size_t len, uint32_t count, std::vector<Event>& out) {
+        JournalBlockDecoder d(data, len);
+        for (uint32_t i = 0; i < count; ++i) {
+            if (!d.next(out)) return false;
+        }
+        return d.p_ == d.end_;  // No trailing bytes
+    }
+
+private:
+    uint64_t value() {
+        uint64_t v = 0;
+        ok_ = journal::get_varint(p_, end_, v) && ok_;
+        return v;
+    }
+
+    Timestamp timestamp() {
+        prev_ts_ += static_cast<uint64_t>(journal::unzigzag(value()));
+        return Timestamp(prev_ts_);
+    }
+
+    OrderId id() {
+        prev_id_ += static_cast<uint64_t>(journal::unzigzag(value()));
+        return OrderId(prev_id_);
+    }
+
+    Price price() {
+        prev_price_ += journal::unzigzag(value());
+        return Price(prev_price_);
+    }
+
+    // Fields are read into locals one statement at a time: argument
+    // evaluation order is unspecified, and must match the encoder's
+    bool next(std::vector<Event>& out) {
+        if (p_ == end_) return false;
+        const uint8_t tag = *p_++;
+        const Side side = (tag & journal::SIDE_BIT) ? Side::SELL : Side::BUY;
+
+        switch (static_cast<EventType>(tag & ~journal::SIDE_BIT)) {
+            case EventType::NEW_ORDER: {
+                Timestamp ts = timestamp();
+                OrderId order_id = id();
+                Price p = price();
+                Quantity qty(value());
+                OwnerId owner(static_cast<uint32_t>(value()));
+                if (!ok_) return false;
+                out.emplace_back(std::in_place_type<NewOrderEvent>, ts, order_id, side, p, qty, owner);
+                return true;
+            }
+            case EventType::CANCEL_ORDER: {
+                Timestamp ts = timestamp();
+                OrderId order_id = id();
+                if (!ok_) return false;
+                out.emplace_back(std::in_place_type<CancelOrderEvent>, ts, order_id);
+                return true;
+            }
+            case EventType::TRADE: {
+                Timestamp ts = timestamp();
+                OrderId passive = id();
+                OrderId aggressive = id();
+                Price p = price();
+                Quantity qty(value());
+                if (!ok_) return false;
+                out.emplace_back(std::in_place_type<TradeEvent>, ts, passive, aggressive, p, qty);
+                return true;
+            }
+            case EventType::MODIFY_ORDER: {
+                Timestamp ts = timestamp();
+                OrderId order_id = id();
+                Price p = price();
+                Quantity qty(value());
+                if (!ok_) return false;
+                out.emplace_back(std::in_place_type<ModifyOrderEvent>, ts, order_id, p, qty);
+                return true;
+            }
+            case EventType::MASS_CANCEL: {
+                Timestamp ts = timestamp();
+                MassCancelFilter filter;
+                filter.sides = static_cast<uint8_t>(value());
+                filter.owner = OwnerId(static_cast<uint32_t>(value()));
+                filter.min_price = Price(journal::unzigzag(value()));
+                filter.max_price = Price(journal::unzigzag(value()));
+                if (!ok_) return false;
+                out.emplace_back(std::in_place_type<MassCancelEvent>, ts, filter);
+                return true;
+            }
+            case EventType::QUOTE: {
+                Timestamp ts = timestamp();
+                OwnerId owner(static_cast<uint32_t>(value()));
+                uint64_t bids = value();
+                uint64_t asks = value();
+                // Every rung takes at least 3 bytes; refuse counts the
+                // payload cannot hold before allocating for them. Each
+                // count is checked on its own so their sum cannot wrap.
+                const uint64_t max_rungs = static_cast<uint64_t>(end_ - p_) / 3;
+                if (!ok_ || bids > UINT32_MAX || asks > UINT32_MAX ||
+                    bids > max_rungs || asks > max_rungs - bids) {
+                    return false;
+                }
+                auto ladder = std::make_shared<QuoteLadder>();
+                ladder->bid_count = static_cast<uint32_t>(bids);
+                ladder->rungs.reserve(static_cast<size_t>(bids + asks));
+                for (uint64_t i = 0; i < bids + asks; ++i) {
+                    OrderId order_id = id();
+                    Price p = price();
+                    Quantity qty(value());
+                    ladder->rungs.push_back({order_id, p, qty});
+                }
+                if (!ok_) return false;
+                out.emplace_back(std::in_place_type<QuoteEvent>, ts, owner, std::move(ladder));
+                return true;
+            }
+            case EventType::LEVEL_TRADE: {
+                Timestamp ts = timestamp();
+                OrderId aggressive = id();
+                Price p = price();
+                Quantity qty(value());
+                uint32_t fills = static_cast<uint32_t>(value());
+                if (!ok_) return false;
+                out.emplace_back(std::in_place_type<LevelTradeEvent>, ts, aggressive, side, p, qty, fills);
+                return true;
+            }
+            case EventType::INSTRUMENT: {
+                Timestamp ts = timestamp();
+                Instrument inst;
+                inst.tick_size = Price(static_cast<int64_t>(value()));
+                inst.lot_size = Quantity(value());
+                inst.base_price = Price(journal::unzigzag(value()));
+                inst.min_price = Price(journal::unzigzag(value()));
+                inst.max_price = Price(journal::unzigzag(value()));
+                if (!ok_) return false;
+                out.emplace_back(std::in_place_type<InstrumentEvent>, ts, inst);
+                return true;
+            }
+            case EventType::REJECT: {
+                Timestamp ts = timestamp();
+                OrderId order_id = id();
+                RejectReason reason = static_cast<RejectReason>(value());
+                if (!ok_) return false;
+                out.emplace_back(std::in_place_type<RejectOrderEvent>, ts, order_id, reason);
+                return true;
+            }
+            default:
+                return false;   // Unknown tag (SNAPSHOT is never journaled)
+        }
+    }
+};
+
+// ============================================================================
+// JOURNAL WRITER - Builds a journal image in memory
+// ============================================================================
+
+class JournalWriter : public EventSink {
+private:
+    std::vector<uint8_t> bytes_;
+    std::vector<JournalBlockInfo> index_;
+    JournalBlockEncoder block_;
+    size_t block_events_;
+    uint64_t events_written_ = 0;
+    bool finished_ = false;
+
+public:
+    explicit JournalWriter(size_t block_events = JOURNAL_DEFAULT_BLOCK_EVENTS)
+        : block_events_(block_events ? block_events : 1) {
+        bytes_.resize(JOURNAL_FILE_HEADER_SIZE);
+        journal::put_u32(bytes_.data(), JOURNAL_MAGIC);
+        journal::put_u16(bytes_.data() + 4, JOURNAL_VERSION);
+        journal::put_u16(bytes_.data() + 6, 0);
+    }
+
+    void append(const Event& event) {
+        block_.add(event);
+        if (block_.event_count() >= block_events_) flush_block();
+    }
+
+    void append(const std::vector<Event>& log) {
+        for (const auto& event : log) append(event);
+    }
+
+    // EventSink: keeps the events in memory, for tests and small tools
+    void on_event(const Event& event) override { append(event); }
+
+    // Seals the last block and appends the index and footer. Idempotent.
+    const std::vector<uint8_t>& finish() {
+        if (finished_) return bytes_;
+        flush_block();
+
+        const uint64_t index_offset = bytes_.size();
+        for (const auto& info : index_) {
+            uint8_t* p = grow(JOURNAL_INDEX_ENTRY_SIZE);
+            journal::put_u64(p, info.offset);
+            journal::put_u64(p + 8, info.first_event);
+            journal::put_u64(p + 16, info.first_timestamp.get());
+            journal::put_u32(p + 24, info.event_count);
+            journal::put_u32(p + 28, info.payload_bytes);
+        }
+        uint8_t* p = grow(JOURNAL_FOOTER_SIZE);
+        journal::put_u64(p, index_offset);
+        journal::put_u32(p + 8, static_cast<uint32_t>(index_.size()));
+        journal::put_u32(p + 12, JOURNAL_INDEX_MAGIC);
+        finished_ = true;
+        return bytes_;
+    }
+
+    const std::vector<uint8_t>& bytes() const { return bytes_; }
+    const std::vector<JournalBlockInfo>& index() const { return index_; }
+    uint64_t events_written() const { return events_written_ + block_.event_count(); }
+
+    void save(const std::string& filename) {
+        finish();
+        std::ofstream file(filename, std::ios::binary);
+        if (!file) {
+            throw std::runtime_error("Cannot open file: " + filename);
+        }
+        file.write(reinterpret_cast<const char*>(bytes_.data()),
+                   static_cast<std::streamsize>(bytes_.size()));
+    }
+
+private:
+    uint8_t* grow(size_t n) {
+        size_t at = bytes_.size();
+        bytes_.resize(at + n);
+        return bytes_.data() + at;
+    }
+
+    void flush_block() {
+        if (block_.event_count() == 0) return;
+        const auto& payload = block_.payload();
+
+        JournalBlockInfo info{bytes_.size(), events_written_, block_.first_timestamp(),
+                              block_.event_count(), static_cast<uint32_t>(payload.size())};
+        uint8_t* p = grow(JOURNAL_BLOCK_HEADER_SIZE);
+        journal::put_u32(p, info.payload_bytes);
+        journal::put_u32(p + 4, info.event_count);
+        journal::put_u64(p + 8, info.first_timestamp.get());
+        bytes_.insert(bytes_.end(), payload.begin(), payload.end());
+
+        index_.push_back(info);
+        events_written_ += block_.event_count();
+        block_.reset();
+    }
+};
+
+// ============================================================================
+// JOURNAL READER - Index-driven random access over a journal image
+// ============================================================================
+
+class JournalReader {
+private:
+    std::vector<uint8_t> bytes_;
+    std::vector<JournalBlockInfo> index_;
+
+public:
+    // Throws std::runtime_error if the header, footer or index is invalid
+    explicit JournalReader(std::vector<uint8_t> bytes) : bytes_(std::move(bytes)) {
+        if (bytes_.size() < JOURNAL_FILE_HEADER_SIZE + JOURNAL_FOOTER_SIZE ||
+            journal::get_u32(bytes_.data()) != JOURNAL_MAGIC ||
+            journal::get_u16(bytes_.data() + 4) != JOURNAL_VERSION) {
+            throw std::runtime_error("Not a journal");
+        }
+
+        const uint8_t* footer = bytes_.data() + bytes_.size() - JOURNAL_FOOTER_SIZE;
+        const uint64_t index_offset = journal::get_u64(footer);
+        const uint32_t block_count = journal::get_u32(footer + 8);
+        if (journal::get_u32(footer + 12) != JOURNAL_INDEX_MAGIC ||
+            index_offset + uint64_t(block_count) * JOURNAL_INDEX_ENTRY_SIZE !=
+                bytes_.size() - JOURNAL_FOOTER_SIZE) {
+            throw std::runtime_error("Journal index missing or corrupt");
+        }
+
+        index_.reserve(block_count);
+        for (uint32_t i = 0; i < block_count; ++i) {
+            const uint8_t* p = bytes_.data() + index_offset + i * JOURNAL_INDEX_ENTRY_SIZE;
+            JournalBlockInfo info{journal::get_u64(p), journal::get_u64(p + 8),
+                                  Timestamp(journal::get_u64(p + 16)),
+                                  journal::get_u32(p + 24), journal::get_u32(p + 28)};
+            if (info.offset + JOURNAL_BLOCK_HEADER_SIZE + info.payload_bytes > index_offset) {
+                throw std::runtime_error("Journal index entry out of range");
+            }
+            index_.push_back(info);
+        }
+    }
+
+    static JournalReader open(const std::string& filename) {
+        std::ifstream file(filename, std::ios::binary);
+        if (!file) {
+            throw std::runtime_error("Cannot open file: " + filename);
+        }
+        std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(file)),
+                                   std::istreambuf_iterator<char>());
+        return JournalReader(std::move(bytes));
+    }
+
+    size_t block_count() const { return index_.size(); }
+    const JournalBlockInfo& block(size_t i) const { return index_[i]; }
+    size_t size_bytes() const { return bytes_.size(); }
+
+    uint64_t event_count() const {
+        if (index_.empty()) return 0;
+        return index_.back().first_event + index_.back().event_count;
+    }
+
+    // Block to start scanning from for the first event at or after ts: the
+    // last block whose first timestamp is < ts, or 0. Timestamps never
+    // decrease but can repeat: a RejectOrderEvent reuses the current one,
+    // that of the event logged just before it. A repeated timestamp can
+    // span blocks, hence strictly less.
+    size_t find_block(Timestamp ts) const {
+        auto it = std::lower_bound(index_.begin(), index_.end(), ts,
+            [](const JournalBlockInfo& info, Timestamp t) { return info.first_timestamp < t; });
+        return it == index_.begin() ? 0 : static_cast<size_t>(it - index_.begin()) - 1;
+    }
+
+    // Appends the block's events to `out`; false if it fails to decode
+    bool read_block(size_t i, std::vector<Event>& out) const {
+        const JournalBlockInfo& info = index_[i];
+        const uint8_t* header = bytes_.data() + info.offset;
+        if (journal::get_u32(header) != info.payload_bytes ||
+            journal::get_u32(header + 4) != info.event_count) {
+            return false;
+        }
+        return JournalBlockDecoder::decode(header + JOURNAL_BLOCK_HEADER_SIZE,
+                                           info.payload_bytes, info.event_count, out);
+    }
+
+    bool read_all(std::vector<Event>& out) const {
+        out.reserve(out.size() + event_count());
+        for (size_t i = 0; i < index_.size(); ++i) {
+            if (!read_block(i, out)) return false;
+        }
+        return true;
+    }
+};
+
+#endif
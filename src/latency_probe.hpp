@@ -0,0 +1,353 @@
+#ifndef LATENCY_PROBE_HPP
+#define LATENCY_PROBE_HPP
+
+#include <atomic>
+#include <array>
+#include <vector>
+#include <mutex>
+#include <chrono>
+#include <thread>
+#include <ostream>
+#include <iomanip>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// ============================================================================
+// LATENCY PROBES - Stage-level cycle counts from the TSC
+// ============================================================================
+//
+// Build with -DMATCHING_ENGINE_PROBES=1 (CMake: -DENABLE_LATENCY_PROBES=ON)
+// to compile probe points into the engine. Otherwise every ME_PROBE_* macro
+// expands to an empty statement and nothing below is referenced from the
+// hot path. The setting must be the same for every translation unit.
+//
+// Each thread records into its own histograms, so probes never contend.
+// Counters are relaxed atomics with a single writer: another thread may
+// read them live (snapshot()) without tearing, at no cost to the writer.
+
+#ifndef MATCHING_ENGINE_PROBES
+#define MATCHING_ENGINE_PROBES 0
+#endif
+
+// ============================================================================
+// TSC CLOCK
+// ============================================================================
+
+struct TscClock {
+    // Plain read; may be reordered with surrounding loads. Falls back to
+    // steady_clock nanoseconds off x86.
+    static uint64_t now() {
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#else
+        return static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+    }
+
+    // Waits for earlier instructions to retire before reading; use to close
+    // an interval
+    static uint64_t now_serialized() {
+#if defined(__x86_64__) || defined(__i386__)
+        unsigned int aux;
+        return __rdtscp(&aux);
+#else
+        return now();
+#endif
+    }
+
+    // Ticks per nanosecond, measured once against steady_clock over ~10 ms.
+    // Assumes an invariant TSC (constant rate across cores and P-states).
+    static double ticks_per_ns() {
+        static const double rate = calibrate(std::chrono::milliseconds(10));
+        return rate;
+    }
+
+    static double to_ns(uint64_t ticks) {
+        return static_cast<double>(ticks) / ticks_per_ns();
+    }
+
+    static double calibrate(std::chrono::milliseconds window) {
+        auto wall_start = std::chrono::steady_clock::now();
+        uint64_t tsc_start = now_serialized();
+        std::this_thread::sleep_for(window);
+        uint64_t tsc_end = now_serialized();
+        auto wall_end = std::chrono::steady_clock::now();
+        double ns = std::chrono::duration<double, std::nano>(wall_end - wall_start).count();
+        return ns > 0 ? static_cast<double>(tsc_end - tsc_start) / ns : 1.0;
+    }
+};
+
+// ============================================================================
+// PROBE HISTOGRAM - Power-of-two buckets
+// ============================================================================
+// Bucket b holds values in [2^(b-1), 2^b), bucket 0 holds 0. Coarse, but
+// recording is one count-leading-zeros and a handful of relaxed stores.
+
+class ProbeHistogram {
+public:
+    static constexpr size_t BUCKETS = 65;
+
+    struct Snapshot {
+        std::array<uint64_t, BUCKETS> buckets{};
+        uint64_t count = 0;
+        uint64_t sum = 0;
+        uint64_t max = 0;
+
+        double mean() const { return count ? static_cast<double>(sum) / count : 0.0; }
+
+        // Upper bound of the bucket holding the p-th percentile (0 < p <= 100)
+        uint64_t percentile(double p) const {
+            if (count == 0) return 0;
+            uint64_t rank = static_cast<uint64_t>(p / 100.0 * count);
+            if (rank == 0) rank = 1;
+            uint64_t seen = 0;
+            for (size_t b = 0; b < BUCKETS; ++b) {
+                seen += buckets[b];
+                if (seen >= rank) return b == 0 ? 0 : std::min(max, (b >= 64 ? ~uint64_t(0) : (uint64_t(1) << b) - 1));
+            }
+            return max;
+        }
+
+        void merge(const Snapshot& other) {
+            for (size_t b = 0; b < BUCKETS; ++b) buckets[b] += other.buckets[b];
+            count += other.count;
+            sum += other.sum;
+            max = std::max(max, other.max);
+        }
+    };
+
+    void record(uint64_t value) {
+        size_t b = value == 0 ? 0 : 64 - static_cast<size_t>(__builtin_clzll(value));
+        bump(buckets_[b], 1);
+        bump(count_, 1);
+        bump(sum_, value);
+        if (value > max_.load(std::memory_order_relaxed)) {
+            max_.store(value, std::memory_order_relaxed);
+        }
+    }
+
+    Snapshot snapshot() const {
+        Snapshot s;
+        for (size_t b = 0; b < BUCKETS; ++b) s.buckets[b] = buckets_[b].load(std::memory_order_relaxed);
+        s.count = count_.load(std::memory_order_relaxed);
+        s.sum = sum_.load(std::memory_order_relaxed);
+        s.max = max_.load(std::memory_order_relaxed);
+        return s;
+    }
+
+    void reset() {
+        for (auto& b : buckets_) b.store(0, std::memory_order_relaxed);
+        count_.store(0, std::memory_order_relaxed);
+        sum_.store(0, std::memory_order_relaxed);
+        max_.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    // Single writer: a plain load/store pair, no locked read-modify-write
+    static void bump(std::atomic<uint64_t>& counter, uint64_t by) {
+        counter.store(counter.load(std::memory_order_relaxed) + by, std::memory_order_relaxed);
+    }
+
+    std::array<std::atomic<uint64_t>, BUCKETS> buckets_{};
+    std::atomic<uint64_t> count_{0};
+    std::atomic<uint64_t> sum_{0};
+    std::atomic<uint64_t> max_{0};
+};
+
+// ============================================================================
+// PER-THREAD PROBES
+// ============================================================================
+
+enum class ProbeStage : uint8_t {
+    NEW_ORDER = 0,      // Whole process_new_order call
+    LOG = 1,            // Appending the input event
+    VALIDATE = 2,       // Reference data checks
+    MATCH = 3,          // Walking and consuming the opposite side
+    REST = 4,           // Pool slot, index insert and add_to_book
+    CANCEL = 5,         // Whole process_cancel call
+    MODIFY = 6,         // Whole process_modify call
+    QUOTE = 7,          // Whole process_quote call
+    COUNT = 8
+};
+
+inline const char* to_string(ProbeStage stage) {
+    static const char* const names[] = {
+        "new_order", "log", "validate", "match", "rest", "cancel", "modify", "quote"
+    };
+    return stage < ProbeStage::COUNT ? names[static_cast<size_t>(stage)] : "unknown";
+}
+
+class LatencyProbes {
+public:
+    static constexpr size_t STAGES = static_cast<size_t>(ProbeStage::COUNT);
+
+    struct Snapshot {
+        std::thread::id thread;
+        std::array<ProbeHistogram::Snapshot, STAGES> cycles;
+        ProbeHistogram::Snapshot levels_swept;   // Per new order
+        ProbeHistogram::Snapshot orders_swept;   // Per new order
+
+        void merge(const Snapshot& other) {
+            for (size_t i = 0; i < STAGES; ++i) cycles[i].merge(other.cycles[i]);
+            levels_swept.merge(other.levels_swept);
+            orders_swept.merge(other.orders_swept);
+        }
+    };
+
+    LatencyProbes() : thread_(std::this_thread::get_id()) { registry().add(this); }
+    ~LatencyProbes() { registry().remove(this); }
+    LatencyProbes(const LatencyProbes&) = delete;
+    LatencyProbes& operator=(const LatencyProbes&) = delete;
+
+    // The calling thread's probes, created on first use
+    static LatencyProbes& local() {
+        thread_local LatencyProbes probes;
+        return probes;
+    }
+
+    void record(ProbeStage stage, uint64_t cycles) {
+        cycles_[static_cast<size_t>(stage)].record(cycles);
+    }
+
+    // Sweep depth of the current aggressive order
+    void begin_sweep() { sweep_levels_ = sweep_orders_ = 0; }
+    void level_touched() { ++sweep_levels_; }
+    void order_touched() { ++sweep_orders_; }
+    void end_sweep() {
+        levels_swept_.record(sweep_levels_);
+        orders_swept_.record(sweep_orders_);
+    }
+
+    Snapshot snapshot() const {
+        Snapshot s;
+        s.thread = thread_;
+        for (size_t i = 0; i < STAGES; ++i) s.cycles[i] = cycles_[i].snapshot();
+        s.levels_swept = levels_swept_.snapshot();
+        s.orders_swept = orders_swept_.snapshot();
+        return s;
+    }
+
+    void reset() {
+        for (auto& h : cycles_) h.reset();
+        levels_swept_.reset();
+        orders_swept_.reset();
+    }
+
+    // Live view of every thread that has recorded, in registration order
+    static std::vector<Snapshot> snapshot_all() {
+        std::vector<Snapshot> out;
+        registry().for_each([&out](const LatencyProbes& p) { out.push_back(p.snapshot()); });
+        return out;
+    }
+
+    static void reset_all() {
+        registry().for_each([](const LatencyProbes& p) { const_cast<LatencyProbes&>(p).reset(); });
+    }
+
+    // Per-stage table of every thread merged; cycles converted with the
+    // calibrated TSC rate
+    static void dump(std::ostream& out) {
+        auto threads = snapshot_all();
+        if (threads.empty()) {
+            out << "   (no probe data)\n";
+            return;
+        }
+        Snapshot total = threads.front();
+        for (size_t i = 1; i < threads.size(); ++i) total.merge(threads[i]);
+
+        out << "   " << std::left << std::setw(10) << "stage" << std::right
+            << std::setw(10) << "count" << std::setw(12) << "mean ns"
+            << std::setw(12) << "p50 ns" << std::setw(12) << "p99 ns"
+            << std::setw(12) << "max ns" << "\n";
+        for (size_t i = 0; i < STAGES; ++i) {
+            const auto& h = total.cycles[i];
+            if (h.count == 0) continue;
+            out << "   " << std::left << std::setw(10) << to_string(static_cast<ProbeStage>(i))
+                << std::right << std::setw(10) << h.count << std::fixed << std::setprecision(1)
+                << std::setw(12) << TscClock::to_ns(static_cast<uint64_t>(h.mean()))
+                << std::setw(12) << TscClock::to_ns(h.percentile(50))
+                << std::setw(12) << TscClock::to_ns(h.percentile(99))
+                << std::setw(12) << TscClock::to_ns(h.max) << "\n";
+        }
+        out << "   sweep depth: mean " << std::setprecision(2) << total.levels_swept.mean()
+            << " levels / " << total.orders_swept.mean() << " orders, max "
+            << total.levels_swept.max << " / " << total.orders_swept.max
+            << " (" << threads.size() << " thread" << (threads.size() == 1 ? "" : "s") << ")\n";
+        out << std::defaultfloat;
+    }
+
+private:
+    class Registry {
+    public:
+        void add(const LatencyProbes* p) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            probes_.push_back(p);
+        }
+        void remove(const LatencyProbes* p) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            probes_.erase(std::remove(probes_.begin(), probes_.end(), p), probes_.end());
+        }
+        template<typename F>
+        void for_each(F&& fn) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (const LatencyProbes* p : probes_) fn(*p);
+        }
+    private:
+        std::mutex mutex_;
+        std::vector<const LatencyProbes*> probes_;
+    };
+
+    static Registry& registry() {
+        static Registry r;
+        return r;
+    }
+
+    std::thread::id thread_;
+    std::array<ProbeHistogram, STAGES> cycles_;
+    ProbeHistogram levels_swept_;
+    ProbeHistogram orders_swept_;
+    uint64_t sweep_levels_ = 0;
+    uint64_t sweep_orders_ = 0;
+};
+
+// Records the cycles from construction to destruction against one stage
+class ProbeScope {
+public:
+    explicit ProbeScope(ProbeStage stage) : stage_(stage), start_(TscClock::now()) {}
+    ~ProbeScope() { LatencyProbes::local().record(stage_, TscClock::now_serialized() - start_); }
+    ProbeScope(const ProbeScope&) = delete;
+    ProbeScope& operator=(const ProbeScope&) = delete;
+
+private:
+    ProbeStage stage_;
+    uint64_t start_;
+};
+
+// ============================================================================
+// PROBE POINTS
+// ============================================================================
+
+#define ME_PROBE_CONCAT_(a, b) a##b
+#define ME_PROBE_CONCAT(a, b) ME_PROBE_CONCAT_(a, b)
+
+#if MATCHING_ENGINE_PROBES
+#define ME_PROBE_SCOPE(stage) \
+    ProbeScope ME_PROBE_CONCAT(me_probe_scope_, __LINE__)(ProbeStage::stage)
+#define ME_PROBE_SWEEP_BEGIN() LatencyProbes::local().begin_sweep()
+#define ME_PROBE_SWEEP_END() LatencyProbes::local().end_sweep()
+#define ME_PROBE_LEVEL_TOUCHED() LatencyProbes::local().level_touched()
+#define ME_PROBE_ORDER_TOUCHED() LatencyProbes::local().order_touched()
+#else
+#define ME_PROBE_SCOPE(stage) do {} while (0)
+#define ME_PROBE_SWEEP_BEGIN() do {} while (0)
+#define ME_PROBE_SWEEP_END() do {} while (0)
+#define ME_PROBE_LEVEL_TOUCHED() do {} while (0)
+#define ME_PROBE_ORDER_TOUCHED() do {} while (0)
+#endif
+
+#endif
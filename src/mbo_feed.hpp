@@ -0,0 +1,429 @@
+#ifndef MBO_FEED_HPP
+#define MBO_FEED_HPP
+
+#include "types.hpp"
+#include "order.hpp"
+#include "depth.hpp"
+#include <array>
+#include <vector>
+#include <list>
+#include <map>
+#include <unordered_map>
+#include <cstring>
+#include <cstddef>
+#include <algorithm>
+#include <iterator>
+
+// ============================================================================
+// MARKET-BY-ORDER FEED - ITCH-style binary L3 messages
+// ============================================================================
+//
+// Packets follow the MoldUDP64 layout: a 20-byte header (10-byte session,
+// 8-byte sequence of the first message, 2-byte message count) followed by
+// message blocks, each prefixed with a 2-byte length. All integers are
+// big-endian, as on the wire.
+//
+//   'A' Add Order     type ts ref side shares price   34 bytes
+//   'E' Executed      type ts ref shares match        33 bytes
+//   'X' Cancel        type ts ref cancelled_shares    25 bytes
+//   'D' Delete        type ts ref                     17 bytes
+//
+// A full execution removes the order implicitly; no Delete follows it.
+// A message the encoder has no buffer for still takes its sequence number,
+// so the packets after it show subscribers a gap to resync from.
+
+constexpr size_t MBO_PACKET_SIZE = 1400;       // Fits a standard Ethernet MTU
+constexpr size_t MBO_HEADER_SIZE = 20;
+constexpr size_t MBO_SESSION_SIZE = 10;
+
+constexpr size_t MBO_ADD_SIZE = 34;
+constexpr size_t MBO_EXECUTE_SIZE = 33;
+constexpr size_t MBO_CANCEL_SIZE = 25;
+constexpr size_t MBO_DELETE_SIZE = 17;
+
+namespace mbo {
+
+inline void put_u16(uint8_t* p, uint16_t v) {
+    p[0] = static_cast<uint8_t>(v >> 8);
+    p[1] = static_cast<uint8_t>(v);
+}
+
+inline void put_u64(uint8_t* p, uint64_t v) {
+    for (int i = 7; i >= 0; --i) {
+        p[i] = static_cast<uint8_t>(v);
+        v >>= 8;
+    }
+}
+
+inline uint16_t get_u16(const uint8_t* p) {
+    return static_cast<uint16_t>((p[0] << 8) | p[1]);
+}
+
+inline uint64_t get_u64(const uint8_t* p) {
+    uint64_t v = 0;
+    for (int i = 0; i < 8; ++i) v = (v << 8) | p[i];
+    return v;
+}
+
+} // namespace mbo
+
+// ============================================================================
+// DECODED MESSAGES
+// ============================================================================
+
+struct MboAdd {
+    Timestamp timestamp;
+    OrderId order_id;
+    Side side;
+    Quantity quantity;
+    Price price;
+};
+
+struct MboExecute {
+    Timestamp timestamp;
+    OrderId order_id;
+    Quantity quantity;
+    uint64_t match_number;
+};
+
+struct MboCancel {
+    Timestamp timestamp;
+    OrderId order_id;
+    Quantity cancelled;
+};
+
+struct MboDelete {
+    Timestamp timestamp;
+    OrderId order_id;
+};
+
+// ============================================================================
+// PACKET BUFFER - Preallocated, reused across encoder resets
+// ============================================================================
+
+struct MboPacket {
+    uint64_t sequence;       // Sequence number of the first message
+    uint16_t count;          // Messages in this packet
+    size_t length;           // Bytes used in data, header included
+    std::array<uint8_t, MBO_PACKET_SIZE> data;
+};
+
+// ============================================================================
+// ENCODER - Called from OrderBook as resting orders change
+// ============================================================================
+
+class MboFeedEncoder {
+private:
+    std::vector<MboPacket> packets_;
+    size_t current_;             // Packet being filled
+    uint64_t next_sequence_;     // Sequence number of the next message
+    uint64_t messages_;
+    uint64_t dropped_;
+    char session_[MBO_SESSION_SIZE];
+
+public:
+    // All packet buffers are allocated here; encoding never allocates.
+    explicit MboFeedEncoder(size_t max_packets, const char* session = "MBOFEED")
+        : packets_(max_packets), current_(0), next_sequence_(1),
+          messages_(0), dropped_(0) {
+        std::memset(session_, ' ', sizeof(session_));
+        std::memcpy(session_, session, std::min(std::strlen(session), sizeof(session_)));
+        if (!packets_.empty()) open_packet(packets_[0]);
+    }
+
+    // ------------------------------------------------------------------------
+    // Book activity hooks
+    // ------------------------------------------------------------------------
+    bool on_add(Timestamp ts, const Order& order) {
+        uint8_t* p = reserve(MBO_ADD_SIZE);
+        if (!p) return false;
+        p[0] = 'A';
+        mbo::put_u64(p + 1, ts.get());
+        mbo::put_u64(p + 9, order.id.get());
+        p[17] = order.side == Side::BUY ? 'B' : 'S';
+        mbo::put_u64(p + 18, order.remaining_qty.get());
+        mbo::put_u64(p + 26, static_cast<uint64_t>(order.price.get()));
+        return true;
+    }
+
+    bool on_execute(Timestamp ts, const Order& passive, Quantity qty, uint64_t match_number) {
+        uint8_t* p = reserve(MBO_EXECUTE_SIZE);
+        if (!p) return false;
+        p[0] = 'E';
+        mbo::put_u64(p + 1, ts.get());
+        mbo::put_u64(p + 9, passive.id.get());
+        mbo::put_u64(p + 17, qty.get());
+        mbo::put_u64(p + 25, match_number);
+        return true;
+    }
+
+    bool on_cancel(Timestamp ts, const Order& order, Quantity cancelled) {
+        uint8_t* p = reserve(MBO_CANCEL_SIZE);
+        if (!p) return false;
+        p[0] = 'X';
+        mbo::put_u64(p + 1, ts.get());
+        mbo::put_u64(p + 9, order.id.get());
+        mbo::put_u64(p + 17, cancelled.get());
+        return true;
+    }
+
+    bool on_delete(Timestamp ts, const Order& order) {
+        uint8_t* p = reserve(MBO_DELETE_SIZE);
+        if (!p) return false;
+        p[0] = 'D';
+        mbo::put_u64(p + 1, ts.get());
+        mbo::put_u64(p + 9, order.id.get());
+        return true;
+    }
+
+    // ------------------------------------------------------------------------
+    // Packet access
+    // ------------------------------------------------------------------------
+    // Closes the partially filled packet so it is included in packet_count().
+    void flush() {
+        if (current_ < packets_.size() && packets_[current_].count > 0) {
+            close_packet(packets_[current_]);
+            if (++current_ < packets_.size()) open_packet(packets_[current_]);
+        }
+    }
+
+    size_t packet_count() const { return current_; }
+
+    const MboPacket& packet(size_t i) const { return packets_[i]; }
+
+    // Makes all buffers available again. Sequence numbers keep increasing.
+    void reset() {
+        current_ = 0;
+        if (!packets_.empty()) open_packet(packets_[0]);
+    }
+
+    uint64_t messages_encoded() const { return messages_; }
+    uint64_t messages_dropped() const { return dropped_; }
+
+private:
+    void open_packet(MboPacket& pkt) {
+        pkt.sequence = next_sequence_;
+        pkt.count = 0;
+        pkt.length = MBO_HEADER_SIZE;
+    }
+
+    void close_packet(MboPacket& pkt) {
+        std::memcpy(pkt.data.data(), session_, MBO_SESSION_SIZE);
+        mbo::put_u64(pkt.data.data() + 10, pkt.sequence);
+        mbo::put_u16(pkt.data.data() + 18, pkt.count);
+    }
+
+    // Returns space for one message body, rolling to the next packet when
+    // the current one is full. Returns nullptr when all buffers are used;
+    // the dropped message still consumes a sequence number.
+    uint8_t* reserve(size_t size) {
+        if (current_ < packets_.size() &&
+            packets_[current_].length + 2 + size > MBO_PACKET_SIZE) {
+            flush();
+        }
+        if (current_ >= packets_.size()) {
+            ++dropped_;
+            ++next_sequence_;
+            return nullptr;
+        }
+
+        MboPacket& pkt = packets_[current_];
+        uint8_t* p = pkt.data.data() + pkt.length;
+        mbo::put_u16(p, static_cast<uint16_t>(size));
+        pkt.length += 2 + size;
+        ++pkt.count;
+        ++next_sequence_;
+        ++messages_;
+        return p + 2;
+    }
+};
+
+// ============================================================================
+// DECODER - Validates framing and sequencing, dispatches to a handler
+// ============================================================================
+
+class MboFeedDecoder {
+private:
+    uint64_t expected_sequence_ = 1;
+    uint64_t gaps_ = 0;
+
+public:
+    // Handler must provide on_add/on_execute/on_cancel/on_delete taking the
+    // decoded message structs. Returns false on malformed or out-of-sequence
+    // packets; nothing from such a packet is applied.
+    template<typename Handler>
+    bool decode_packet(const uint8_t* data, size_t length, Handler& handler) {
+        if (length < MBO_HEADER_SIZE) return false;
+
+        uint64_t sequence = mbo::get_u64(data + 10);
+        uint16_t count = mbo::get_u16(data + 18);
+        if (sequence != expected_sequence_) {
+            ++gaps_;
+            return false;
+        }
+
+        // Validate all framing before applying anything
+        size_t offset = MBO_HEADER_SIZE;
+        for (uint16_t i = 0; i < count; ++i) {
+            if (offset + 2 > length) return false;
+            size_t size = mbo::get_u16(data + offset);
+            if (size == 0 || offset + 2 + size > length) return false;
+            if (size != message_size(data[offset + 2])) return false;
+            offset += 2 + size;
+        }
+
+        offset = MBO_HEADER_SIZE;
+        for (uint16_t i = 0; i < count; ++i) {
+            size_t size = mbo::get_u16(data + offset);
+            dispatch(data + offset + 2, handler);
+            offset += 2 + size;
+        }
+
+        expected_sequence_ += count;
+        return true;
+    }
+
+    template<typename Handler>
+    bool decode_packet(const MboPacket& pkt, Handler& handler) {
+        return decode_packet(pkt.data.data(), pkt.length, handler);
+    }
+
+    uint64_t expected_sequence() const { return expected_sequence_; }
+    uint64_t gaps() const { return gaps_; }
+
+    // After a gap: continue from `sequence` once the handler's state has
+    // been rebuilt (e.g. from a book snapshot) as of the message before it
+    void resync(uint64_t sequence) { expected_sequence_ = sequence; }
+
+private:
+    static size_t message_size(uint8_t type) {
+        switch (type) {
+            case 'A': return MBO_ADD_SIZE;
+            case 'E': return MBO_EXECUTE_SIZE;
+            case 'X': return MBO_CANCEL_SIZE;
+            case 'D': return MBO_DELETE_SIZE;
+            default:  return 0;
+        }
+    }
+
+    template<typename Handler>
+    static void dispatch(const uint8_t* p, Handler& handler) {
+        Timestamp ts(mbo::get_u64(p + 1));
+        OrderId id(mbo::get_u64(p + 9));
+
+        switch (p[0]) {
+            case 'A':
+                handler.on_add(MboAdd{ts, id, p[17] == 'B' ? Side::BUY : Side::SELL,
+                                      Quantity(mbo::get_u64(p + 18)),
+                                      Price(static_cast<int64_t>(mbo::get_u64(p + 26)))});
+                break;
+            case 'E':
+                handler.on_execute(MboExecute{ts, id, Quantity(mbo::get_u64(p + 17)),
+                                              mbo::get_u64(p + 25)});
+                break;
+            case 'X':
+                handler.on_cancel(MboCancel{ts, id, Quantity(mbo::get_u64(p + 17))});
+                break;
+            case 'D':
+                handler.on_delete(MboDelete{ts, id});
+                break;
+        }
+    }
+};
+
+// ============================================================================
+// BOOK BUILDER - Rebuilds an L3 book from decoded messages
+// ============================================================================
+
+class MboBookBuilder {
+private:
+    using Queue = std::list<uint64_t>;
+
+    struct Entry {
+        Side side;
+        int64_t price;
+        uint64_t quantity;
+        Queue::iterator position;
+    };
+
+    struct Level {
+        Queue orders;
+        uint64_t total_volume = 0;
+    };
+
+    std::map<int64_t, Level, std::greater<int64_t>> bids_;
+    std::map<int64_t, Level, std::less<int64_t>> asks_;
+    std::unordered_map<uint64_t, Entry> orders_;
+
+public:
+    void on_add(const MboAdd& m) {
+        Level& level = m.side == Side::BUY ? bids_[m.price.get()] : asks_[m.price.get()];
+        level.orders.push_back(m.order_id.get());
+        level.total_volume += m.quantity.get();
+        orders_[m.order_id.get()] = Entry{m.side, m.price.get(), m.quantity.get(),
+                                          std::prev(level.orders.end())};
+    }
+
+    void on_execute(const MboExecute& m) { reduce(m.order_id.get(), m.quantity.get()); }
+
+    void on_cancel(const MboCancel& m) { reduce(m.order_id.get(), m.cancelled.get()); }
+
+    void on_delete(const MboDelete& m) {
+        auto it = orders_.find(m.order_id.get());
+        if (it != orders_.end()) reduce(m.order_id.get(), it->second.quantity);
+    }
+
+    size_t order_count() const { return orders_.size(); }
+
+    // All levels on one side, best first
+    std::vector<DepthLevel> get_depth(Side side) const {
+        std::vector<DepthLevel> out;
+        auto collect = [&out](const auto& levels) {
+            for (const auto& [price, level] : levels) {
+                out.push_back({Price(price), Quantity(level.total_volume), level.orders.size()});
+            }
+        };
+        if (side == Side::BUY) collect(bids_);
+        else collect(asks_);
+        return out;
+    }
+
+    // Visits resting orders best level first, FIFO within a level:
+    // fn(OrderId, Price, Quantity)
+    template<typename F>
+    void for_each_order(Side side, F&& fn) const {
+        auto visit = [this, &fn](const auto& levels) {
+            for (const auto& [price, level] : levels) {
+                for (uint64_t id : level.orders) {
+                    fn(OrderId(id), Price(price), Quantity(orders_.at(id).quantity));
+                }
+            }
+        };
+        if (side == Side::BUY) visit(bids_);
+        else visit(asks_);
+    }
+
+private:
+    void reduce(uint64_t id, uint64_t qty) {
+        auto it = orders_.find(id);
+        if (it == orders_.end()) return;
+        Entry& entry = it->second;
+        qty = std::min(qty, entry.quantity);
+
+        auto shrink = [&](auto& levels) {
+            auto lit = levels.find(entry.price);
+            Level& level = lit->second;
+            level.total_volume -= qty;
+            entry.quantity -= qty;
+            if (entry.quantity == 0) {
+                level.orders.erase(entry.position);
+                if (level.orders.empty()) levels.erase(lit);
+                orders_.erase(it);
+            }
+        };
+        if (entry.side == Side::BUY) shrink(bids_);
+        else shrink(asks_);
+    }
+};
+
+#endif
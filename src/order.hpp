@@ -13,6 +13,7 @@ struct Order {
     OrderId id;
     Timestamp timestamp;
     Side side;
+    OwnerId owner;          // Packed into the padding after side
     Price price;
     Quantity original_qty;
     Quantity remaining_qty;
@@ -21,8 +22,9 @@ struct Order {
     Order* next;
     Order* prev;
     
-    Order(OrderId id_, Timestamp ts, Side s, Price p, Quantity q)
-        : id(id_), timestamp(ts), side(s), price(p), 
+    Order(OrderId id_, Timestamp ts, Side s, Price p, Quantity q,
+          OwnerId owner_ = OwnerId(0))
+        : id(id_), timestamp(ts), side(s), owner(owner_), price(p), 
           original_qty(q), remaining_qty(q), next(nullptr), prev(nullptr) {}
     
     bool is_filled() const { 
@@ -34,6 +36,8 @@ struct Order {
     }
 } __attribute__((aligned(64)));
 
+static_assert(sizeof(Order) == 64, "Order must fit exactly one cache line");
+
 // ============================================================================
 // OBJECT POOL - Pre-allocated memory pool for orders
 // ============================================================================
@@ -72,11 +76,31 @@ public:
             free_list_.push_back(obj);
         }
     }
+
+    // Returns a whole intrusive list (linked through `next`) in one pass
+    void deallocate_list(T* head) {
+        for (T* obj = head; obj; obj = obj->next) {
+            free_list_.push_back(obj);
+        }
+    }
     
     size_t available() const {
         return free_list_.size();
     }
 
+    size_t capacity() const {
+        return capacity_;
+    }
+
+    // Marks every object free in one sequential pass, without touching the
+    // objects themselves. Only valid when none of them is in use.
+    void release_all() {
+        free_list_.clear();
+        for (size_t i = 0; i < capacity_; ++i) {
+            free_list_.push_back(&pool_[i]);
+        }
+    }
+
 };
 
 // ============================================================================
@@ -85,14 +109,16 @@ public:
 
 struct LimitLevel {
     Price price;
+    int32_t tick;           // Position in the price band for cumulative depth
+                            // (0 without bands); price stays authoritative
+    uint32_t order_count;
     Order* head;
     Order* tail;
     Quantity total_volume;
-    size_t order_count;
     
-    explicit LimitLevel(Price p) 
-        : price(p), head(nullptr), tail(nullptr), 
-          total_volume(Quantity(0)), order_count(0) {}
+    explicit LimitLevel(Price p, int32_t tick_ = 0) 
+        : price(p), tick(tick_), order_count(0), head(nullptr), tail(nullptr), 
+          total_volume(Quantity(0)) {}
     
     void add_order(Order* order) {
         order->next = nullptr;
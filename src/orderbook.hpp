@@ -4,9 +4,18 @@
 #include "types.hpp"
 #include "order.hpp"
 #include "events.hpp"
+#include "command.hpp"
+#include "execution_ring.hpp"
+#include "depth.hpp"
+#include "mbo_feed.hpp"
+#include "instrument.hpp"
+#include "latency_probe.hpp"
 #include <map>
 #include <unordered_map>
 #include <vector>
+#include <array>
+#include <atomic>
+#include <memory>
 #include <optional>
 #include <iostream>
 #include <algorithm>
@@ -16,6 +25,15 @@
 // ORDER BOOK - HFT Optimized Matching Engine
 // ============================================================================
 
+// How fills reach the event log and the execution stream. Passive orders
+// are updated individually in both modes; PER_LEVEL only changes what is
+// reported: one LevelTradeEvent / LEVEL_FILL per price level an aggressive
+// order trades at, with per-fill detail routed to optional side channels.
+enum class FillReporting : uint8_t {
+    PER_FILL = 0,
+    PER_LEVEL = 1
+};
+
 class OrderBook {
 private:
     // ------------------------------------------------------------------------
@@ -39,68 +57,116 @@ private:
     
     Timestamp current_time_;
 
+    // Reference data orders are validated against before matching
+    Instrument instrument_;
+
+    // Optional downstream execution stream (not owned, may be null)
+    ExecutionStream* exec_stream_ = nullptr;
+
+    // L2 market data: top-N caches (rebuilt lazily) and optional delta stream
+    mutable DepthCache bid_depth_;
+    mutable DepthCache ask_depth_;
+    std::vector<LevelDelta> level_deltas_;
+    bool record_deltas_ = false;
+
+    // Optional Fenwick trees over the instrument's tick band, one per side
+    CumulativeDepth bid_cumulative_;
+    CumulativeDepth ask_cumulative_;
+    bool cumulative_enabled_ = false;
+    int32_t cumulative_min_tick_ = 0;
+
+    // Optional L3 feed encoder (not owned, may be null), and the messages
+    // it had no buffer for since it was attached
+    MboFeedEncoder* mbo_feed_ = nullptr;
+    uint64_t mbo_dropped_ = 0;
+
+    // Optional sink fed every event as it is logged (not owned, may be null)
+    EventSink* event_sink_ = nullptr;
+
+    // Per-level fill reporting; per-fill detail goes to a separate log and
+    // stream (not owned, may be null), both off by default
+    FillReporting fill_reporting_ = FillReporting::PER_FILL;
+    std::vector<TradeEvent> fill_detail_;
+    bool record_fill_detail_ = false;
+    ExecutionStream* fill_detail_stream_ = nullptr;
+
+    // Live quote order ids per owner, plus scratch reused across quotes
+    std::unordered_map<uint32_t, std::vector<uint64_t>> quote_ladders_;
+    std::vector<Order*> quote_live_;
+    std::vector<Order*> quote_match_;
+
+    // Ladders for logged quotes, reused round-robin once no event (or copy
+    // of one, e.g. in a journal queue) still holds them
+    static constexpr size_t QUOTE_LADDER_POOL = 64;
+    std::array<std::shared_ptr<QuoteLadder>, QUOTE_LADDER_POOL> ladder_pool_;
+    size_t ladder_cursor_ = 0;
+
 public:
+    static constexpr size_t DEFAULT_DEPTH_LEVELS = 10;
+
     // Pre-allocate memory to avoid runtime allocation
     explicit OrderBook(size_t capacity = 1000000) 
-        : order_pool_(capacity), current_time_(Timestamp(0)) {
+        : order_pool_(capacity), current_time_(Timestamp(0)),
+          bid_depth_(DEFAULT_DEPTH_LEVELS), ask_depth_(DEFAULT_DEPTH_LEVELS) {
         event_log_.reserve(capacity);
         order_index_.reserve(capacity);
     }
 
     // ========================================================================
-    // PROCESS: NEW ORDER
+    // REFERENCE DATA
     // ========================================================================
-    void process_new_order(OrderId id, Side side, Price price, Quantity qty) {
-        current_time_ = Timestamp(current_time_.get() + 1);
-        
-        // 1. Log Event (Zero allocation, emplace back)
-        event_log_.emplace_back(std::in_place_type<NewOrderEvent>, 
-                              current_time_, id, side, price, qty);
+    // Installs tick size, lot size and price bands. Only allowed while the
+    // book is empty, so no resting order can be left off-grid; the change
+    // is logged as an input. Returns false (and changes nothing) otherwise.
+    bool set_instrument(const Instrument& instrument) {
+        if (!instrument.valid() || order_index_.size() != 0) return false;
 
-        // 2. Allocate Order from Pool (O(1))
-        Order* order = order_pool_.allocate();
-        if (!order) {
-            std::cerr << "CRITICAL: Order Pool Exhausted!\n";
-            return;
-        }
-        // Initialize order in-place
-        *order = Order(id, current_time_, side, price, qty);
-        
-        // 3. Indexing
-        order_index_[id.get()] = order;
+        current_time_ = Timestamp(current_time_.get() + 1);
+        log_event<InstrumentEvent>(current_time_, instrument);
+        instrument_ = instrument;
+        if (cumulative_enabled_) enable_cumulative_depth(true);  // Resize to the new band
+        return true;
+    }
 
-        // 4. Match logic
-        if (side == Side::BUY) {
-            match_order_buy(order);
-        } else {
-            match_order_sell(order);
-        }
+    const Instrument& instrument() const {
+        return instrument_;
+    }
 
-        // 5. Add remaining to book
-        if (!order->is_filled()) {
-            add_to_book(order);
-        } else {
-            order_index_.erase(id.get());
-            order_pool_.deallocate(order);
+    // ========================================================================
+    // PROCESS: NEW ORDER
+    // ========================================================================
+    void process_new_order(OrderId id, Side side, Price price, Quantity qty,
+                           OwnerId owner = OwnerId(0)) {
+        ME_PROBE_SCOPE(NEW_ORDER);
+        RejectReason reason;
+        {
+            ME_PROBE_SCOPE(VALIDATE);
+            reason = instrument_.validate(price, qty);
         }
+        new_order(id, side, price, qty, owner, reason);
     }
 
     // ========================================================================
     // PROCESS: CANCEL ORDER (Optimized to O(1))
     // ========================================================================
     void process_cancel(OrderId id) {
+        ME_PROBE_SCOPE(CANCEL);
         current_time_ = Timestamp(current_time_.get() + 1);
         
         // Log event
-        event_log_.emplace_back(std::in_place_type<CancelOrderEvent>, 
-                              current_time_, id);
+        log_event<CancelOrderEvent>(current_time_, id);
 
         auto it = order_index_.find(id.get());
         if (it == order_index_.end()) {
+            publish_report(ReportType::REJECT_CANCEL, NO_SIDE, id, OrderId(0),
+                           Price(0), Quantity(0));
             return; // Order not found (already filled or cancelled)
         }
 
         Order* order = it->second;
+        publish_report(ReportType::ACK_CANCEL, order->side, id, OrderId(0),
+                       order->price, order->remaining_qty);
+        if (mbo_feed_) mbo_sent(mbo_feed_->on_delete(current_time_, *order));
 
         // 1. Remove from LimitLevel (Intrusive Unlink O(1))
         remove_from_level(order);
@@ -110,6 +176,220 @@ public:
         order_pool_.deallocate(order);
     }
 
+    // ========================================================================
+    // PROCESS: MASS CANCEL
+    // ========================================================================
+    // Cancels every resting order matching the filter (side, inclusive price
+    // range, owner) and logs a single MassCancelEvent. Without an owner
+    // filter whole levels are released to the pool list-by-list and erased
+    // from the map as one range. Each cancelled order gets an ACK_CANCEL on
+    // the execution stream, followed by one ACK_MASS_CANCEL with the count.
+    // Returns the number of orders cancelled.
+    size_t process_mass_cancel(const MassCancelFilter& filter) {
+        current_time_ = Timestamp(current_time_.get() + 1);
+
+        log_event<MassCancelEvent>(current_time_, filter);
+
+        size_t cancelled = 0;
+        if (filter.any_owner() && filter.includes(Side::BUY) &&
+            filter.includes(Side::SELL) && covers_whole_book(filter)) {
+            // Everything goes: the index is cleared wholesale, and since every
+            // pool slot in use is a resting order, the pool is reset without
+            // walking the level lists (unless someone needs per-order reports)
+            cancelled = order_index_.size();
+            if (mbo_feed_ || exec_stream_) {
+                release_levels(Side::BUY, bids_, bids_.begin(), bids_.end(), false);
+                release_levels(Side::SELL, asks_, asks_.begin(), asks_.end(), false);
+            } else {
+                drop_levels(Side::BUY, bids_);
+                drop_levels(Side::SELL, asks_);
+            }
+            order_pool_.release_all();
+            order_index_.clear();
+        } else {
+            if (filter.includes(Side::BUY)) {
+                // Bids are ordered high to low
+                cancelled += mass_cancel_side(Side::BUY, bids_,
+                    bids_.lower_bound(filter.max_price.get()),
+                    bids_.upper_bound(filter.min_price.get()), filter.owner);
+            }
+            if (filter.includes(Side::SELL)) {
+                cancelled += mass_cancel_side(Side::SELL, asks_,
+                    asks_.lower_bound(filter.min_price.get()),
+                    asks_.upper_bound(filter.max_price.get()), filter.owner);
+            }
+        }
+
+        publish_report(ReportType::ACK_MASS_CANCEL, NO_SIDE, OrderId(0), OrderId(0),
+                       Price(0), Quantity(cancelled));
+        return cancelled;
+    }
+
+    // ========================================================================
+    // PROCESS: MODIFY ORDER (Cancel/Replace)
+    // ========================================================================
+    // `qty` is the new remaining quantity. A reduction at the same price is
+    // applied in place and keeps queue priority. A price change or a size
+    // increase loses priority: the order is unlinked, re-matched as an
+    // aggressor at the new terms and any remainder rests at the back of the
+    // queue, all in the same pool slot and index entry. qty == 0 cancels.
+    void process_modify(OrderId id, Price price, Quantity qty) {
+        modify_order(id, price, qty,
+                     qty.get() > 0 ? instrument_.validate(price, qty) : RejectReason::NONE);
+    }
+
+    // ========================================================================
+    // PROCESS: QUOTE (Two-sided mass quote)
+    // ========================================================================
+    // Replaces the owner's whole bid and ask ladders in one logged operation.
+    // A new rung at the price of one of the owner's live quote orders on the
+    // same side reuses that order (slot, id and index entry) and only has its
+    // size amended, exactly as process_modify would. Live quote orders at
+    // prices no longer quoted are cancelled first, then the remaining rungs
+    // enter as new orders under their own ids. qty == 0 pulls a rung, and so
+    // does a rung the reference data rejects.
+    //
+    // The whole ladder is logged as one event. A quote without an owner, or
+    // whose best live bid rung is at or above its best live ask rung, is
+    // refused as a whole before anything changes. Each rung then gets its
+    // own report, like the single-order command it stands for.
+    //
+    // The logged ladder comes from a small pool owned by the book. Once the
+    // log is drained and its consumers let go of a ladder, it is refilled
+    // for a later quote, so steady-state quoting allocates nothing for it.
+    void process_quote(OwnerId owner, const QuoteEntry* bids, size_t n_bids,
+                       const QuoteEntry* asks, size_t n_asks) {
+        std::shared_ptr<QuoteLadder> ladder = acquire_ladder();
+        ladder->bid_count = static_cast<uint32_t>(n_bids);
+        ladder->rungs.insert(ladder->rungs.end(), bids, bids + n_bids);
+        ladder->rungs.insert(ladder->rungs.end(), asks, asks + n_asks);
+        process_quote(owner, std::move(ladder));
+    }
+
+    // Same, for a ladder already built (e.g. by replay, which shares it with
+    // the logged event instead of copying it)
+    void process_quote(OwnerId owner, std::shared_ptr<const QuoteLadder> quote) {
+        ME_PROBE_SCOPE(QUOTE);
+        current_time_ = Timestamp(current_time_.get() + 1);
+
+        const QuoteEntry* bids = quote->bids();
+        const QuoteEntry* asks = quote->asks();
+        const size_t n_bids = quote->bid_count;
+        const size_t n_asks = quote->ask_count();
+        log_event<QuoteEvent>(current_time_, owner, std::move(quote));
+
+        RejectReason reason = RejectReason::NONE;
+        if (owner.get() == 0 || owner == MassCancelFilter::ANY_OWNER) {
+            reason = RejectReason::NO_OWNER;  // Quotes are tracked per owner
+        } else if (ladder_crosses(bids, n_bids, asks, n_asks)) {
+            reason = RejectReason::CROSSED_QUOTE;
+        }
+        if (reason != RejectReason::NONE) {
+            publish_report(ReportType::REJECT_QUOTE, NO_SIDE, OrderId(0), OrderId(0),
+                           Price(0), Quantity(static_cast<uint64_t>(reason)));
+            return;
+        }
+        publish_report(ReportType::ACK_QUOTE, NO_SIDE, OrderId(0), OrderId(0),
+                       Price(0), Quantity(n_bids + n_asks));
+
+        // 1. Resolve the previous ladder; orders filled or cancelled since drop out
+        std::vector<uint64_t>& ladder = quote_ladders_[owner.get()];
+        quote_live_.clear();
+        for (uint64_t id : ladder) {
+            auto it = order_index_.find(id);
+            if (it != order_index_.end() && it->second->owner == owner) {
+                quote_live_.push_back(it->second);
+            }
+        }
+
+        // 2. Pair each rung with a live order at its price, then cancel the rest
+        quote_match_.assign(n_bids + n_asks, nullptr);
+        pair_rungs(Side::BUY, bids, n_bids, quote_match_.data());
+        pair_rungs(Side::SELL, asks, n_asks, quote_match_.data() + n_bids);
+        for (Order* order : quote_live_) {
+            if (!order) continue;
+            publish_report(ReportType::ACK_CANCEL, order->side, order->id, OrderId(0),
+                           order->price, order->remaining_qty);
+            cancel_resting(order);
+        }
+
+        // 3. Amend paired rungs in place, enter the others
+        ladder.clear();
+        apply_rungs(Side::BUY, bids, n_bids, quote_match_.data(), owner, ladder);
+        apply_rungs(Side::SELL, asks, n_asks, quote_match_.data() + n_bids, owner, ladder);
+    }
+
+    // ========================================================================
+    // PROCESS: BATCH
+    // ========================================================================
+    // Processes n commands with exactly the same results as calling
+    // process_new_order / process_cancel one by one. Log space is reserved
+    // once up front. There is no look-ahead: the index and the price tree
+    // expose no address to prefetch short of the lookup itself, and warming
+    // pool slots measured no faster.
+    void process_batch(const Command* cmds, size_t n) {
+        // At least one log event per command; amortise growth geometrically
+        size_t needed = event_log_.size() + n;
+        if (needed > event_log_.capacity()) {
+            event_log_.reserve(std::max(needed, event_log_.capacity() * 2));
+        }
+
+        for (size_t i = 0; i < n; ++i) {
+            const Command& cmd = cmds[i];
+            switch (cmd.type) {
+                case CommandType::NEW_ORDER:
+                    process_new_order(cmd.id, cmd.side, cmd.price, cmd.quantity, cmd.owner);
+                    break;
+                case CommandType::CANCEL_ORDER:
+                    process_cancel(cmd.id);
+                    break;
+                case CommandType::MODIFY_ORDER:
+                    process_modify(cmd.id, cmd.price, cmd.quantity);
+                    break;
+            }
+        }
+    }
+
+    // ========================================================================
+    // PROCESS: PRE-VALIDATED COMMAND
+    // ========================================================================
+    // Applies a command whose instrument checks already ran elsewhere
+    // (validate_command, e.g. on an ingress thread). The verdict must come
+    // from the instrument installed here; results are then identical to
+    // process_batch on the same command.
+    RejectReason validate_command(const Command& cmd) const {
+        return validate_command(instrument_, cmd);
+    }
+
+    static RejectReason validate_command(const Instrument& instrument, const Command& cmd) {
+        switch (cmd.type) {
+            case CommandType::NEW_ORDER:
+                return instrument.validate(cmd.price, cmd.quantity);
+            case CommandType::MODIFY_ORDER:
+                return cmd.quantity.get() > 0 ? instrument.validate(cmd.price, cmd.quantity)
+                                              : RejectReason::NONE;
+            case CommandType::CANCEL_ORDER:
+                break;
+        }
+        return RejectReason::NONE;
+    }
+
+    void process_validated(const Command& cmd, RejectReason verdict) {
+        switch (cmd.type) {
+            case CommandType::NEW_ORDER: {
+                ME_PROBE_SCOPE(NEW_ORDER);
+                new_order(cmd.id, cmd.side, cmd.price, cmd.quantity, cmd.owner, verdict);
+                break;
+            }
+            case CommandType::CANCEL_ORDER:
+                process_cancel(cmd.id);
+                break;
+            case CommandType::MODIFY_ORDER:
+                modify_order(cmd.id, cmd.price, cmd.quantity, verdict);
+                break;
+        }
+    }
+
     // ========================================================================
     // READ-ONLY ACCESSORS
     // ========================================================================
@@ -123,10 +403,264 @@ public:
         return Price(asks_.begin()->first);
     }
 
+    // Number of orders currently resting on the book
+    size_t order_count() const {
+        return order_index_.size();
+    }
+
     const std::vector<Event>& get_event_log() const {
         return event_log_;
     }
 
+    // Drops logged events, keeping the reserved capacity. For owners that
+    // stream the log elsewhere as it grows (see Pipeline).
+    void clear_event_log() {
+        event_log_.clear();
+    }
+
+    // ========================================================================
+    // L2 DEPTH
+    // ========================================================================
+    // Top-N aggregated levels, best first. Served from a cache that is only
+    // rebuilt after one of the top N levels on that side has changed.
+    const std::vector<DepthLevel>& get_depth(Side side) const {
+        return side == Side::BUY ? bid_depth_.get(bids_) : ask_depth_.get(asks_);
+    }
+
+    // Number of levels served by get_depth() on each side
+    void set_depth_levels(size_t n) {
+        bid_depth_.set_depth(n);
+        ask_depth_.set_depth(n);
+    }
+
+    size_t depth_levels() const {
+        return bid_depth_.depth();
+    }
+
+    // Per-level NEW/CHANGE/DELETE records, appended as levels are mutated.
+    // Disabled by default; the consumer drains with clear_level_deltas().
+    void enable_level_deltas(bool enabled, size_t reserve = 0) {
+        record_deltas_ = enabled;
+        level_deltas_.reserve(reserve);
+    }
+
+    const std::vector<LevelDelta>& get_level_deltas() const {
+        return level_deltas_;
+    }
+
+    void clear_level_deltas() {
+        level_deltas_.clear();
+    }
+
+    // ========================================================================
+    // FILL REPORTING
+    // ========================================================================
+    // The book evolves identically in both modes (the logical clock still
+    // ticks once per fill); only the log and stream contents differ.
+    void set_fill_reporting(FillReporting mode) {
+        fill_reporting_ = mode;
+    }
+
+    FillReporting fill_reporting() const {
+        return fill_reporting_;
+    }
+
+    // PER_LEVEL mode only: the per-fill TradeEvents left out of the primary
+    // log. Disabled by default; the consumer drains with clear_fill_detail().
+    void enable_fill_detail(bool enabled, size_t reserve = 0) {
+        record_fill_detail_ = enabled;
+        fill_detail_.reserve(reserve);
+    }
+
+    const std::vector<TradeEvent>& get_fill_detail() const {
+        return fill_detail_;
+    }
+
+    void clear_fill_detail() {
+        fill_detail_.clear();
+    }
+
+    // ========================================================================
+    // DRY-RUN MATCHING
+    // ========================================================================
+    // What process_new_order(side, limit, qty) would execute right now, with
+    // no mutation, logging or allocation. Matching is price-time FIFO, so
+    // the quantity taken at each level depends only on the level total: no
+    // individual order is ever visited.
+    // Orders the real path would refuse (reference data, full pool) fill nothing.
+    FillEstimate simulate_fill(Side side, Price limit, Quantity qty) const {
+        FillEstimate estimate;
+        if (instrument_.validate(limit, qty) != RejectReason::NONE ||
+            order_pool_.available() == 0) {
+            return estimate;
+        }
+        auto walk = [&](const auto& levels, auto crosses) {
+            uint64_t remaining = qty.get();
+            for (const auto& [price, level] : levels) {
+                if (remaining == 0 || !crosses(price)) break;
+                uint64_t take = std::min(remaining, level.total_volume.get());
+                remaining -= take;
+                estimate.notional += Notional(price) * take;
+                estimate.worst_price = Price(price);
+                ++estimate.levels_touched;
+            }
+            estimate.filled = Quantity(qty.get() - remaining);
+        };
+        if (side == Side::BUY) walk(asks_, [limit](int64_t p) { return p <= limit.get(); });
+        else walk(bids_, [limit](int64_t p) { return p >= limit.get(); });
+        return estimate;
+    }
+
+    // ========================================================================
+    // CUMULATIVE DEPTH
+    // ========================================================================
+    // Indexing needs a price-banded instrument of at most MAX_INDEXED_TICKS
+    // ticks; returns false (leaving it disabled) otherwise. While disabled
+    // the queries below walk the levels instead.
+    static constexpr size_t MAX_INDEXED_TICKS = size_t(1) << 22;
+
+    bool enable_cumulative_depth(bool enabled) {
+        cumulative_enabled_ = false;
+        if (!enabled || !instrument_.restricts_prices()) return !enabled;
+
+        const int32_t lo = instrument_.to_tick(instrument_.min_price);
+        const int32_t hi = instrument_.to_tick(instrument_.max_price);
+        const size_t ticks = static_cast<size_t>(int64_t(hi) - lo + 1);
+        if (ticks > MAX_INDEXED_TICKS) return false;
+
+        cumulative_min_tick_ = lo;
+        bid_cumulative_.reset(ticks);
+        ask_cumulative_.reset(ticks);
+        for (const auto& [price, level] : bids_) {
+            bid_cumulative_.set(tick_position(level.tick), level.total_volume.get());
+        }
+        for (const auto& [price, level] : asks_) {
+            ask_cumulative_.set(tick_position(level.tick), level.total_volume.get());
+        }
+        cumulative_enabled_ = true;
+        return true;
+    }
+
+    bool cumulative_depth_enabled() const {
+        return cumulative_enabled_;
+    }
+
+    // Total resting volume from the best price through `limit` inclusive
+    // (bids at or above it, asks at or below it)
+    Quantity cumulative_volume(Side side, Price limit) const {
+        if (!cumulative_enabled_) {
+            uint64_t sum = 0;
+            auto walk = [&sum, limit](const auto& levels, auto beyond) {
+                for (const auto& [price, level] : levels) {
+                    if (beyond(price, limit.get())) break;
+                    sum += level.total_volume.get();
+                }
+            };
+            if (side == Side::BUY) walk(bids_, [](int64_t p, int64_t l) { return p < l; });
+            else walk(asks_, [](int64_t p, int64_t l) { return p > l; });
+            return Quantity(sum);
+        }
+
+        // Clamp to the band; a limit on a band edge covers the whole side
+        const CumulativeDepth& tree = side == Side::BUY ? bid_cumulative_ : ask_cumulative_;
+        if (limit < instrument_.min_price) {
+            return Quantity(side == Side::BUY ? tree.total() : 0);
+        }
+        if (limit > instrument_.max_price) {
+            return Quantity(side == Side::BUY ? 0 : tree.total());
+        }
+        // Ticks round towards the base; that is the right neighbour for both
+        // sides only when limit is on the grid, so step off-grid limits inwards
+        int32_t tick = instrument_.to_tick(limit);
+        const Price on_grid = instrument_.from_tick(tick);
+        if (side == Side::BUY) {
+            if (on_grid < limit) ++tick;
+            size_t pos = tick_position(tick);
+            return Quantity(tree.total() - (pos == 0 ? 0 : tree.prefix(pos - 1)));
+        }
+        if (on_grid > limit) --tick;
+        if (tick < cumulative_min_tick_) return Quantity(0);
+        return Quantity(tree.prefix(tick_position(tick)));
+    }
+
+    // Price at which the cumulative volume from the best reaches `qty`,
+    // i.e. the worst price an order for qty would trade at against this
+    // side. nullopt if the side holds less than qty.
+    std::optional<Price> price_for_depth(Side side, Quantity qty) const {
+        if (qty.get() == 0) return side == Side::BUY ? best_bid() : best_ask();
+        if (!cumulative_enabled_) {
+            uint64_t sum = 0;
+            auto walk = [&sum, qty](const auto& levels) -> std::optional<Price> {
+                for (const auto& [price, level] : levels) {
+                    sum += level.total_volume.get();
+                    if (sum >= qty.get()) return Price(price);
+                }
+                return std::nullopt;
+            };
+            return side == Side::BUY ? walk(bids_) : walk(asks_);
+        }
+
+        const CumulativeDepth& tree = side == Side::BUY ? bid_cumulative_ : ask_cumulative_;
+        if (tree.total() < qty.get()) return std::nullopt;
+        size_t pos;
+        if (side == Side::BUY) {
+            // Highest position whose suffix sum still reaches qty
+            pos = tree.max_prefix_within(tree.total() - qty.get());
+        } else {
+            // Lowest position whose prefix sum reaches qty
+            pos = tree.max_prefix_within(qty.get() - 1);
+        }
+        return instrument_.from_tick(static_cast<int32_t>(int64_t(pos) + cumulative_min_tick_));
+    }
+
+    // Visits resting orders on one side, best level first and FIFO within
+    // a level: fn(const Order&)
+    template<typename F>
+    void for_each_order(Side side, F&& fn) const {
+        auto visit = [&fn](const auto& levels) {
+            for (const auto& [price, level] : levels) {
+                for (const Order* o = level.head; o; o = o->next) fn(*o);
+            }
+        };
+        if (side == Side::BUY) visit(bids_);
+        else visit(asks_);
+    }
+
+    // ========================================================================
+    // DOWNSTREAM PUBLISHING
+    // ========================================================================
+    // Acks and fills are broadcast to the attached stream as they happen.
+    // The ring never blocks the matching thread; pass nullptr to detach.
+    void attach_execution_stream(ExecutionStream* stream) {
+        exec_stream_ = stream;
+    }
+
+    // Resting-order adds, executions and deletes are encoded straight into
+    // the encoder's packet buffers; pass nullptr to detach.
+    void attach_mbo_feed(MboFeedEncoder* encoder) {
+        mbo_feed_ = encoder;
+        mbo_dropped_ = 0;
+    }
+
+    // L3 messages lost since the feed was attached because every packet
+    // buffer was full. Non-zero means subscribers saw a sequence gap and
+    // must resync from a snapshot.
+    uint64_t mbo_feed_drops() const {
+        return mbo_dropped_;
+    }
+
+    // PER_LEVEL mode only: receives the per-fill FILL reports, while the
+    // main stream gets one LEVEL_FILL per level; pass nullptr to detach.
+    void attach_fill_detail_stream(ExecutionStream* stream) {
+        fill_detail_stream_ = stream;
+    }
+
+    // Every event logged from now on is also passed to the sink, e.g. an
+    // AsyncJournal whose writer thread persists it; pass nullptr to detach.
+    void attach_event_sink(EventSink* sink) {
+        event_sink_ = sink;
+    }
+
     // ========================================================================
     // MATCHING LOGIC
     // ========================================================================
@@ -173,25 +707,48 @@ private:
     }
 
     void match_level(Order* aggressive, LimitLevel& level, Price match_price) {
+        const bool per_level = fill_reporting_ == FillReporting::PER_LEVEL;
+        uint64_t level_qty = 0;
+        uint32_t level_fills = 0;
+
+        ME_PROBE_LEVEL_TOUCHED();
         while (!level.empty() && !aggressive->is_filled()) {
             Order* passive = level.front(); // O(1) access
+            ME_PROBE_ORDER_TOUCHED();
 
             uint64_t trade_qty = std::min(
                 aggressive->remaining_qty.get(),
                 passive->remaining_qty.get()
             );
 
-            // 1. Generate Trade Event
+            // 1. Generate Trade Event (detail channels only in per-level mode)
             current_time_ = Timestamp(current_time_.get() + 1);
-            event_log_.emplace_back(std::in_place_type<TradeEvent>,
-                current_time_, passive->id, aggressive->id,
-                match_price, Quantity(trade_qty)
-            );
+            if (!per_level) {
+                log_event<TradeEvent>(
+                    current_time_, passive->id, aggressive->id,
+                    match_price, Quantity(trade_qty)
+                );
+                publish_report(ReportType::FILL, passive->side, passive->id,
+                               aggressive->id, match_price, Quantity(trade_qty));
+            } else {
+                if (record_fill_detail_) {
+                    fill_detail_.emplace_back(current_time_, passive->id, aggressive->id,
+                                              match_price, Quantity(trade_qty));
+                }
+                publish_report(fill_detail_stream_, ReportType::FILL, passive->side,
+                               passive->id, aggressive->id, match_price, Quantity(trade_qty));
+                level_qty += trade_qty;
+                ++level_fills;
+            }
 
             // 2. Update quantities
             aggressive->remaining_qty = Quantity(aggressive->remaining_qty.get() - trade_qty);
             passive->remaining_qty = Quantity(passive->remaining_qty.get() - trade_qty);
             level.total_volume = Quantity(level.total_volume.get() - trade_qty);
+            if (mbo_feed_) {
+                mbo_sent(mbo_feed_->on_execute(current_time_, *passive, Quantity(trade_qty),
+                                               current_time_.get()));
+            }
 
             // 3. Handle passive fill
             if (passive->is_filled()) {
@@ -202,20 +759,423 @@ private:
                 order_pool_.deallocate(passive);
             }
         }
+
+        if (level_fills > 0) {
+            log_event<LevelTradeEvent>(current_time_, aggressive->id, aggressive->side,
+                                       match_price, Quantity(level_qty), level_fills);
+            publish_report(ReportType::LEVEL_FILL, aggressive->side, aggressive->id,
+                           OrderId(0), match_price, Quantity(level_qty), level_fills);
+        }
+
+        on_level_changed(aggressive->side == Side::BUY ? Side::SELL : Side::BUY, level,
+                         level.empty() ? DeltaAction::DELETE : DeltaAction::CHANGE);
+    }
+
+    void publish_report(ReportType type, Side side, OrderId id, OrderId contra,
+                        Price price, Quantity qty, uint32_t fill_count = 0) {
+        publish_report(exec_stream_, type, side, id, contra, price, qty, fill_count);
+    }
+
+    // Result of every L3 encode; the encoder leaves the sequence gap
+    void mbo_sent(bool encoded) {
+        if (!encoded) ++mbo_dropped_;
+    }
+
+    // Single append point for the event log
+    template<typename E, typename... Args>
+    void log_event(Args&&... args) {
+        event_log_.emplace_back(std::in_place_type<E>, std::forward<Args>(args)...);
+        if (event_sink_) event_sink_->on_event(event_log_.back());
+    }
+
+    void reject(ReportType type, Side side, OrderId id, RejectReason reason) {
+        log_event<RejectOrderEvent>(current_time_, id, reason);
+        publish_report(type, side, id, OrderId(0), Price(0),
+                       Quantity(static_cast<uint64_t>(reason)));
+    }
+
+    void publish_report(ExecutionStream* stream, ReportType type, Side side, OrderId id,
+                        OrderId contra, Price price, Quantity qty, uint32_t fill_count = 0) {
+        if (!stream) return;
+        stream->publish(ExecutionReport{
+            type, side, fill_count, current_time_.get(), id.get(), contra.get(),
+            price.get(), qty.get()
+        });
     }
 
     // ========================================================================
     // BOOK MANAGEMENT HELPERS
     // ========================================================================
+    // Body of process_new_order once `reason` (the instrument verdict) is known
+    void new_order(OrderId id, Side side, Price price, Quantity qty, OwnerId owner,
+                   RejectReason reason) {
+        current_time_ = Timestamp(current_time_.get() + 1);
+        
+        // 1. Log Event (Zero allocation, emplace back)
+        {
+            ME_PROBE_SCOPE(LOG);
+            log_event<NewOrderEvent>(current_time_, id, side, price, qty, owner);
+        }
+
+        // 2. Refuse orders the reference data does not allow, and orders
+        //    under ANY_OWNER (a mass cancel could not single them out)
+        if (reason == RejectReason::NONE && owner == MassCancelFilter::ANY_OWNER) {
+            reason = RejectReason::RESERVED_OWNER;
+        }
+        if (reason != RejectReason::NONE) {
+            reject(ReportType::REJECT_NEW, side, id, reason);
+            return;
+        }
+
+        // 3. Ack, match, and rest any remainder
+        enter_order(id, side, price, qty, owner);
+    }
+
+    // `reason` is the instrument verdict on the new terms, applied only if
+    // the order is found (NONE for qty == 0)
+    void modify_order(OrderId id, Price price, Quantity qty, RejectReason reason) {
+        ME_PROBE_SCOPE(MODIFY);
+        current_time_ = Timestamp(current_time_.get() + 1);
+
+        log_event<ModifyOrderEvent>(current_time_, id, price, qty);
+
+        auto it = order_index_.find(id.get());
+        if (it == order_index_.end()) {
+            publish_report(ReportType::REJECT_MODIFY, NO_SIDE, id, OrderId(0),
+                           price, qty);
+            return; // Order not found (already filled or cancelled)
+        }
+
+        Order* order = it->second;
+        if (reason != RejectReason::NONE) {
+            reject(ReportType::REJECT_MODIFY, order->side, id, reason);
+            return; // Order keeps its current terms
+        }
+        publish_report(ReportType::ACK_MODIFY, order->side, id, OrderId(0), price, qty);
+        amend_resting(order, price, qty);
+    }
+
+    // Acks and matches a stack-resident order; most aggressive orders never
+    // rest, so they never touch the pool or the index. An order is refused
+    // instead of acked while a remainder could not rest (pool exhausted).
+    // Returns true if a remainder rests.
+    bool enter_order(OrderId id, Side side, Price price, Quantity qty, OwnerId owner) {
+        if (order_pool_.available() == 0) {
+            std::cerr << "CRITICAL: Order Pool Exhausted!\n";
+            reject(ReportType::REJECT_NEW, side, id, RejectReason::POOL_EXHAUSTED);
+            return false;
+        }
+        publish_report(ReportType::ACK_NEW, side, id, OrderId(0), price, qty);
+
+        Order incoming(id, current_time_, side, price, qty, owner);
+        {
+            ME_PROBE_SCOPE(MATCH);
+            ME_PROBE_SWEEP_BEGIN();
+            if (side == Side::BUY) {
+                match_order_buy(&incoming);
+            } else {
+                match_order_sell(&incoming);
+            }
+            ME_PROBE_SWEEP_END();
+        }
+
+        // Only a resting remainder takes a pool slot and an index entry
+        if (incoming.is_filled()) return false;
+        ME_PROBE_SCOPE(REST);
+        Order* order = order_pool_.allocate();  // O(1), checked above
+        *order = incoming;
+        order_index_[id.get()] = order;
+        add_to_book(order);
+        return true;
+    }
+
+    void cancel_resting(Order* order) {
+        if (mbo_feed_) mbo_sent(mbo_feed_->on_delete(current_time_, *order));
+        remove_from_level(order);
+        order_index_.erase(order->id.get());
+        order_pool_.deallocate(order);
+    }
+
+    // Applies new terms to a resting order (see process_modify). Returns
+    // true if the order is still resting afterwards.
+    bool amend_resting(Order* order, Price price, Quantity qty) {
+        // 1. Cancel
+        if (qty.get() == 0) {
+            cancel_resting(order);
+            return false;
+        }
+
+        // 2. In-place reduction (keeps priority)
+        if (price == order->price && qty <= order->remaining_qty) {
+            uint64_t reduced = order->remaining_qty.get() - qty.get();
+            if (reduced == 0) return true;
+
+            LimitLevel* level = find_level(order->side, order->price);
+            if (!level) return true; // Should not happen
+
+            order->remaining_qty = qty;
+            level->total_volume = Quantity(level->total_volume.get() - reduced);
+            if (mbo_feed_) {
+                mbo_sent(mbo_feed_->on_cancel(current_time_, *order, Quantity(reduced)));
+            }
+            on_level_changed(order->side, *level, DeltaAction::CHANGE);
+            return true;
+        }
+
+        // 3. Replace (loses priority, may cross)
+        if (mbo_feed_) mbo_sent(mbo_feed_->on_delete(current_time_, *order));
+        remove_from_level(order);
+
+        order->price = price;
+        order->original_qty = qty;
+        order->remaining_qty = qty;
+        order->timestamp = current_time_;
+
+        if (order->side == Side::BUY) {
+            match_order_buy(order);
+        } else {
+            match_order_sell(order);
+        }
+
+        if (order->is_filled()) {
+            order_index_.erase(order->id.get());
+            order_pool_.deallocate(order);
+            return false;
+        }
+        add_to_book(order);
+        return true;
+    }
+
+    // Claims, for each rung, the live quote order resting at the same price
+    // on this side. Claimed orders are taken out of quote_live_. The search
+    // resumes after the previous claim, so ladders re-sent in the same order
+    // pair in a single pass.
+    // The next pool slot, emptied, if nothing else holds its ladder; a new
+    // ladder in that slot otherwise
+    std::shared_ptr<QuoteLadder> acquire_ladder() {
+        std::shared_ptr<QuoteLadder>& slot = ladder_pool_[ladder_cursor_];
+        ladder_cursor_ = (ladder_cursor_ + 1) % QUOTE_LADDER_POOL;
+        if (slot && slot.use_count() == 1) {
+            // The last other holder may have been another thread; its reads
+            // of the rungs happen before it released the ladder
+            std::atomic_thread_fence(std::memory_order_acquire);
+            slot->rungs.clear();
+        } else {
+            slot = std::make_shared<QuoteLadder>();
+        }
+        return slot;
+    }
+
+    void pair_rungs(Side side, const QuoteEntry* rungs, size_t n, Order** match) {
+        const size_t live = quote_live_.size();
+        size_t cursor = 0;
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t k = 0; k < live; ++k) {
+                size_t j = cursor + k < live ? cursor + k : cursor + k - live;
+                Order* order = quote_live_[j];
+                if (order && order->side == side && order->price == rungs[i].price) {
+                    match[i] = order;
+                    quote_live_[j] = nullptr;
+                    cursor = j + 1;
+                    break;
+                }
+            }
+        }
+    }
+
+    // Reports each rung as the command it amounts to: ACK_MODIFY for an
+    // amended order, ACK_CANCEL for a pulled one (quantity 0 if nothing was
+    // resting), ACK_NEW for a new order, REJECT_NEW for a refused rung.
+    void apply_rungs(Side side, const QuoteEntry* rungs, size_t n, Order* const* match,
+                     OwnerId owner, std::vector<uint64_t>& ladder) {
+        for (size_t i = 0; i < n; ++i) {
+            Quantity qty = rungs[i].quantity;
+            if (qty.get() > 0) {
+                RejectReason reason = instrument_.validate(rungs[i].price, qty);
+                if (reason != RejectReason::NONE) {
+                    reject(ReportType::REJECT_NEW, side, rungs[i].id, reason);
+                    qty = Quantity(0);
+                }
+            }
+            if (match[i]) {
+                Order* order = match[i];
+                if (qty.get() > 0) {
+                    publish_report(ReportType::ACK_MODIFY, side, order->id, OrderId(0),
+                                   rungs[i].price, qty);
+                } else {
+                    publish_report(ReportType::ACK_CANCEL, side, order->id, OrderId(0),
+                                   order->price, order->remaining_qty);
+                }
+                if (amend_resting(order, rungs[i].price, qty)) {
+                    ladder.push_back(order->id.get());
+                }
+            } else if (qty.get() > 0) {
+                if (enter_order(rungs[i].id, side, rungs[i].price, qty, owner)) {
+                    ladder.push_back(rungs[i].id.get());
+                }
+            } else if (rungs[i].quantity.get() == 0) {
+                publish_report(ReportType::ACK_CANCEL, side, rungs[i].id, OrderId(0),
+                               rungs[i].price, Quantity(0));
+            }
+        }
+    }
+
+    // True if the ladder's best live bid is at or above its best live ask;
+    // rungs being pulled (qty == 0) do not count
+    static bool ladder_crosses(const QuoteEntry* bids, size_t n_bids,
+                               const QuoteEntry* asks, size_t n_asks) {
+        bool any_bid = false, any_ask = false;
+        Price best_bid(0), best_ask(0);
+        for (size_t i = 0; i < n_bids; ++i) {
+            if (bids[i].quantity.get() == 0) continue;
+            if (!any_bid || bids[i].price > best_bid) best_bid = bids[i].price;
+            any_bid = true;
+        }
+        for (size_t i = 0; i < n_asks; ++i) {
+            if (asks[i].quantity.get() == 0) continue;
+            if (!any_ask || asks[i].price < best_ask) best_ask = asks[i].price;
+            any_ask = true;
+        }
+        return any_bid && any_ask && best_bid >= best_ask;
+    }
+
+    size_t tick_position(int32_t tick) const {
+        return static_cast<size_t>(int64_t(tick) - cumulative_min_tick_);
+    }
+
+    int32_t level_tick(Price price) const {
+        return instrument_.restricts_prices() ? instrument_.to_tick(price) : 0;
+    }
+
     void add_to_book(Order* order) {
         // Find or create level
         if (order->side == Side::BUY) {
-            auto [it, inserted] = bids_.try_emplace(order->price.get(), order->price);
+            auto [it, inserted] = bids_.try_emplace(order->price.get(), order->price,
+                                                    level_tick(order->price));
             it->second.add_order(order);
+            on_level_changed(Side::BUY, it->second,
+                             inserted ? DeltaAction::NEW : DeltaAction::CHANGE);
         } else {
-            auto [it, inserted] = asks_.try_emplace(order->price.get(), order->price);
+            auto [it, inserted] = asks_.try_emplace(order->price.get(), order->price,
+                                                    level_tick(order->price));
             it->second.add_order(order);
+            on_level_changed(Side::SELL, it->second,
+                             inserted ? DeltaAction::NEW : DeltaAction::CHANGE);
+        }
+        if (mbo_feed_) mbo_sent(mbo_feed_->on_add(current_time_, *order));
+    }
+
+    template<typename LevelMap>
+    size_t mass_cancel_side(Side side, LevelMap& levels, typename LevelMap::iterator first,
+                            typename LevelMap::iterator last, OwnerId owner) {
+        // Guard against an inverted price range
+        if (first == levels.end() || (last != levels.end() &&
+                                      levels.key_comp()(last->first, first->first))) {
+            return 0;
+        }
+
+        if (owner == MassCancelFilter::ANY_OWNER) {
+            return release_levels(side, levels, first, last, true);
         }
+
+        // Owner-scoped: unlink matching orders, keep the rest in FIFO order
+        size_t cancelled = 0;
+        for (auto it = first; it != last;) {
+            LimitLevel& level = it->second;
+            size_t before = level.order_count;
+            Order* o = level.head;
+            while (o) {
+                Order* next = o->next;
+                if (o->owner == owner) {
+                    report_mass_cancelled(*o);
+                    if (o->prev) o->prev->next = o->next;
+                    else level.head = o->next;
+                    if (o->next) o->next->prev = o->prev;
+                    else level.tail = o->prev;
+                    level.total_volume = Quantity(level.total_volume.get() - o->remaining_qty.get());
+                    --level.order_count;
+                    order_index_.erase(o->id.get());
+                    order_pool_.deallocate(o);
+                }
+                o = next;
+            }
+
+            cancelled += before - level.order_count;
+            if (level.order_count != before) {
+                on_level_changed(side, level,
+                                 level.empty() ? DeltaAction::DELETE : DeltaAction::CHANGE);
+            }
+            it = level.empty() ? levels.erase(it) : std::next(it);
+        }
+        return cancelled;
+    }
+
+    // Releases whole level lists to the pool and erases the levels as one
+    // range. With erase_index == false the caller clears the index and
+    // resets the pool itself; the lists are only walked for the L3 feed
+    // and the per-order cancel reports.
+    template<typename LevelMap>
+    size_t release_levels(Side side, LevelMap& levels, typename LevelMap::iterator first,
+                          typename LevelMap::iterator last, bool erase_index) {
+        size_t cancelled = 0;
+        for (auto it = first; it != last; ++it) {
+            LimitLevel& level = it->second;
+            if (mbo_feed_ || exec_stream_ || erase_index) {
+                for (Order* o = level.head; o; o = o->next) {
+                    report_mass_cancelled(*o);
+                    if (erase_index) order_index_.erase(o->id.get());
+                }
+            }
+            cancelled += level.order_count;
+            if (erase_index) order_pool_.deallocate_list(level.head);
+            level.head = level.tail = nullptr;
+            level.total_volume = Quantity(0);
+            level.order_count = 0;
+            on_level_changed(side, level, DeltaAction::DELETE);
+        }
+        levels.erase(first, last);
+        return cancelled;
+    }
+
+    // Per-order downstream output of a mass cancel: L3 delete and ACK_CANCEL
+    void report_mass_cancelled(const Order& order) {
+        if (mbo_feed_) mbo_sent(mbo_feed_->on_delete(current_time_, order));
+        publish_report(ReportType::ACK_CANCEL, order.side, order.id, OrderId(0),
+                       order.price, order.remaining_qty);
+    }
+
+    // Empties one side without visiting any order: DELETE per level only
+    template<typename LevelMap>
+    void drop_levels(Side side, LevelMap& levels) {
+        for (auto& [price, level] : levels) {
+            level.total_volume = Quantity(0);
+            level.order_count = 0;
+            on_level_changed(side, level, DeltaAction::DELETE);
+        }
+        levels.clear();
+    }
+
+    bool covers_whole_book(const MassCancelFilter& filter) const {
+        auto within = [&filter](int64_t price) {
+            return price >= filter.min_price.get() && price <= filter.max_price.get();
+        };
+        // Each side's extremes are its first and last levels
+        if (!bids_.empty() && (!within(bids_.begin()->first) || !within(bids_.rbegin()->first))) {
+            return false;
+        }
+        if (!asks_.empty() && (!within(asks_.begin()->first) || !within(asks_.rbegin()->first))) {
+            return false;
+        }
+        return true;
+    }
+
+    LimitLevel* find_level(Side side, Price price) {
+        if (side == Side::BUY) {
+            auto it = bids_.find(price.get());
+            return it != bids_.end() ? &it->second : nullptr;
+        }
+        auto it = asks_.find(price.get());
+        return it != asks_.end() ? &it->second : nullptr;
     }
 
     // O(1) removal from doubly-linked list
@@ -226,15 +1186,7 @@ private:
         // at the cost of 8 bytes. Here we look up in map (O(log M)).
         // But the unlinking itself is O(1).
         
-        LimitLevel* level = nullptr;
-        if (order->side == Side::BUY) {
-            auto it = bids_.find(order->price.get());
-            if (it != bids_.end()) level = &it->second;
-        } else {
-            auto it = asks_.find(order->price.get());
-            if (it != asks_.end()) level = &it->second;
-        }
-
+        LimitLevel* level = find_level(order->side, order->price);
         if (!level) return; // Should not happen
 
         // Unlink from list
@@ -248,12 +1200,42 @@ private:
         level->total_volume = Quantity(level->total_volume.get() - order->remaining_qty.get());
         level->order_count--;
 
+        on_level_changed(order->side, *level,
+                         level->empty() ? DeltaAction::DELETE : DeltaAction::CHANGE);
+
         // Clean up level if empty
         if (level->empty()) {
             if (order->side == Side::BUY) bids_.erase(order->price.get());
             else asks_.erase(order->price.get());
         }
     }
+
+    // Single hook for every level mutation: invalidates the top-N cache when
+    // the level ranks within it and records the delta if enabled.
+    void on_level_changed(Side side, const LimitLevel& level, DeltaAction action) {
+        if (side == Side::BUY) {
+            bid_depth_.on_level_changed(level.price,
+                [](Price a, Price b) { return a.get() >= b.get(); });
+        } else {
+            ask_depth_.on_level_changed(level.price,
+                [](Price a, Price b) { return a.get() <= b.get(); });
+        }
+
+        if (cumulative_enabled_) {
+            CumulativeDepth& tree = side == Side::BUY ? bid_cumulative_ : ask_cumulative_;
+            tree.set(tick_position(level.tick),
+                     action == DeltaAction::DELETE ? 0 : level.total_volume.get());
+        }
+
+        if (record_deltas_) {
+            bool deleted = action == DeltaAction::DELETE;
+            level_deltas_.push_back(LevelDelta{
+                current_time_, side, action, level.price,
+                deleted ? Quantity(0) : level.total_volume,
+                deleted ? 0 : level.order_count
+            });
+        }
+    }
 };
 
 #endif
\ No newline at end of file
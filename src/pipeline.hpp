@@ -0,0 +1,364 @@
+#ifndef PIPELINE_HPP
+#define PIPELINE_HPP
+
+#include "orderbook.hpp"
+#include "journal.hpp"
+#include "async_journal.hpp"
+#include "latency_probe.hpp"
+#include "spsc_ring.hpp"
+#include <atomic>
+#include <array>
+#include <memory>
+#include <thread>
+#include <functional>
+#include <string>
+#include <ostream>
+#include <iomanip>
+#include <stdexcept>
+#include <cstdint>
+#include <cstddef>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+// ============================================================================
+// PIPELINE RECORDS
+// ============================================================================
+
+struct PipelineCommand {
+    uint64_t seq = 0;                       // Global input sequence, from 1
+    Command command = Command::cancel(OrderId(0));
+    RejectReason verdict = RejectReason::NONE;
+    uint64_t submit_tsc = 0;
+    uint64_t ingress_tsc = 0;               // Validated
+};
+
+struct PipelineEvent {
+    uint64_t seq = 0;                       // Command that logged it (0: before start)
+    Event event = Event(std::in_place_type<CancelOrderEvent>, Timestamp(0), OrderId(0));
+    bool last = false;                      // Final event of its command
+    uint64_t submit_tsc = 0;
+    uint64_t ingress_tsc = 0;
+    uint64_t match_tsc = 0;                 // Command applied to the book
+    uint64_t journal_tsc = 0;               // Event appended to the journal
+};
+
+enum class PipelineHop : uint8_t {
+    INGRESS = 0,        // submit -> validated (queueing + decode/validate)
+    MATCH = 1,          // validated -> applied to the book
+    JOURNAL = 2,        // applied -> last event journaled
+    PUBLISH = 3,        // journaled -> handed to the subscriber
+    END_TO_END = 4,     // submit -> handed to the subscriber
+    COUNT = 5
+};
+
+inline const char* to_string(PipelineHop hop) {
+    static const char* const names[] = {"ingress", "match", "journal", "publish", "end_to_end"};
+    return hop < PipelineHop::COUNT ? names[static_cast<size_t>(hop)] : "unknown";
+}
+
+struct PipelineConfig {
+    size_t book_capacity = 1000000;
+    size_t ring_capacity = 1 << 16;         // Per ring, rounded up to a power of two
+    std::string journal_path = "pipeline.jnl";  // AsyncJournal file (directory with segment_bytes)
+    AsyncJournalConfig journal;
+    EventSink* journal_sink = nullptr;      // Replaces the AsyncJournal; owned by the caller
+    bool memory_journal = false;            // Tests: an in-memory JournalWriter instead
+    size_t journal_block_events = JOURNAL_DEFAULT_BLOCK_EVENTS;    // Memory journal only
+    int ingress_cpu = -1;                   // CPU to pin each stage to; -1 = unpinned
+    int match_cpu = -1;
+    int journal_cpu = -1;
+    int publish_cpu = -1;
+};
+
+// ============================================================================
+// PIPELINE - Staged multi-threaded runtime around one OrderBook
+// ============================================================================
+//
+//   submit() -> [ingress] -> [match] -> [journal] -> [publish] -> subscriber
+//
+// - ingress stamps the global sequence number and runs the instrument checks
+//   (OrderBook::validate_command) on a copy of the book's instrument
+// - match is the only thread that touches the OrderBook. It applies each
+//   command with the ingress verdict and forwards the events it logged,
+//   then clears the book's log so it never grows
+// - journal hands every event to an EventSink: by default an AsyncJournal
+//   at config.journal_path, whose own writer thread batches it to disk
+// - publish hands events to the subscriber, so nothing is published before
+//   the journal has it, and records per-hop latency. Callers that need it
+//   durable first wait on async_journal()->wait_durable(seq).
+//
+// Every hop is a FIFO SpscRing, so the published stream is exactly the
+// event log single-threaded processing of the same commands would produce.
+// A full ring stalls its producer (backpressure) rather than dropping.
+//
+// Waiting stages spin briefly, then yield: a stage pinned to its own core
+// stays in the spin, while an oversubscribed machine still makes progress.
+// Configure the book (instrument, fill reporting, attached streams) before
+// start(); read book() and journal() only while stopped. The AsyncJournal
+// is closed, and its last events synced, when the Pipeline is destroyed.
+
+class Pipeline {
+public:
+    using Subscriber = std::function<void(const PipelineEvent&)>;
+    static constexpr size_t HOPS = static_cast<size_t>(PipelineHop::COUNT);
+
+    explicit Pipeline(const PipelineConfig& config = PipelineConfig())
+        : config_(config), book_(config.book_capacity),
+          submitted_ring_(config.ring_capacity), validated_ring_(config.ring_capacity),
+          matched_ring_(config.ring_capacity), journaled_ring_(config.ring_capacity) {
+        if (config_.journal_sink) {
+            sink_ = config_.journal_sink;
+        } else if (config_.memory_journal) {
+            memory_journal_ = std::make_unique<JournalWriter>(config_.journal_block_events);
+            sink_ = memory_journal_.get();
+        } else {
+            async_journal_ = std::make_unique<AsyncJournal>(config_.journal_path, config_.journal);
+            sink_ = async_journal_.get();
+        }
+    }
+
+    ~Pipeline() {
+        stop();
+    }
+
+    Pipeline(const Pipeline&) = delete;
+    Pipeline& operator=(const Pipeline&) = delete;
+
+    // Called on the publish thread for every event, in sequence order
+    void subscribe(Subscriber subscriber) {
+        subscriber_ = std::move(subscriber);
+    }
+
+    void start() {
+        if (running_) return;
+        instrument_ = book_.instrument();
+        submit_done_.store(false, std::memory_order_relaxed);
+        ingress_done_.store(false, std::memory_order_relaxed);
+        match_done_.store(false, std::memory_order_relaxed);
+        journal_done_.store(false, std::memory_order_relaxed);
+
+        threads_[0] = std::thread([this] { ingress_loop(); });
+        threads_[1] = std::thread([this] { match_loop(); });
+        threads_[2] = std::thread([this] { journal_loop(); });
+        threads_[3] = std::thread([this] { publish_loop(); });
+        const int cpus[] = {config_.ingress_cpu, config_.match_cpu,
+                            config_.journal_cpu, config_.publish_cpu};
+        for (size_t i = 0; i < threads_.size(); ++i) {
+            if (cpus[i] >= 0 && !pin(threads_[i], cpus[i])) ++pin_failures_;
+        }
+        running_ = true;
+    }
+
+    // Caller thread only (single producer). Waits while the ring is full.
+    void submit(const Command& cmd) {
+        if (!running_) throw std::logic_error("Pipeline::submit before start");
+        PipelineCommand item;
+        item.command = cmd;
+        item.submit_tsc = TscClock::now();
+        push(submitted_ring_, item);
+        ++submitted_;
+    }
+
+    // Drains every submitted command through all stages, then joins
+    void stop() {
+        if (!running_) return;
+        submit_done_.store(true, std::memory_order_release);
+        for (auto& thread : threads_) thread.join();
+        running_ = false;
+    }
+
+    bool running() const { return running_; }
+
+    OrderBook& book() { return book_; }
+    const OrderBook& book() const { return book_; }
+
+    // The default journal; nullptr with a journal_sink or memory_journal
+    AsyncJournal* async_journal() { return async_journal_.get(); }
+
+    // Tests: the events journaled so far. Throws std::logic_error unless
+    // config.memory_journal is set.
+    JournalWriter& journal() {
+        if (!memory_journal_) throw std::logic_error("Pipeline::journal without memory_journal");
+        return *memory_journal_;
+    }
+
+    uint64_t submitted() const { return submitted_; }
+
+    // Commands whose last event reached the subscriber; safe from any thread
+    uint64_t published() const {
+        return published_.load(std::memory_order_acquire);
+    }
+
+    // Stages whose CPU could not be set (pinning is best effort)
+    size_t pin_failures() const { return pin_failures_; }
+
+    // Per-hop latency in TSC ticks, one sample per command; live-readable
+    ProbeHistogram::Snapshot hop(PipelineHop h) const {
+        return hops_[static_cast<size_t>(h)].snapshot();
+    }
+
+    void dump(std::ostream& out) const {
+        out << "   " << std::left << std::setw(12) << "hop" << std::right
+            << std::setw(12) << "mean ns" << std::setw(12) << "p50 <=" << std::setw(12)
+            << "p99 <=" << std::setw(12) << "p99.9 <=" << std::setw(12) << "max ns" << "\n";
+        for (size_t i = 0; i < HOPS; ++i) {
+            ProbeHistogram::Snapshot s = hops_[i].snapshot();
+            out << "   " << std::left << std::setw(12) << to_string(static_cast<PipelineHop>(i))
+                << std::right << std::fixed << std::setprecision(0)
+                << std::setw(12) << TscClock::to_ns(static_cast<uint64_t>(s.mean()))
+                << std::setw(12) << TscClock::to_ns(s.percentile(50))
+                << std::setw(12) << TscClock::to_ns(s.percentile(99))
+                << std::setw(12) << TscClock::to_ns(s.percentile(99.9))
+                << std::setw(12) << TscClock::to_ns(s.max) << "\n" << std::defaultfloat;
+        }
+    }
+
+private:
+    // ========================================================================
+    // STAGES
+    // ========================================================================
+    void ingress_loop() {
+        uint64_t seq = 0;
+        drain(submitted_ring_, submit_done_, [this, &seq](PipelineCommand& item) {
+            item.seq = ++seq;
+            item.verdict = OrderBook::validate_command(instrument_, item.command);
+            item.ingress_tsc = TscClock::now();
+            push(validated_ring_, item);
+        });
+        ingress_done_.store(true, std::memory_order_release);
+    }
+
+    void match_loop() {
+        forward_events(PipelineCommand());     // Anything logged before start()
+        drain(validated_ring_, ingress_done_, [this](PipelineCommand& item) {
+            book_.process_validated(item.command, item.verdict);
+            forward_events(item);
+        });
+        match_done_.store(true, std::memory_order_release);
+    }
+
+    void journal_loop() {
+        drain(matched_ring_, match_done_, [this](PipelineEvent& item) {
+            sink_->on_event(item.event);
+            item.journal_tsc = TscClock::now();
+            push(journaled_ring_, item);
+        });
+        journal_done_.store(true, std::memory_order_release);
+    }
+
+    void publish_loop() {
+        drain(journaled_ring_, journal_done_, [this](PipelineEvent& item) {
+            if (subscriber_) subscriber_(item);
+            if (!item.last) return;
+            uint64_t now = TscClock::now();
+            record(PipelineHop::INGRESS, item.submit_tsc, item.ingress_tsc);
+            record(PipelineHop::MATCH, item.ingress_tsc, item.match_tsc);
+            record(PipelineHop::JOURNAL, item.match_tsc, item.journal_tsc);
+            record(PipelineHop::PUBLISH, item.journal_tsc, now);
+            record(PipelineHop::END_TO_END, item.submit_tsc, now);
+            published_.store(published_.load(std::memory_order_relaxed) + 1,
+                             std::memory_order_release);
+        });
+    }
+
+    // Moves what the book just logged to the journal stage
+    void forward_events(const PipelineCommand& cmd) {
+        const std::vector<Event>& log = book_.get_event_log();
+        if (log.empty()) return;
+        PipelineEvent item;
+        item.seq = cmd.seq;
+        item.submit_tsc = cmd.submit_tsc;
+        item.ingress_tsc = cmd.ingress_tsc;
+        item.match_tsc = TscClock::now();
+        for (size_t i = 0; i < log.size(); ++i) {
+            item.event = log[i];
+            item.last = cmd.seq != 0 && i + 1 == log.size();
+            push(matched_ring_, item);
+        }
+        book_.clear_event_log();
+    }
+
+    void record(PipelineHop h, uint64_t from, uint64_t to) {
+        hops_[static_cast<size_t>(h)].record(to > from ? to - from : 0);
+    }
+
+    // ========================================================================
+    // RING HELPERS
+    // ========================================================================
+    static void backoff(uint32_t& spins) {
+        if (++spins < 64) {
+#if defined(__x86_64__) || defined(__i386__)
+            _mm_pause();
+#endif
+        } else {
+            std::this_thread::yield();
+        }
+    }
+
+    template<typename T>
+    static void push(SpscRing<T>& ring, const T& item) {
+        uint32_t spins = 0;
+        while (!ring.try_push(item)) backoff(spins);
+    }
+
+    // Runs fn on every item until the upstream stage is done and the ring
+    // is empty. The done flag is checked before the final pop, so an item
+    // pushed just before the flag was set is never missed.
+    template<typename T, typename F>
+    static void drain(SpscRing<T>& ring, const std::atomic<bool>& upstream_done, F&& fn) {
+        T item;
+        uint32_t spins = 0;
+        for (;;) {
+            if (ring.try_pop(item)) {
+                fn(item);
+                spins = 0;
+            } else if (upstream_done.load(std::memory_order_acquire)) {
+                if (!ring.try_pop(item)) return;
+                fn(item);
+            } else {
+                backoff(spins);
+            }
+        }
+    }
+
+    static bool pin(std::thread& thread, int cpu) {
+#if defined(__linux__)
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        return pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set) == 0;
+#else
+        return false;
+#endif
+    }
+
+    PipelineConfig config_;
+    OrderBook book_;
+    std::unique_ptr<AsyncJournal> async_journal_;
+    std::unique_ptr<JournalWriter> memory_journal_;
+    EventSink* sink_ = nullptr;             // One of the above, or the caller's
+    Instrument instrument_;                 // Ingress copy, taken at start()
+    Subscriber subscriber_;
+
+    SpscRing<PipelineCommand> submitted_ring_;     // caller -> ingress
+    SpscRing<PipelineCommand> validated_ring_;     // ingress -> match
+    SpscRing<PipelineEvent> matched_ring_;         // match -> journal
+    SpscRing<PipelineEvent> journaled_ring_;       // journal -> publish
+
+    std::atomic<bool> submit_done_{false};
+    std::atomic<bool> ingress_done_{false};
+    std::atomic<bool> match_done_{false};
+    std::atomic<bool> journal_done_{false};
+
+    std::array<std::thread, 4> threads_;
+    std::array<ProbeHistogram, HOPS> hops_;
+    std::atomic<uint64_t> published_{0};
+    uint64_t submitted_ = 0;
+    size_t pin_failures_ = 0;
+    bool running_ = false;
+};
+
+#endif
@@ -2,40 +2,98 @@
 #define REPLAY_HPP
 
 #include "orderbook.hpp"
+#include "journal.hpp"
+#include "async_journal.hpp"
+#include <algorithm>
 #include <fstream>
 #include <sstream>
 #include <string>
 #include <vector>
 
+// ============================================================================
+// EVENT APPLIER - Re-injects logged inputs into a book, one event at a time
+// ============================================================================
+// Derived events (trades) are skipped: the book regenerates them
+// deterministically. Every input is a single event, so this works equally
+// on a whole log or on one read incrementally.
+
+class EventApplier {
+private:
+    OrderBook& book_;
+
+public:
+    explicit EventApplier(OrderBook& book) : book_(book) {}
+
+    void apply(const Event& event) {
+        std::visit([this](auto&& e) {
+            using T = std::decay_t<decltype(e)>;
+            if constexpr (std::is_same_v<T, NewOrderEvent>) {
+                book_.process_new_order(e.order_id, e.side, e.price, e.quantity, e.owner);
+            }
+            else if constexpr (std::is_same_v<T, CancelOrderEvent>) {
+                book_.process_cancel(e.order_id);
+            }
+            else if constexpr (std::is_same_v<T, ModifyOrderEvent>) {
+                book_.process_modify(e.order_id, e.price, e.quantity);
+            }
+            else if constexpr (std::is_same_v<T, MassCancelEvent>) {
+                book_.process_mass_cancel(e.filter);
+            }
+            else if constexpr (std::is_same_v<T, InstrumentEvent>) {
+                book_.set_instrument(e.instrument);
+            }
+            else if constexpr (std::is_same_v<T, QuoteEvent>) {
+                book_.process_quote(e.owner, e.ladder);
+            }
+        }, event);
+    }
+};
+
 // ============================================================================
 // REPLAY ENGINE - Determinism Verification
 // ============================================================================
 
 class ReplayEngine {
 public:
+    // Re-inject one logged input into a book
+    static void apply_event(OrderBook& book, const Event& event) {
+        EventApplier(book).apply(event);
+    }
+    
     // Replay from in-memory event log
     // Returns a reconstructed OrderBook state
-    static OrderBook replay_from_log(const std::vector<Event>& log) {
+    // Pass the recording book's fill reporting mode to reproduce its log
+    static OrderBook replay_from_log(const std::vector<Event>& log,
+                                     FillReporting mode = FillReporting::PER_FILL) {
         // Estimate capacity from log size to avoid reallocation
         OrderBook book(log.size() * 2); 
+        book.set_fill_reporting(mode);
+        EventApplier applier(book);
         
         for (const auto& event : log) {
-            std::visit([&book](auto&& e) {
-                using T = std::decay_t<decltype(e)>;
-                if constexpr (std::is_same_v<T, NewOrderEvent>) {
-                    // Replay NewOrder: Re-inject into book
-                    book.process_new_order(e.order_id, e.side, e.price, e.quantity);
-                }
-                else if constexpr (std::is_same_v<T, CancelOrderEvent>) {
-                    // Replay Cancel: Re-inject into book
-                    book.process_cancel(e.order_id);
-                }
-            }, event);
+            applier.apply(event);
         }
         
         return book;
     }
     
+    // Re-derive the market-by-order feed for a recorded session: the log is
+    // replayed into a fresh book with the encoder attached. Returns the
+    // replayed book so callers can compare it with a feed-rebuilt one.
+    static OrderBook encode_mbo_feed(const std::vector<Event>& log, MboFeedEncoder& encoder) {
+        OrderBook book(log.size() * 2);
+        book.attach_mbo_feed(&encoder);
+        EventApplier applier(book);
+        
+        for (const auto& event : log) {
+            applier.apply(event);
+        }
+        
+        encoder.flush();
+        book.attach_mbo_feed(nullptr);
+        return book;
+    }
+    
     // Save event log to CSV file
     static void save_log(const std::vector<Event>& log, const std::string& filename) {
         std::ofstream file(filename);
@@ -44,13 +102,48 @@ public:
         }
         
         char buffer[256];
+        std::vector<char> quote_buffer;
         for (const auto& event : log) {
-            // Use our zero-alloc to_buffer helper
+            // Use our zero-alloc to_buffer helper; only quotes can outgrow it
+            if (const auto* quote = std::get_if<QuoteEvent>(&event)) {
+                quote_buffer.resize(std::max(quote_buffer.size(), quote->csv_bytes()));
+                quote->to_buffer(quote_buffer.data(), quote_buffer.size());
+                file << quote_buffer.data() << "\n";
+                continue;
+            }
             event_to_buffer(event, buffer, sizeof(buffer));
             file << buffer << "\n";
         }
     }
     
+    // Save event log as a block-compressed binary journal
+    static void save_journal(const std::vector<Event>& log, const std::string& filename,
+                             size_t block_events = JOURNAL_DEFAULT_BLOCK_EVENTS) {
+        JournalWriter writer(block_events);
+        writer.append(log);
+        writer.save(filename);
+    }
+    
+    // Load events from a binary journal
+    static std::vector<Event> load_journal(const std::string& filename) {
+        JournalReader reader = JournalReader::open(filename);
+        std::vector<Event> log;
+        if (!reader.read_all(log)) {
+            throw std::runtime_error("Corrupt journal block in " + filename);
+        }
+        return log;
+    }
+    
+    // Load events of a segmented async journal, from sequence `from` on
+    static std::vector<Event> load_segments(const std::string& directory, uint64_t from = 1) {
+        JournalSegments segments = JournalSegments::open(directory);
+        std::vector<Event> log;
+        if (!segments.read_from(from, log)) {
+            throw std::runtime_error("Corrupt journal segment in " + directory);
+        }
+        return log;
+    }
+    
     // Load events from CSV file
     static std::vector<Event> load_log(const std::string& filename) {
         std::ifstream file(filename);
@@ -78,14 +171,15 @@ public:
             const std::string& type = parts[0];
             
             if (type == "NEW_ORDER" && parts.size() >= 6) {
-                // Format: NEW_ORDER,timestamp,id,side,price,qty
+                // Format: NEW_ORDER,timestamp,id,side,price,qty[,owner]
                 Timestamp ts(std::stoull(parts[1]));
                 OrderId id(std::stoull(parts[2]));
                 Side side = (parts[3] == "BUY") ? Side::BUY : Side::SELL;
                 Price price(std::stoll(parts[4]));
                 Quantity qty(std::stoull(parts[5]));
+                OwnerId owner(parts.size() >= 7 ? static_cast<uint32_t>(std::stoul(parts[6])) : 0);
                 
-                log.emplace_back(std::in_place_type<NewOrderEvent>, ts, id, side, price, qty);
+                log.emplace_back(std::in_place_type<NewOrderEvent>, ts, id, side, price, qty, owner);
             }
             else if (type == "CANCEL_ORDER" && parts.size() >= 3) {
                 // Format: CANCEL_ORDER,timestamp,id
@@ -94,6 +188,55 @@ public:
                 
                 log.emplace_back(std::in_place_type<CancelOrderEvent>, ts, id);
             }
+            else if (type == "MODIFY_ORDER" && parts.size() >= 5) {
+                // Format: MODIFY_ORDER,timestamp,id,price,qty
+                Timestamp ts(std::stoull(parts[1]));
+                OrderId id(std::stoull(parts[2]));
+                Price price(std::stoll(parts[3]));
+                Quantity qty(std::stoull(parts[4]));
+                
+                log.emplace_back(std::in_place_type<ModifyOrderEvent>, ts, id, price, qty);
+            }
+            else if (type == "MASS_CANCEL" && parts.size() >= 6) {
+                // Format: MASS_CANCEL,timestamp,sides,owner,min_price,max_price
+                Timestamp ts(std::stoull(parts[1]));
+                MassCancelFilter filter;
+                filter.sides = static_cast<uint8_t>(std::stoul(parts[2]));
+                filter.owner = OwnerId(static_cast<uint32_t>(std::stoul(parts[3])));
+                filter.min_price = Price(std::stoll(parts[4]));
+                filter.max_price = Price(std::stoll(parts[5]));
+                
+                log.emplace_back(std::in_place_type<MassCancelEvent>, ts, filter);
+            }
+            else if (type == "INSTRUMENT" && parts.size() >= 7) {
+                // Format: INSTRUMENT,timestamp,tick,lot,base,min_price,max_price
+                Timestamp ts(std::stoull(parts[1]));
+                Instrument inst;
+                inst.tick_size = Price(std::stoll(parts[2]));
+                inst.lot_size = Quantity(std::stoull(parts[3]));
+                inst.base_price = Price(std::stoll(parts[4]));
+                inst.min_price = Price(std::stoll(parts[5]));
+                inst.max_price = Price(std::stoll(parts[6]));
+                
+                log.emplace_back(std::in_place_type<InstrumentEvent>, ts, inst);
+            }
+            else if (type == "QUOTE" && parts.size() >= 5) {
+                // Format: QUOTE,timestamp,owner,bid_count,ask_count{,id,price,qty}
+                Timestamp ts(std::stoull(parts[1]));
+                OwnerId owner(static_cast<uint32_t>(std::stoul(parts[2])));
+                size_t bids = std::stoul(parts[3]);
+                size_t asks = std::stoul(parts[4]);
+                if (parts.size() != 5 + 3 * (bids + asks)) continue;  // Truncated line
+                
+                auto ladder = std::make_shared<QuoteLadder>();
+                ladder->bid_count = static_cast<uint32_t>(bids);
+                for (size_t i = 5; i < parts.size(); i += 3) {
+                    ladder->rungs.push_back({OrderId(std::stoull(parts[i])),
+                                             Price(std::stoll(parts[i + 1])),
+                                             Quantity(std::stoull(parts[i + 2]))});
+                }
+                log.emplace_back(std::in_place_type<QuoteEvent>, ts, owner, std::move(ladder));
+            }
         }
         
         return log;
@@ -0,0 +1,304 @@
+#ifndef REPLICA_HPP
+#define REPLICA_HPP
+
+#include "orderbook.hpp"
+#include "replay.hpp"
+#include "async_journal.hpp"
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <stdexcept>
+#include <cerrno>
+#include <cstdint>
+#include <cstddef>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#endif
+
+#if defined(__linux__)
+#include <poll.h>
+#include <sys/inotify.h>
+#endif
+
+// ============================================================================
+// JOURNAL REPLICA - Read-only book rebuilt by tailing a live async journal
+// ============================================================================
+//
+// Follows the file (or segment directory) an AsyncJournal is writing, from
+// this process or another, and applies every record in sequence order to
+// its own OrderBook through an EventApplier: ReplayEngine semantics, one
+// record at a time. The matching thread does no extra work; the replica
+// reads what the journal writer thread has already handed to the kernel.
+//
+// The journal carries inputs only, so the replica's book must be built in
+// the fill reporting mode the primary used; it is fixed at construction.
+// A segment directory whose oldest segments were archived does not start
+// at sequence 1: the replica then needs a base book holding the state
+// after some event the remaining segments still cover, or poll() throws.
+//
+// poll() applies every complete, valid record that appeared since the last
+// call, reading at most max_read_bytes at a time unless a single record is
+// longer. A record still being written fails its length or CRC check and is
+// picked up by a later poll. A segment is left once the writer has created
+// the one after it. wait() blocks until the journal directory changes
+// (inotify on Linux, a plain sleep elsewhere). Run both on the replica's
+// own thread and query book() between polls.
+//
+// The replica sees written, not durable, data: after a crash of the writer
+// machine, recovery can truncate records the replica already applied.
+// Replication lag is measured at each poll that applies something:
+//   events  how far behind the replica was when the poll started
+//   ns      wall time from the writer sealing the oldest of those records
+//           to the replica finishing the poll
+// lag_events(journal) gives the exact backlog against an in-process writer.
+
+struct ReplicaLag {
+    uint64_t events = 0;
+    uint64_t ns = 0;
+};
+
+class JournalReplica {
+public:
+    // `path` is the journal file, or the directory of a segmented journal.
+    // Neither needs to exist yet. Throws std::runtime_error later, from
+    // poll(), if it turns out not to be an async journal or its history
+    // does not start at sequence 1.
+    explicit JournalReplica(const std::string& path, size_t book_capacity = 1000000,
+                            FillReporting mode = FillReporting::PER_FILL,
+                            size_t max_read_bytes = 16 << 20)
+        : JournalReplica(path, make_book(book_capacity, mode), 0, max_read_bytes) {}
+
+    // Starts from `base`, the primary's book as of journal event `base_seq`
+    // (e.g. replayed from the archived segments), in the primary's fill
+    // reporting mode. Events up to base_seq are skipped; poll() throws if
+    // the journal no longer holds base_seq + 1.
+    JournalReplica(const std::string& path, OrderBook base, uint64_t base_seq,
+                   size_t max_read_bytes = 16 << 20)
+        : path_(path), book_(std::move(base)), applier_(book_),
+          max_read_bytes_(std::max<size_t>(max_read_bytes, 64 * 1024)),
+          base_seq_(base_seq), applied_(base_seq) {
+        namespace fs = std::filesystem;
+        segmented_ = fs::is_directory(path_);
+#if defined(__linux__)
+        std::string watched = segmented_ ? path_ : fs::path(path_).parent_path().string();
+        if (watched.empty()) watched = ".";
+        inotify_fd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (inotify_fd_ >= 0 &&
+            inotify_add_watch(inotify_fd_, watched.c_str(), IN_MODIFY | IN_CREATE | IN_MOVED_TO) < 0) {
+            ::close(inotify_fd_);
+            inotify_fd_ = -1;
+        }
+#endif
+    }
+
+    ~JournalReplica() {
+        if (fd_ >= 0) ::close(fd_);
+        if (inotify_fd_ >= 0) ::close(inotify_fd_);
+    }
+
+    JournalReplica(const JournalReplica&) = delete;
+    JournalReplica& operator=(const JournalReplica&) = delete;
+
+    // Applies what has been written since the last call. The book's event
+    // log then holds exactly what this poll generated, trades included.
+    // Returns the number of journal events applied.
+    size_t poll() {
+        book_.clear_event_log();
+        const uint64_t start = applied_;
+        uint64_t oldest_wall_ns = 0;
+        for (;;) {
+            if (!open_current()) break;
+            struct stat st;
+            if (::fstat(fd_, &st) != 0) break;
+            const uint64_t size = static_cast<uint64_t>(st.st_size);
+            if (size < offset_) {
+                throw std::runtime_error("Journal truncated under the replica: " + current_);
+            }
+            size_t n = static_cast<size_t>(std::min<uint64_t>(size - offset_, max_read_bytes_));
+            if (!read_at(offset_, n)) break;
+            // A record longer than the window (a long quote ladder) is read
+            // whole, once all of it is there
+            if (n >= ASYNC_JOURNAL_RECORD_HEADER_SIZE) {
+                const uint64_t record = ASYNC_JOURNAL_RECORD_HEADER_SIZE + journal::get_u32(buffer_.data());
+                if (record > n && journal::get_u64(buffer_.data() + 8) == read_ + 1 &&
+                    size - offset_ >= record) {
+                    n = static_cast<size_t>(record);
+                    if (!read_at(offset_, n)) break;
+                }
+            }
+
+            AsyncJournalScan scan = async_journal::scan_records(
+                buffer_.data(), n, offset_, read_ + 1, 0,
+                [this, &oldest_wall_ns](const async_journal::RecordView& r) {
+                    for (size_t k = 0; k < r.events.size(); ++k) {
+                        if (r.first_seq + k <= base_seq_) continue;   // In the base
+                        if (oldest_wall_ns == 0) oldest_wall_ns = r.wall_ns;
+                        applier_.apply(r.events[k]);
+                    }
+                    return true;
+                });
+            offset_ = scan.valid_bytes;
+            read_ = scan.last_seq;
+            applied_ = std::max(read_, base_seq_);
+            if (n >= max_read_bytes_ && scan.records > 0) continue;   // More to read
+
+            // Move on once the writer has started the next segment; its
+            // name is the sequence number that follows the last read
+            if (!segmented_) break;
+            const std::string next = async_journal::segment_path(path_, read_ + 1);
+            if (next == current_ || !std::filesystem::exists(next)) break;
+            ::close(fd_);
+            fd_ = -1;
+            current_ = next;
+        }
+
+        if (applied_ > start) {
+            lag_.events = applied_ - start;
+            const uint64_t now = wall_ns();
+            lag_.ns = now > oldest_wall_ns ? now - oldest_wall_ns : 0;
+            max_lag_.events = std::max(max_lag_.events, lag_.events);
+            max_lag_.ns = std::max(max_lag_.ns, lag_.ns);
+        }
+        return static_cast<size_t>(applied_ - start);
+    }
+
+    // Blocks until the journal may have changed or the timeout passes.
+    // True if a change was signalled.
+    bool wait(std::chrono::milliseconds timeout) {
+#if defined(__linux__)
+        if (inotify_fd_ >= 0) {
+            pollfd p{inotify_fd_, POLLIN, 0};
+            if (::poll(&p, 1, static_cast<int>(timeout.count())) <= 0) return false;
+            char events[4096];
+            while (::read(inotify_fd_, events, sizeof(events)) > 0) {}
+            return true;
+        }
+#endif
+        std::this_thread::sleep_for(timeout);
+        return false;
+    }
+
+    // Attach streams before the first poll; the fill reporting mode is the
+    // one given at construction and must not change
+    OrderBook& book() { return book_; }
+    const OrderBook& book() const { return book_; }
+
+    // Sequence number of the last applied journal event
+    uint64_t applied() const { return applied_; }
+
+    // Of the last poll that applied anything, and the worst so far
+    ReplicaLag lag() const { return lag_; }
+    ReplicaLag max_lag() const { return max_lag_; }
+
+    // Exact backlog against a writer in the same process
+    uint64_t lag_events(const AsyncJournal& journal) const {
+        const uint64_t appended = journal.appended();
+        return appended > applied_ ? appended - applied_ : 0;
+    }
+
+    bool segmented() const { return segmented_; }
+
+private:
+    // Opens the file being followed and checks its header. False while it
+    // does not exist or the writer has not finished the header yet.
+    bool open_current() {
+        if (fd_ >= 0) return true;
+        if (!segmented_ && std::filesystem::is_directory(path_)) segmented_ = true;
+        const std::string path = !current_.empty() ? current_ : segmented_ ? first_segment() : path_;
+        if (path.empty()) return false;
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) return false;
+        const size_t header_bytes = segmented_ ? ASYNC_JOURNAL_SEGMENT_HEADER_SIZE
+                                               : ASYNC_JOURNAL_HEADER_SIZE;
+        uint8_t header[ASYNC_JOURNAL_SEGMENT_HEADER_SIZE];
+        if (::pread(fd, header, header_bytes, 0) != static_cast<ssize_t>(header_bytes)) {
+            ::close(fd);
+            return false;
+        }
+        const uint16_t flags = segmented_ ? ASYNC_JOURNAL_SEGMENT_FLAG : 0;
+        if (!async_journal::check_file_header(header, header_bytes, flags)) {
+            ::close(fd);
+            throw std::runtime_error("Not an async journal: " + path);
+        }
+        if (segmented_) {
+            const uint64_t first_seq = journal::get_u64(header + 8);
+            if (current_.empty()) {
+                // Oldest segment: the base must reach it, or the archived
+                // events before it would be silently missing from the book
+                if (first_seq > base_seq_ + 1) {
+                    ::close(fd);
+                    throw std::runtime_error("Journal starts at sequence " + std::to_string(first_seq) +
+                                             ", after the replica's base: " + path);
+                }
+                read_ = first_seq - 1;
+            } else if (first_seq != read_ + 1) {
+                ::close(fd);
+                throw std::runtime_error("Journal segment out of sequence: " + path);
+            }
+        }
+        current_ = path;
+        fd_ = fd;
+        offset_ = header_bytes;
+        return true;
+    }
+
+    static OrderBook make_book(size_t capacity, FillReporting mode) {
+        OrderBook book(capacity);
+        book.set_fill_reporting(mode);
+        return book;
+    }
+
+    std::string first_segment() const {
+        std::string first;
+        if (!std::filesystem::is_directory(path_)) return first;
+        for (const auto& entry : std::filesystem::directory_iterator(path_)) {
+            const std::string p = entry.path().string();
+            if (entry.path().extension() == ".seg" && (first.empty() || p < first)) first = p;
+        }
+        return first;
+    }
+
+    bool read_at(uint64_t offset, size_t n) {
+        if (buffer_.size() < n) buffer_.resize(n);
+        size_t done = 0;
+        while (done < n) {
+            ssize_t r = ::pread(fd_, buffer_.data() + done, n - done,
+                                static_cast<off_t>(offset + done));
+            if (r < 0 && errno == EINTR) continue;
+            if (r <= 0) return false;
+            done += static_cast<size_t>(r);
+        }
+        return true;
+    }
+
+    static uint64_t wall_ns() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count());
+    }
+
+    std::string path_;
+    bool segmented_ = false;
+    OrderBook book_;
+    EventApplier applier_;
+    size_t max_read_bytes_;
+    std::vector<uint8_t> buffer_;
+
+    std::string current_;           // File being read
+    int fd_ = -1;
+    uint64_t offset_ = 0;           // End of the last applied record
+    uint64_t base_seq_ = 0;         // Last event already in the base book
+    uint64_t applied_ = 0;
+    uint64_t read_ = 0;             // Last event read from the journal
+    ReplicaLag lag_;
+    ReplicaLag max_lag_;
+    int inotify_fd_ = -1;
+};
+
+#endif
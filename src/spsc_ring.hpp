@@ -0,0 +1,74 @@
+#ifndef SPSC_RING_HPP
+#define SPSC_RING_HPP
+
+#include <atomic>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+
+// ============================================================================
+// SPSC RING - Bounded lock-free single-producer / single-consumer queue
+// ============================================================================
+//
+// Head and tail live on separate cache lines, and each side keeps a private
+// copy of the other's index, so the shared line is only read when the
+// cached view says full (producer) or empty (consumer). Unlike
+// ExecutionRing nothing is ever overwritten: a full ring makes try_push
+// fail and the producer waits.
+
+template<typename T>
+class SpscRing {
+public:
+    // capacity is rounded up to a power of two
+    explicit SpscRing(size_t capacity) {
+        size_t n = 1;
+        while (n < capacity) n <<= 1;
+        mask_ = n - 1;
+        slots_.reset(new T[n]);
+    }
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    // Producer only
+    bool try_push(const T& item) {
+        uint64_t head = head_.load(std::memory_order_relaxed);
+        if (head - cached_tail_ > mask_) {
+            cached_tail_ = tail_.load(std::memory_order_acquire);
+            if (head - cached_tail_ > mask_) return false;
+        }
+        slots_[head & mask_] = item;
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer only
+    bool try_pop(T& out) {
+        uint64_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail == cached_head_) {
+            cached_head_ = head_.load(std::memory_order_acquire);
+            if (tail == cached_head_) return false;
+        }
+        out = slots_[tail & mask_];
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    size_t capacity() const { return mask_ + 1; }
+
+    // Approximate when called off the producer and consumer threads
+    size_t size() const {
+        return static_cast<size_t>(head_.load(std::memory_order_acquire) -
+                                   tail_.load(std::memory_order_acquire));
+    }
+
+private:
+    std::unique_ptr<T[]> slots_;
+    size_t mask_ = 0;
+    alignas(64) std::atomic<uint64_t> head_{0};     // Next slot to write
+    uint64_t cached_tail_ = 0;                      // Producer's view of tail_
+    alignas(64) std::atomic<uint64_t> tail_{0};     // Next slot to read
+    uint64_t cached_head_ = 0;                      // Consumer's view of head_
+};
+
+#endif
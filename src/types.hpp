@@ -46,12 +46,15 @@ struct OrderIdTag {};
 struct PriceTag {};
 struct QuantityTag {};
 struct TimestampTag {};
+struct OwnerIdTag {};
 
 // Strong type aliases
 using OrderId = StrongType<uint64_t, OrderIdTag>;
 using Price = StrongType<int64_t, PriceTag>;
 using Quantity = StrongType<uint64_t, QuantityTag>;
 using Timestamp = StrongType<uint64_t, TimestampTag>;
+using OwnerId = StrongType<uint32_t, OwnerIdTag>;   // Session/firm tag, 0 = none,
+                                                    // UINT32_MAX reserved (any owner)
 
 // Price scaling factor
 constexpr int64_t PRICE_SCALE = 10000;
@@ -45,6 +45,7 @@ FAILED=0
 run_test "Demo Integration" "./matching_engine_demo" || ((FAILED++))
 run_test "Unit Tests"       "./matching_engine_unit_tests" || ((FAILED++))
 run_test "Property Tests"   "./matching_engine_property_tests" || ((FAILED++))
+run_test "Allocation Tests" "./matching_engine_alloc_tests" || ((FAILED++))
 
 if [[ "${1:-}" != "--quick" ]]; then
     run_test "Benchmarks" "./matching_engine_benchmarks" || ((FAILED++))
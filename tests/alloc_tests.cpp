@@ -0,0 +1,320 @@
+#include "../src/orderbook.hpp"
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <vector>
+#include <atomic>
+#include <memory>
+#include <functional>
+#include <new>
+#include <cstdlib>
+#include <cstring>
+
+// ============================================================================
+// ALLOCATION TRACKING - Global operator new / malloc interposition
+// ============================================================================
+//
+// Every heap allocation in the process is counted: operator new in all its
+// forms, and on glibc the C allocator entry points too (they forward to
+// glibc's internal __libc_* functions). operator new goes straight to those,
+// so a `new` is counted once rather than again by the malloc it would make.
+// Elsewhere only operator new is tracked. Frees are not counted.
+
+namespace alloc_tracking {
+
+std::atomic<uint64_t> calls{0};
+std::atomic<uint64_t> bytes{0};
+
+inline void note(size_t n) {
+    calls.fetch_add(1, std::memory_order_relaxed);
+    bytes.fetch_add(n, std::memory_order_relaxed);
+}
+
+}  // namespace alloc_tracking
+
+#if defined(__GLIBC__)
+extern "C" {
+void* __libc_malloc(size_t);
+void* __libc_calloc(size_t, size_t);
+void* __libc_realloc(void*, size_t);
+void* __libc_memalign(size_t, size_t);
+
+void* malloc(size_t n) {
+    alloc_tracking::note(n);
+    return __libc_malloc(n);
+}
+
+void* calloc(size_t count, size_t n) {
+    alloc_tracking::note(count * n);
+    return __libc_calloc(count, n);
+}
+
+void* realloc(void* p, size_t n) {
+    alloc_tracking::note(n);
+    return __libc_realloc(p, n);
+}
+
+void* aligned_alloc(size_t align, size_t n) {
+    alloc_tracking::note(n);
+    return __libc_memalign(align, n);
+}
+
+void* memalign(size_t align, size_t n) {
+    alloc_tracking::note(n);
+    return __libc_memalign(align, n);
+}
+
+int posix_memalign(void** out, size_t align, size_t n) {
+    alloc_tracking::note(n);
+    void* p = __libc_memalign(align, n);
+    if (!p) return ENOMEM;
+    *out = p;
+    return 0;
+}
+}
+
+static void* raw_alloc(size_t n, size_t align) {
+    return align <= alignof(std::max_align_t) ? __libc_malloc(n ? n : 1)
+                                              : __libc_memalign(align, n ? n : 1);
+}
+#else
+static void* raw_alloc(size_t n, size_t align) {
+    if (align <= alignof(std::max_align_t)) return std::malloc(n ? n : 1);
+    return std::aligned_alloc(align, (n + align - 1) / align * align);
+}
+#endif
+
+static void* tracked_new(size_t n, size_t align = alignof(std::max_align_t)) {
+    alloc_tracking::note(n);
+    void* p = raw_alloc(n, align);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+static void* tracked_new_nothrow(size_t n, size_t align = alignof(std::max_align_t)) noexcept {
+    alloc_tracking::note(n);
+    return raw_alloc(n, align);
+}
+
+void* operator new(size_t n) { return tracked_new(n); }
+void* operator new[](size_t n) { return tracked_new(n); }
+void* operator new(size_t n, const std::nothrow_t&) noexcept { return tracked_new_nothrow(n); }
+void* operator new[](size_t n, const std::nothrow_t&) noexcept { return tracked_new_nothrow(n); }
+void* operator new(size_t n, std::align_val_t a) { return tracked_new(n, static_cast<size_t>(a)); }
+void* operator new[](size_t n, std::align_val_t a) { return tracked_new(n, static_cast<size_t>(a)); }
+void* operator new(size_t n, std::align_val_t a, const std::nothrow_t&) noexcept {
+    return tracked_new_nothrow(n, static_cast<size_t>(a));
+}
+void* operator new[](size_t n, std::align_val_t a, const std::nothrow_t&) noexcept {
+    return tracked_new_nothrow(n, static_cast<size_t>(a));
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept { std::free(p); }
+
+// ============================================================================
+// HOT PATH ALLOCATION BUDGETS
+// ============================================================================
+//
+// Each scenario warms a book up, then counts allocations across N commands.
+// The budgets pin today's profile: a rise fails the run, and a scenario
+// that improves should have its budget tightened to match.
+//   - Orders that never rest, cancels and in-place amends allocate nothing
+//     (stack-resident aggressor, pre-reserved event log and pool)
+//   - A resting order costs one order_index_ node
+//   - A resting order that opens a price level also costs a std::map node
+// The counts are deterministic, so budgets sit just above the measured rate.
+
+class AllocationTests {
+public:
+    int run_all() {
+        std::cout << "\n   " << std::left << std::setw(30) << "scenario" << std::right
+                  << std::setw(12) << "allocs/cmd" << std::setw(12) << "bytes/cmd"
+                  << std::setw(10) << "budget" << "\n";
+
+        check("cross, never rests", 0.0, [](OrderBook& book, int n) {
+            rest_ladder(book, Side::SELL, 100, 1000, 1000000);
+            return [&book, n] {
+                for (int i = 0; i < n; ++i) {
+                    book.process_new_order(OrderId(2000000 + i), Side::BUY, price(200), Quantity(3));
+                }
+            };
+        });
+
+        check("cancel", 0.0, [](OrderBook& book, int n) {
+            rest_ladder(book, Side::SELL, 100, n, 1);
+            return [&book, n] {
+                for (int i = 0; i < n; ++i) book.process_cancel(OrderId(1 + i));
+            };
+        });
+
+        check("modify, size down in place", 0.0, [](OrderBook& book, int n) {
+            rest_ladder(book, Side::BUY, 100, n, 1);
+            return [&book, n] {
+                for (int i = 0; i < n; ++i) {
+                    book.process_modify(OrderId(1 + i), price(100 - i % 100), Quantity(5));
+                }
+            };
+        });
+
+        check("rest at existing level", 1.0, [](OrderBook& book, int n) {
+            rest_ladder(book, Side::BUY, 100, 1000, 1);
+            return [&book, n] {
+                for (int i = 0; i < n; ++i) {
+                    book.process_new_order(OrderId(1000000 + i), Side::BUY, price(100 - i % 100),
+                                           Quantity(10));
+                }
+            };
+        });
+
+        check("rest opening a new level", 2.0, [](OrderBook& book, int n) {
+            return [&book, n] {
+                for (int i = 0; i < n; ++i) {
+                    book.process_new_order(OrderId(1 + i), Side::SELL, price(101 + i), Quantity(10));
+                }
+            };
+        });
+
+        check("mixed add/cross/cancel flow", 0.65, [](OrderBook& book, int n) {
+            auto cmds = std::make_shared<std::vector<Command>>(mixed_flow(n * 2));
+            book.process_batch(cmds->data(), n);  // Warm-up half
+            return [&book, cmds, n] { book.process_batch(cmds->data() + n, n); };
+        });
+
+        // 20 rungs at unchanged prices; 2 in 3 grow and re-queue, and a
+        // re-queued sole order drops and re-creates its level. The log is
+        // drained after each quote, as a pipeline's match stage does, so the
+        // logged ladder is recycled.
+        check("20-rung quote refresh", 13.34, [](OrderBook& book, int n) {
+            return quote_refresh(book, n, [](int r, int i) {
+                return Quantity(10 + static_cast<uint64_t>((r + i) % 3));
+            });
+        });
+
+        check("20-rung quote, size down", 0.0, [](OrderBook& book, int n) {
+            return quote_refresh(book, n, [](int r, int) {
+                return Quantity(1000000 - static_cast<uint64_t>(r));
+            });
+        });
+
+        if (failures_ == 0) {
+            std::cout << "\n✅ All allocation budgets met!\n";
+            return 0;
+        }
+        std::cout << "\n❌ " << failures_ << " allocation budget(s) exceeded\n";
+        return 1;
+    }
+
+private:
+    static constexpr int COMMANDS = 20000;
+    int failures_ = 0;
+
+    static Price price(int64_t whole) { return Price(whole * PRICE_SCALE); }
+
+    // A quote scenario: owner 7 refreshes 10 bids below and 10 asks above
+    // 100, rung i of refresh r sized qty(r, i). The warm-up cycles the
+    // book's ladder pool; the body issues n more refreshes.
+    template<typename Qty>
+    static std::function<void()> quote_refresh(OrderBook& book, int n, Qty qty) {
+        auto bids = std::make_shared<std::vector<QuoteEntry>>();
+        auto asks = std::make_shared<std::vector<QuoteEntry>>();
+        bids->reserve(10);
+        asks->reserve(10);
+        auto refresh = [&book, bids, asks, qty](int r) {
+            bids->clear();
+            asks->clear();
+            for (int i = 0; i < 10; ++i) {
+                uint64_t id = static_cast<uint64_t>(r) * 20 + i * 2 + 1;
+                bids->push_back({OrderId(id), price(99 - i), qty(r, i)});
+                asks->push_back({OrderId(id + 1), price(101 + i), qty(r, i)});
+            }
+            book.process_quote(OwnerId(7), bids->data(), 10, asks->data(), 10);
+            book.clear_event_log();
+        };
+        constexpr int WARM_UP = 100;
+        for (int r = 0; r < WARM_UP; ++r) refresh(r);
+        return [refresh, n] {
+            for (int r = WARM_UP; r < n + WARM_UP; ++r) refresh(r);
+        };
+    }
+
+    // `count` orders of `qty` spread over `levels` prices below (BUY) or above
+    // (SELL) 100, ids from 1
+    static void rest_ladder(OrderBook& book, Side side, int levels, int count, uint64_t qty) {
+        for (int i = 0; i < count; ++i) {
+            int64_t offset = i % levels;
+            book.process_new_order(OrderId(1 + i), side,
+                                   price(side == Side::BUY ? 100 - offset : 100 + offset),
+                                   Quantity(qty));
+        }
+    }
+
+    static std::vector<Command> mixed_flow(int n) {
+        std::vector<Command> cmds;
+        cmds.reserve(n);
+        std::mt19937_64 rng(3);
+        for (int i = 0; i < n; ++i) {
+            uint64_t id = static_cast<uint64_t>(i) + 1;
+            if (i > 100 && rng() % 3 == 0) {
+                cmds.push_back(Command::cancel(OrderId(id - 1 - rng() % 100)));
+            } else {
+                Side side = (rng() & 1) ? Side::BUY : Side::SELL;
+                int64_t offset = static_cast<int64_t>(rng() % 20) - 2;
+                int64_t p = 100 * PRICE_SCALE + (side == Side::BUY ? -offset : offset) * (PRICE_SCALE / 100);
+                cmds.push_back(Command::new_order(OrderId(id), side, Price(p),
+                                                  Quantity(1 + rng() % 100)));
+            }
+        }
+        return cmds;
+    }
+
+    // `setup` warms the book and returns the measured body, which issues
+    // COMMANDS commands
+    template<typename Setup>
+    void check(const char* name, double budget, Setup&& setup) {
+        OrderBook book(4 * COMMANDS + 1000000);
+        auto body = setup(book, COMMANDS);
+
+        uint64_t calls_before = alloc_tracking::calls.load();
+        uint64_t bytes_before = alloc_tracking::bytes.load();
+        body();
+        double calls = static_cast<double>(alloc_tracking::calls.load() - calls_before) / COMMANDS;
+        double bytes = static_cast<double>(alloc_tracking::bytes.load() - bytes_before) / COMMANDS;
+
+        bool ok = calls <= budget;
+        if (!ok) ++failures_;
+        std::cout << (ok ? "✅ " : "❌ ") << std::left << std::setw(30) << name << std::right
+                  << std::fixed << std::setprecision(3) << std::setw(12) << calls
+                  << std::setprecision(1) << std::setw(12) << bytes
+                  << std::setprecision(2) << std::setw(10) << budget << "\n"
+                  << std::defaultfloat;
+    }
+};
+
+// ============================================================================
+// MAIN
+// ============================================================================
+
+int main() {
+    std::cout << "╔════════════════════════════════════════════════════════════╗\n";
+    std::cout << "║           HOT PATH ALLOCATION TESTS                        ║\n";
+    std::cout << "╚════════════════════════════════════════════════════════════╝\n";
+
+    try {
+        AllocationTests tests;
+        return tests.run_all();
+    } catch (const std::exception& e) {
+        std::cerr << "Test failed with exception: " << e.what() << "\n";
+        return 1;
+    }
+}
@@ -6,6 +6,9 @@
 #include <variant>
 #include <vector>
 #include <algorithm> // For std::min
+#include <map>
+#include <tuple>
+#include <cstring>
 
 // ============================================================================
 // CUSTOM ASSERTION MACRO
@@ -52,6 +55,33 @@ private:
         };
     }
     
+    static bool logs_equal(const std::vector<Event>& a, const std::vector<Event>& b) {
+        if (a.size() != b.size()) return false;
+        char buf_a[256], buf_b[256];
+        for (size_t i = 0; i < a.size(); ++i) {
+            event_to_buffer(a[i], buf_a, sizeof(buf_a));
+            event_to_buffer(b[i], buf_b, sizeof(buf_b));
+            if (std::strcmp(buf_a, buf_b) != 0) return false;
+        }
+        return true;
+    }
+    
+    // Same resting orders, in the same FIFO position, on both sides
+    static bool books_equal(const OrderBook& a, const OrderBook& b) {
+        if (a.order_count() != b.order_count()) return false;
+        for (Side side : {Side::BUY, Side::SELL}) {
+            std::vector<std::tuple<uint64_t, int64_t, uint64_t>> orders_a, orders_b;
+            a.for_each_order(side, [&orders_a](const Order& o) {
+                orders_a.emplace_back(o.id.get(), o.price.get(), o.remaining_qty.get());
+            });
+            b.for_each_order(side, [&orders_b](const Order& o) {
+                orders_b.emplace_back(o.id.get(), o.price.get(), o.remaining_qty.get());
+            });
+            if (orders_a != orders_b) return false;
+        }
+        return true;
+    }
+    
 public:
     // Property 1: The Order Book Non-Crossing Principle
     void test_never_crosses() {
@@ -216,6 +246,368 @@ public:
         std::cout << "   ✓ Price spread remains non-negative\n";
     }
     
+    // Property 6: Depth cache and level deltas agree with each other
+    void test_depth_consistency() {
+        std::cout << "\n🔬 Property Test 6: Depth Cache / Delta Consistency\n";
+        
+        for (int trial = 0; trial < 50; ++trial) {
+            OrderBook book(2000);
+            book.set_depth_levels(5);
+            book.enable_level_deltas(true, 4096);
+            
+            // Shadow L2 book rebuilt purely from the delta stream
+            std::map<int64_t, std::pair<uint64_t, size_t>, std::greater<int64_t>> bids;
+            std::map<int64_t, std::pair<uint64_t, size_t>> asks;
+            size_t applied = 0;
+            std::uniform_int_distribution<> action_dist(0, 3);
+            
+            for (uint64_t i = 0; i < 200; ++i) {
+                uint64_t id = trial * 1000 + i + 1;
+                if (i > 10 && action_dist(rng) == 0) {
+                    book.process_cancel(OrderId(id - 10));
+                } else {
+                    auto order = generate_random_order(id);
+                    book.process_new_order(order.id, order.side, order.price, order.quantity);
+                }
+                
+                const auto& deltas = book.get_level_deltas();
+                for (; applied < deltas.size(); ++applied) {
+                    const LevelDelta& d = deltas[applied];
+                    auto apply = [&d](auto& side) {
+                        if (d.action == DeltaAction::DELETE) {
+                            TEST_ASSERT(side.erase(d.price.get()) == 1);
+                        } else {
+                            TEST_ASSERT((d.action == DeltaAction::NEW) ==
+                                        (side.count(d.price.get()) == 0));
+                            side[d.price.get()] = {d.total_volume.get(), d.order_count};
+                        }
+                    };
+                    if (d.side == Side::BUY) apply(bids);
+                    else apply(asks);
+                }
+                
+                auto check = [](const std::vector<DepthLevel>& depth, const auto& shadow) {
+                    TEST_ASSERT(depth.size() == std::min<size_t>(5, shadow.size()));
+                    auto it = shadow.begin();
+                    for (const auto& level : depth) {
+                        TEST_ASSERT(level.price.get() == it->first);
+                        TEST_ASSERT(level.total_volume.get() == it->second.first);
+                        TEST_ASSERT(level.order_count == it->second.second);
+                        ++it;
+                    }
+                };
+                check(book.get_depth(Side::BUY), bids);
+                check(book.get_depth(Side::SELL), asks);
+            }
+        }
+        
+        std::cout << "   ✓ Cached top-N matches delta-reconstructed book\n";
+    }
+    
+    // Property 7: L3 feed round trip rebuilds the exact source book
+    void test_mbo_feed_round_trip() {
+        std::cout << "\n🔬 Property Test 7: MBO Feed Round Trip\n";
+        
+        for (int trial = 0; trial < 30; ++trial) {
+            OrderBook book(4000);
+            MboFeedEncoder live(512);
+            book.attach_mbo_feed(&live);
+            std::uniform_int_distribution<> action_dist(0, 3);
+            
+            for (uint64_t i = 0; i < 500; ++i) {
+                uint64_t id = trial * 1000 + i + 1;
+                if (i > 20 && action_dist(rng) == 0) {
+                    book.process_cancel(OrderId(id - 20));
+                } else if (i % 97 == 96) {
+                    // Occasional owner- or range-scoped mass cancel
+                    auto order = generate_random_order(id);
+                    book.process_mass_cancel((i & 1)
+                        ? MassCancelFilter::for_owner(OwnerId(static_cast<uint32_t>(i % 3)))
+                        : MassCancelFilter::for_price_range(order.side, order.price,
+                                                            Price(order.price.get() + PRICE_SCALE)));
+                } else if (i % 53 == 52) {
+                    // Two-sided quote refresh around a random mid; rungs that
+                    // land on live quote prices are amended in place
+                    auto order = generate_random_order(id);
+                    std::vector<QuoteEntry> bids, asks;
+                    for (uint64_t k = 0; k < 3; ++k) {
+                        int64_t offset = static_cast<int64_t>(k + 1) * PRICE_SCALE / 2;
+                        bids.push_back({OrderId(10000000 + id * 10 + k),
+                                        Price(order.price.get() - offset), Quantity(5 + k)});
+                        asks.push_back({OrderId(10000005 + id * 10 + k),
+                                        Price(order.price.get() + offset), Quantity(5 + k)});
+                    }
+                    book.process_quote(OwnerId(static_cast<uint32_t>(i % 2 + 1)), bids.data(),
+                                       bids.size(), asks.data(), asks.size());
+                } else if (i > 20 && action_dist(rng) == 0) {
+                    // Alternate in-place reductions and replaces
+                    auto order = generate_random_order(id);
+                    Quantity qty((i & 1) ? order.quantity.get() / 4 : order.quantity.get());
+                    book.process_modify(OrderId(id - 1 - (i % 20)), order.price, qty);
+                } else {
+                    auto order = generate_random_order(id);
+                    book.process_new_order(order.id, order.side, order.price, order.quantity,
+                                           OwnerId(static_cast<uint32_t>(id % 3)));
+                }
+            }
+            live.flush();
+            TEST_ASSERT(live.messages_dropped() == 0);
+            
+            MboFeedDecoder decoder;
+            MboBookBuilder rebuilt;
+            for (size_t p = 0; p < live.packet_count(); ++p) {
+                TEST_ASSERT(decoder.decode_packet(live.packet(p), rebuilt));
+            }
+            
+            for (Side side : {Side::BUY, Side::SELL}) {
+                std::vector<std::tuple<uint64_t, int64_t, uint64_t>> source, copy;
+                book.for_each_order(side, [&source](const Order& o) {
+                    source.emplace_back(o.id.get(), o.price.get(), o.remaining_qty.get());
+                });
+                rebuilt.for_each_order(side, [&copy](OrderId id, Price p, Quantity q) {
+                    copy.emplace_back(id.get(), p.get(), q.get());
+                });
+                TEST_ASSERT(source == copy);
+                
+                const auto depth = rebuilt.get_depth(side);
+                const auto& top = book.get_depth(side);
+                TEST_ASSERT(depth.size() >= top.size());
+                for (size_t i = 0; i < top.size(); ++i) {
+                    TEST_ASSERT(depth[i].price == top[i].price);
+                    TEST_ASSERT(depth[i].total_volume == top[i].total_volume);
+                    TEST_ASSERT(depth[i].order_count == top[i].order_count);
+                }
+            }
+            
+            // Re-deriving the feed offline from the event log is byte-identical
+            MboFeedEncoder offline(512);
+            ReplayEngine::encode_mbo_feed(book.get_event_log(), offline);
+            TEST_ASSERT(offline.packet_count() == live.packet_count());
+            for (size_t p = 0; p < live.packet_count(); ++p) {
+                const MboPacket& a = live.packet(p);
+                const MboPacket& b = offline.packet(p);
+                TEST_ASSERT(a.length == b.length);
+                TEST_ASSERT(std::equal(a.data.begin(), a.data.begin() + a.length, b.data.begin()));
+            }
+        }
+        
+        std::cout << "   ✓ Rebuilt book equals source book (L3, FIFO)\n";
+    }
+    
+    // Property 8: Batched processing is identical to one-by-one processing
+    void test_batch_equivalence() {
+        std::cout << "\n🔬 Property Test 8: Batch Equivalence\n";
+        
+        for (int trial = 0; trial < 30; ++trial) {
+            std::vector<Command> cmds;
+            std::uniform_int_distribution<> action_dist(0, 2);
+            for (uint64_t i = 0; i < 1000; ++i) {
+                uint64_t id = i + 1;
+                if (i > 5 && action_dist(rng) == 0) {
+                    std::uniform_int_distribution<uint64_t> target(1, i);
+                    cmds.push_back(Command::cancel(OrderId(target(rng))));
+                } else if (i > 5 && action_dist(rng) == 0) {
+                    std::uniform_int_distribution<uint64_t> target(1, i);
+                    auto order = generate_random_order(id);
+                    cmds.push_back(Command::modify(OrderId(target(rng)), order.price, order.quantity));
+                } else {
+                    auto order = generate_random_order(id);
+                    cmds.push_back(Command::new_order(order.id, order.side, order.price, order.quantity));
+                }
+            }
+            
+            OrderBook single(2000);
+            for (const auto& cmd : cmds) {
+                if (cmd.type == CommandType::NEW_ORDER) {
+                    single.process_new_order(cmd.id, cmd.side, cmd.price, cmd.quantity);
+                } else if (cmd.type == CommandType::MODIFY_ORDER) {
+                    single.process_modify(cmd.id, cmd.price, cmd.quantity);
+                } else {
+                    single.process_cancel(cmd.id);
+                }
+            }
+            
+            // Same capacity, so a full pool would refuse the same commands
+            OrderBook batched(2000);
+            std::uniform_int_distribution<size_t> batch_dist(1, 100);
+            for (size_t i = 0; i < cmds.size();) {
+                size_t n = std::min(batch_dist(rng), cmds.size() - i);
+                batched.process_batch(cmds.data() + i, n);
+                i += n;
+            }
+            
+            TEST_ASSERT(logs_equal(single.get_event_log(), batched.get_event_log()));
+            TEST_ASSERT(books_equal(single, batched));
+        }
+        
+        std::cout << "   ✓ Batched event log and book identical to sequential\n";
+    }
+    
+    // Property 9: Binary journal decodes to the exact event log
+    void test_journal_round_trip() {
+        std::cout << "\n🔬 Property Test 9: Journal Round Trip\n";
+        
+        for (int trial = 0; trial < 30; ++trial) {
+            OrderBook book(4000);
+            if (trial & 1) book.set_fill_reporting(FillReporting::PER_LEVEL);
+            if (trial % 3 == 0) {
+                // Random prices are not all on the grid: some orders get rejected
+                book.set_instrument(Instrument::make(Price(PRICE_SCALE / 100), Quantity(1),
+                                                     from_double(100.0), 450));
+            }
+            std::uniform_int_distribution<> action_dist(0, 5);
+            
+            for (uint64_t i = 0; i < 1000; ++i) {
+                uint64_t id = trial * 10000 + i + 1;
+                auto order = generate_random_order(id);
+                switch (i > 10 ? action_dist(rng) : 0) {
+                    case 1:
+                        book.process_cancel(OrderId(id - 1 - i % 10));
+                        break;
+                    case 2:
+                        book.process_modify(OrderId(id - 1 - i % 10), order.price, order.quantity);
+                        break;
+                    case 3:
+                        if (i % 7 == 0) {
+                            book.process_mass_cancel(MassCancelFilter::for_owner(OwnerId(1)));
+                            break;
+                        }
+                        [[fallthrough]];
+                    case 4: {
+                        QuoteEntry bid{OrderId(id + 5000000), Price(order.price.get() - PRICE_SCALE),
+                                       order.quantity};
+                        QuoteEntry ask{OrderId(id + 6000000), Price(order.price.get() + PRICE_SCALE),
+                                       order.quantity};
+                        book.process_quote(OwnerId(2), &bid, 1, &ask, 1);
+                        break;
+                    }
+                    default:
+                        book.process_new_order(order.id, order.side, order.price, order.quantity,
+                                               OwnerId(static_cast<uint32_t>(id % 3)));
+                }
+            }
+            
+            const auto& log = book.get_event_log();
+            std::uniform_int_distribution<size_t> block_dist(1, 600);
+            JournalWriter writer(block_dist(rng));
+            writer.append(log);
+            JournalReader reader(writer.finish());
+            
+            std::vector<Event> decoded;
+            TEST_ASSERT(reader.read_all(decoded));
+            TEST_ASSERT(reader.event_count() == log.size());
+            TEST_ASSERT(logs_equal(log, decoded));
+            
+            // Seeking: the found block starts before ts, the next at or after it
+            std::uniform_int_distribution<uint64_t> ts_dist(0, get_timestamp(log.back()).get() + 1);
+            for (int probe = 0; probe < 20; ++probe) {
+                Timestamp ts(ts_dist(rng));
+                size_t b = reader.find_block(ts);
+                TEST_ASSERT(b == 0 || reader.block(b).first_timestamp < ts);
+                TEST_ASSERT(b + 1 == reader.block_count() || ts <= reader.block(b + 1).first_timestamp);
+                
+                std::vector<Event> block_events;
+                TEST_ASSERT(reader.read_block(b, block_events));
+                TEST_ASSERT(block_events.size() == reader.block(b).event_count);
+            }
+        }
+        
+        std::cout << "   ✓ Decoded journal identical to source log\n";
+    }
+    
+    // Property 10: Fenwick depth queries agree with a walk over the levels
+    void test_cumulative_depth() {
+        std::cout << "\n🔬 Property Test 10: Cumulative Depth Index\n";
+        const Instrument inst = Instrument::make(Price(PRICE_SCALE / 100), Quantity(1),
+                                                 from_double(100.0), 600);
+        
+        for (int trial = 0; trial < 30; ++trial) {
+            OrderBook indexed(4000), walked(4000);
+            indexed.set_instrument(inst);
+            walked.set_instrument(inst);
+            TEST_ASSERT(indexed.enable_cumulative_depth(true));
+            std::uniform_int_distribution<> action_dist(0, 4);
+            
+            for (uint64_t i = 0; i < 500; ++i) {
+                uint64_t id = i + 1;
+                auto order = generate_random_order(id);
+                int action = i > 10 ? action_dist(rng) : 0;
+                for (OrderBook* book : {&indexed, &walked}) {
+                    if (action == 1) book->process_cancel(OrderId(id - 1 - i % 10));
+                    else if (action == 2) book->process_modify(OrderId(id - 1 - i % 10), order.price,
+                                                               Quantity(order.quantity.get() / 2));
+                    else if (action == 3 && i % 50 == 0) book->process_mass_cancel(
+                        MassCancelFilter::for_price_range(order.side, order.price,
+                                                          Price(order.price.get() + PRICE_SCALE)));
+                    else book->process_new_order(order.id, order.side, order.price, order.quantity);
+                }
+                
+                if (i % 10 != 0) continue;
+                std::uniform_int_distribution<int64_t> limit_dist(from_double(93.0).get(),
+                                                                  from_double(107.0).get());
+                std::uniform_int_distribution<uint64_t> qty_dist(1, 20000);
+                for (Side side : {Side::BUY, Side::SELL}) {
+                    Price limit(limit_dist(rng));
+                    TEST_ASSERT(indexed.cumulative_volume(side, limit) ==
+                                walked.cumulative_volume(side, limit));
+                    Quantity qty(qty_dist(rng));
+                    TEST_ASSERT(indexed.price_for_depth(side, qty) == walked.price_for_depth(side, qty));
+                }
+            }
+        }
+        
+        std::cout << "   ✓ Indexed and walked answers identical\n";
+    }
+    
+    // Property 11: A dry-run fill predicts exactly what real matching executes
+    void test_simulate_fill() {
+        std::cout << "\n🔬 Property Test 11: Dry-Run Matches Real Execution\n";
+        
+        for (int trial = 0; trial < 50; ++trial) {
+            OrderBook book(4000);
+            if (trial % 2) book.set_fill_reporting(FillReporting::PER_LEVEL);
+            for (uint64_t i = 0; i < 1000; ++i) {
+                uint64_t id = i + 1;
+                auto order = generate_random_order(id);
+                auto estimate = book.simulate_fill(order.side, order.price, order.quantity);
+                size_t log_before = book.get_event_log().size();
+                
+                book.process_new_order(order.id, order.side, order.price, order.quantity);
+                
+                // Reduce the trades actually executed to the same summary
+                uint64_t filled = 0;
+                Notional notional = 0;
+                size_t levels = 0;
+                std::optional<Price> worst;
+                const auto& log = book.get_event_log();
+                for (size_t k = log_before; k < log.size(); ++k) {
+                    Price price(0);
+                    uint64_t qty = 0;
+                    if (auto t = std::get_if<TradeEvent>(&log[k])) {
+                        price = t->price;
+                        qty = t->quantity.get();
+                    } else if (auto l = std::get_if<LevelTradeEvent>(&log[k])) {
+                        price = l->price;
+                        qty = l->quantity.get();
+                    } else {
+                        continue;
+                    }
+                    if (!worst || *worst != price) ++levels;
+                    worst = price;
+                    filled += qty;
+                    notional += Notional(price.get()) * qty;
+                }
+                
+                TEST_ASSERT(estimate.filled.get() == filled);
+                TEST_ASSERT(estimate.notional == notional);
+                TEST_ASSERT(estimate.levels_touched == levels);
+                TEST_ASSERT(estimate.worst_price == worst);
+            }
+        }
+        
+        std::cout << "   ✓ Estimated fills identical to executed fills\n";
+    }
+    
     void run_all() {
         std::cout << "\n" << std::string(60, '=') << "\n";
         std::cout << "PROPERTY-BASED TEST SUITE\n";
@@ -226,6 +618,12 @@ public:
         test_volume_conservation();
         test_fifo_order();
         test_price_monotonicity();
+        test_depth_consistency();
+        test_mbo_feed_round_trip();
+        test_batch_equivalence();
+        test_journal_round_trip();
+        test_cumulative_depth();
+        test_simulate_fill();
         
         std::cout << "\n✅ All property tests passed!\n";
     }
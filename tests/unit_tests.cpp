@@ -1,9 +1,24 @@
 #include "../src/orderbook.hpp"
 #include "../src/replay.hpp"
+#include "../src/pipeline.hpp"
+#include "../src/async_journal.hpp"
+#include "../src/replica.hpp"
 #include <iostream>
 #include <cassert>
 #include <variant>
 #include <vector>
+#include <thread>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <filesystem>
+#include <limits>
+#include <csignal>
+#include <cerrno>
+#include <sys/resource.h>
 
 // ============================================================================
 // CUSTOM ASSERTION MACRO (Works in Release Mode)
@@ -37,6 +52,32 @@ public:
             test_replay_determinism();
             test_empty_book();
             test_crossed_order();
+            test_execution_stream();
+            test_execution_stream_overrun();
+            test_execution_stream_threaded();
+            test_depth_snapshot();
+            test_level_deltas();
+            test_mbo_feed_messages();
+            test_aggressor_rests_only_remainder();
+            test_modify_order();
+            test_modify_replay_csv();
+            test_mass_cancel();
+            test_mass_cancel_replay();
+            test_mass_quote();
+            test_mass_quote_replay();
+            test_per_level_fill_reporting();
+            test_journal_file();
+            test_instrument_validation();
+            test_cumulative_depth();
+            test_simulate_fill();
+            test_latency_probes();
+            test_pipeline_matches_inline();
+            test_async_journal();
+            test_journal_crc_recovery();
+            test_segmented_journal();
+            test_journal_replica();
+            test_oversized_journal_records();
+            test_reserved_owner_rejected();
             
             std::cout << "\n✅ All tests passed!\n";
         } catch (const std::exception& e) {
@@ -214,6 +255,1622 @@ private:
         }
         std::cout << "Passed\n";
     }
+
+    static void test_execution_stream() {
+        std::cout << "Test 10: Execution Stream Acks & Fills... ";
+        auto stream = std::make_unique<ExecutionStream>();
+        auto consumer = stream->subscribe();
+
+        OrderBook book;
+        book.attach_execution_stream(stream.get());
+        book.process_new_order(OrderId(1), Side::SELL, from_double(100.0), Quantity(10));
+        book.process_new_order(OrderId(2), Side::BUY, from_double(100.0), Quantity(4));
+        book.process_cancel(OrderId(1));
+        book.process_cancel(OrderId(1));
+
+        std::vector<ExecutionReport> reports;
+        ExecutionReport r{};
+        while (consumer.poll(r) == PollResult::OK) reports.push_back(r);
+
+        TEST_ASSERT(reports.size() == 5);
+        TEST_ASSERT(reports[0].type == ReportType::ACK_NEW && reports[0].order_id == 1);
+        TEST_ASSERT(reports[1].type == ReportType::ACK_NEW && reports[1].order_id == 2);
+        TEST_ASSERT(reports[2].type == ReportType::FILL);
+        TEST_ASSERT(reports[2].order_id == 1 && reports[2].contra_order_id == 2);
+        TEST_ASSERT(reports[2].quantity == 4);
+        TEST_ASSERT(reports[3].type == ReportType::ACK_CANCEL && reports[3].quantity == 6);
+        TEST_ASSERT(reports[4].type == ReportType::REJECT_CANCEL && reports[4].side == NO_SIDE);
+
+        // With the pool full, an order is refused before it is acknowledged
+        OrderBook full(1);
+        full.attach_execution_stream(stream.get());
+        full.process_new_order(OrderId(10), Side::BUY, from_double(99.0), Quantity(1));
+        full.process_new_order(OrderId(11), Side::BUY, from_double(98.0), Quantity(1));
+        reports.clear();
+        while (consumer.poll(r) == PollResult::OK) reports.push_back(r);
+        TEST_ASSERT(reports.size() == 2 && reports[0].type == ReportType::ACK_NEW);
+        TEST_ASSERT(reports[1].type == ReportType::REJECT_NEW && reports[1].order_id == 11);
+        TEST_ASSERT(reports[1].quantity == static_cast<uint64_t>(RejectReason::POOL_EXHAUSTED));
+        TEST_ASSERT(full.order_count() == 1);
+        TEST_ASSERT(consumer.overruns() == 0);
+        std::cout << "Passed\n";
+    }
+
+    static void test_execution_stream_overrun() {
+        std::cout << "Test 11: Execution Stream Slow Consumer... ";
+        ExecutionRing<16> ring;
+        auto fast = ring.subscribe();
+        auto slow = ring.subscribe();
+
+        ExecutionReport r{};
+        for (uint64_t i = 0; i < 40; ++i) {
+            r.order_id = i;
+            ring.publish(r);
+            // Fast consumer keeps up
+            TEST_ASSERT(fast.poll(r) == PollResult::OK && r.order_id == i);
+        }
+
+        // Producer never stalled; the lagging consumer is reported
+        TEST_ASSERT(ring.published() == 40);
+        TEST_ASSERT(ring.slow_consumers(16) == 1);
+        TEST_ASSERT(ring.max_lag() == 40);
+
+        TEST_ASSERT(slow.poll(r) == PollResult::OVERRUN);
+        TEST_ASSERT(slow.overruns() > 0);
+
+        // After skipping, the consumer resumes in sequence
+        uint64_t expected = slow.position();
+        while (slow.poll(r) == PollResult::OK) {
+            TEST_ASSERT(r.order_id == expected);
+            ++expected;
+        }
+        TEST_ASSERT(expected == 40);
+        TEST_ASSERT(ring.slow_consumers(0) == 0);
+        std::cout << "Passed\n";
+    }
+
+    static void test_execution_stream_threaded() {
+        std::cout << "Test 12: Execution Stream Multi-Consumer... ";
+        auto stream = std::make_unique<ExecutionStream>();
+        const uint64_t num_orders = 20000;
+
+        std::vector<std::thread> consumers;
+        std::vector<uint64_t> fills(3, 0);
+        std::vector<uint64_t> lost(3, 0);
+        std::atomic<int> ready{0};
+        for (int c = 0; c < 3; ++c) {
+            consumers.emplace_back([&, c] {
+                auto consumer = stream->subscribe();
+                ready.fetch_add(1);
+                ExecutionReport r{};
+                uint64_t received = 0;
+                // Each pair produces two acks and one fill
+                while (received < num_orders * 3) {
+                    PollResult res = consumer.poll(r);
+                    if (res == PollResult::OK) {
+                        ++received;
+                        if (r.type == ReportType::FILL) fills[c] += r.quantity;
+                    } else if (res == PollResult::OVERRUN) {
+                        break;
+                    } else {
+                        std::this_thread::yield();
+                    }
+                }
+                lost[c] = consumer.overruns();
+            });
+        }
+        while (ready.load() < 3) std::this_thread::yield();
+
+        OrderBook book(num_orders * 2 + 10);
+        book.attach_execution_stream(stream.get());
+        for (uint64_t i = 0; i < num_orders; ++i) {
+            book.process_new_order(OrderId(i * 2 + 1), Side::SELL, from_double(100.0), Quantity(10));
+            book.process_new_order(OrderId(i * 2 + 2), Side::BUY, from_double(100.0), Quantity(10));
+            // Keep the producer within ring capacity of the consumers so the
+            // test checks delivery, not the overrun path.
+            while (stream->max_lag() > ExecutionStream::capacity / 2) {
+                std::this_thread::yield();
+            }
+        }
+        for (auto& t : consumers) t.join();
+
+        for (int c = 0; c < 3; ++c) {
+            TEST_ASSERT(lost[c] == 0);
+            TEST_ASSERT(fills[c] == num_orders * 10);
+        }
+        std::cout << "Passed\n";
+    }
+
+    static void test_depth_snapshot() {
+        std::cout << "Test 13: Top-N Depth Snapshot... ";
+        OrderBook book;
+        book.set_depth_levels(2);
+
+        book.process_new_order(OrderId(1), Side::BUY, from_double(99.0), Quantity(10));
+        book.process_new_order(OrderId(2), Side::BUY, from_double(99.0), Quantity(5));
+        book.process_new_order(OrderId(3), Side::BUY, from_double(98.0), Quantity(7));
+        book.process_new_order(OrderId(4), Side::BUY, from_double(97.0), Quantity(1));
+        book.process_new_order(OrderId(5), Side::SELL, from_double(101.0), Quantity(3));
+
+        const auto& bids = book.get_depth(Side::BUY);
+        TEST_ASSERT(bids.size() == 2);
+        TEST_ASSERT(eq_price(bids[0].price, 99.0));
+        TEST_ASSERT(bids[0].total_volume.get() == 15 && bids[0].order_count == 2);
+        TEST_ASSERT(eq_price(bids[1].price, 98.0));
+        TEST_ASSERT(bids[1].total_volume.get() == 7 && bids[1].order_count == 1);
+
+        // Sell into the top level; the cached snapshot must follow
+        book.process_new_order(OrderId(6), Side::SELL, from_double(99.0), Quantity(12));
+        const auto& after = book.get_depth(Side::BUY);
+        TEST_ASSERT(after.size() == 2);
+        TEST_ASSERT(eq_price(after[0].price, 99.0) && after[0].total_volume.get() == 3);
+        TEST_ASSERT(after[0].order_count == 1);
+
+        // Removing the top level promotes 97.0 into the snapshot
+        book.process_cancel(OrderId(2));
+        const auto& promoted = book.get_depth(Side::BUY);
+        TEST_ASSERT(promoted.size() == 2);
+        TEST_ASSERT(eq_price(promoted[0].price, 98.0));
+        TEST_ASSERT(eq_price(promoted[1].price, 97.0));
+
+        const auto& asks = book.get_depth(Side::SELL);
+        TEST_ASSERT(asks.size() == 1 && eq_price(asks[0].price, 101.0));
+
+        // Depth 0: an empty snapshot that level changes leave alone
+        book.set_depth_levels(0);
+        TEST_ASSERT(book.get_depth(Side::BUY).empty() && book.get_depth(Side::SELL).empty());
+        book.process_new_order(OrderId(7), Side::BUY, from_double(98.5), Quantity(4));
+        book.process_new_order(OrderId(8), Side::SELL, from_double(100.5), Quantity(4));
+        TEST_ASSERT(book.get_depth(Side::BUY).empty() && book.get_depth(Side::SELL).empty());
+        std::cout << "Passed\n";
+    }
+
+    static void test_level_deltas() {
+        std::cout << "Test 14: Incremental Level Deltas... ";
+        OrderBook book;
+        book.enable_level_deltas(true, 64);
+
+        book.process_new_order(OrderId(1), Side::SELL, from_double(100.0), Quantity(10));  // NEW
+        book.process_new_order(OrderId(2), Side::SELL, from_double(100.0), Quantity(10));  // CHANGE
+        book.process_new_order(OrderId(3), Side::BUY, from_double(100.0), Quantity(15));   // CHANGE (match)
+        book.process_cancel(OrderId(2));                                                   // DELETE
+
+        const auto& deltas = book.get_level_deltas();
+        TEST_ASSERT(deltas.size() == 4);
+        TEST_ASSERT(deltas[0].action == DeltaAction::NEW && deltas[0].total_volume.get() == 10);
+        TEST_ASSERT(deltas[1].action == DeltaAction::CHANGE && deltas[1].order_count == 2);
+        TEST_ASSERT(deltas[2].action == DeltaAction::CHANGE && deltas[2].total_volume.get() == 5);
+        TEST_ASSERT(deltas[2].side == Side::SELL && deltas[2].order_count == 1);
+        TEST_ASSERT(deltas[3].action == DeltaAction::DELETE && deltas[3].total_volume.get() == 0);
+
+        book.clear_level_deltas();
+        // Full sweep of a level reports DELETE, then the remainder rests as NEW
+        book.process_new_order(OrderId(4), Side::SELL, from_double(101.0), Quantity(5));
+        book.process_new_order(OrderId(5), Side::BUY, from_double(101.0), Quantity(8));
+        TEST_ASSERT(deltas.size() == 3);
+        TEST_ASSERT(deltas[1].action == DeltaAction::DELETE && deltas[1].side == Side::SELL);
+        TEST_ASSERT(deltas[2].action == DeltaAction::NEW && deltas[2].side == Side::BUY);
+        TEST_ASSERT(deltas[2].total_volume.get() == 3);
+        std::cout << "Passed\n";
+    }
+
+    static void test_mbo_feed_messages() {
+        std::cout << "Test 15: MBO Feed Encode/Decode... ";
+        MboFeedEncoder encoder(16);
+        OrderBook book;
+        book.attach_mbo_feed(&encoder);
+
+        book.process_new_order(OrderId(1), Side::SELL, from_double(100.0), Quantity(10)); // A
+        book.process_new_order(OrderId(2), Side::SELL, from_double(100.0), Quantity(10)); // A
+        book.process_new_order(OrderId(3), Side::BUY, from_double(100.0), Quantity(15));  // E, E
+        book.process_cancel(OrderId(2));                                                  // D
+        encoder.flush();
+
+        TEST_ASSERT(encoder.packet_count() == 1);
+        TEST_ASSERT(encoder.messages_encoded() == 5);
+        const MboPacket& pkt = encoder.packet(0);
+        TEST_ASSERT(pkt.length == MBO_HEADER_SIZE + 5 * 2 + 2 * MBO_ADD_SIZE +
+                                  2 * MBO_EXECUTE_SIZE + MBO_DELETE_SIZE);
+
+        struct Recorder {
+            std::string types;
+            uint64_t executed = 0;
+            void on_add(const MboAdd& m) { types += 'A'; TEST_ASSERT(m.side == Side::SELL); }
+            void on_execute(const MboExecute& m) { types += 'E'; executed += m.quantity.get(); }
+            void on_cancel(const MboCancel&) { types += 'X'; }
+            void on_delete(const MboDelete& m) { types += 'D'; TEST_ASSERT(m.order_id.get() == 2); }
+        } rec;
+
+        MboFeedDecoder decoder;
+        TEST_ASSERT(decoder.decode_packet(pkt, rec));
+        TEST_ASSERT(rec.types == "AAEED");
+        TEST_ASSERT(rec.executed == 15);
+        TEST_ASSERT(decoder.expected_sequence() == 6);
+
+        // Replaying the same packet is a sequence gap and is rejected
+        TEST_ASSERT(!decoder.decode_packet(pkt, rec));
+        TEST_ASSERT(decoder.gaps() == 1);
+        TEST_ASSERT(rec.types == "AAEED");
+
+        // Truncated packets are rejected before anything is applied
+        MboFeedDecoder fresh;
+        TEST_ASSERT(!fresh.decode_packet(pkt.data.data(), pkt.length - 1, rec));
+        TEST_ASSERT(rec.types == "AAEED");
+
+        // Out of buffers: drops are counted and leave a sequence gap
+        MboFeedEncoder tiny(1);
+        OrderBook busy;
+        busy.attach_mbo_feed(&tiny);
+        const uint64_t adds = MBO_PACKET_SIZE / (2 + MBO_ADD_SIZE) + 3;
+        for (uint64_t i = 1; i <= adds; ++i) {
+            busy.process_new_order(OrderId(i), Side::BUY, from_double(90.0), Quantity(1));
+        }
+        tiny.flush();
+        TEST_ASSERT(busy.mbo_feed_drops() > 0);
+        TEST_ASSERT(busy.mbo_feed_drops() == tiny.messages_dropped());
+        TEST_ASSERT(tiny.messages_encoded() + tiny.messages_dropped() == adds);
+        MboBookBuilder l3;
+        MboFeedDecoder live;
+        TEST_ASSERT(tiny.packet_count() == 1 && live.decode_packet(tiny.packet(0), l3));
+        tiny.reset();
+        busy.process_cancel(OrderId(1));
+        tiny.flush();
+        TEST_ASSERT(!live.decode_packet(tiny.packet(0), l3) && live.gaps() == 1);
+        TEST_ASSERT(tiny.packet(0).sequence == adds + 1);
+        live.resync(tiny.packet(0).sequence);
+        TEST_ASSERT(live.decode_packet(tiny.packet(0), l3));
+        std::cout << "Passed\n";
+    }
+
+    static void test_aggressor_rests_only_remainder() {
+        std::cout << "Test 16: Aggressor Rests Only Remainder... ";
+        OrderBook book(4);
+
+        book.process_new_order(OrderId(1), Side::SELL, from_double(100.0), Quantity(10));
+        book.process_new_order(OrderId(2), Side::SELL, from_double(100.0), Quantity(10));
+        TEST_ASSERT(book.order_count() == 2);
+
+        // Fully filled on arrival: never indexed, cancel finds nothing
+        book.process_new_order(OrderId(3), Side::BUY, from_double(100.0), Quantity(5));
+        TEST_ASSERT(book.order_count() == 2);
+        book.process_cancel(OrderId(3));
+        TEST_ASSERT(book.order_count() == 2);
+        TEST_ASSERT(book.get_depth(Side::SELL)[0].total_volume.get() == 15);
+
+        // Partial fill: the remainder rests and is cancellable
+        book.process_new_order(OrderId(4), Side::BUY, from_double(100.0), Quantity(20));
+        TEST_ASSERT(book.order_count() == 1);
+        TEST_ASSERT(eq_price(*book.best_bid(), 100.0));
+        TEST_ASSERT(!book.best_ask().has_value());
+        book.process_cancel(OrderId(4));
+        TEST_ASSERT(book.order_count() == 0);
+        TEST_ASSERT(!book.best_bid().has_value());
+
+        // A small pool is enough for any number of fully matching pairs
+        for (uint64_t i = 0; i < 100; ++i) {
+            book.process_new_order(OrderId(100 + i * 2), Side::SELL, from_double(100.0), Quantity(1));
+            book.process_new_order(OrderId(101 + i * 2), Side::BUY, from_double(100.0), Quantity(1));
+        }
+        TEST_ASSERT(book.order_count() == 0);
+        std::cout << "Passed\n";
+    }
+
+    // Passive order ids in trade order, from log index `from`
+    static std::vector<uint64_t> passive_fills(const OrderBook& book, size_t from = 0) {
+        std::vector<uint64_t> ids;
+        const auto& log = book.get_event_log();
+        for (size_t i = from; i < log.size(); ++i) {
+            if (auto t = std::get_if<TradeEvent>(&log[i])) ids.push_back(t->passive_order_id.get());
+        }
+        return ids;
+    }
+
+    static void test_modify_order() {
+        std::cout << "Test 17: Modify (Cancel/Replace)... ";
+        OrderBook book;
+
+        book.process_new_order(OrderId(1), Side::SELL, from_double(100.0), Quantity(10));
+        book.process_new_order(OrderId(2), Side::SELL, from_double(100.0), Quantity(10));
+        book.process_new_order(OrderId(3), Side::SELL, from_double(100.0), Quantity(10));
+
+        // Reduction in place keeps priority and updates level volume
+        book.process_modify(OrderId(1), from_double(100.0), Quantity(4));
+        TEST_ASSERT(std::holds_alternative<ModifyOrderEvent>(book.get_event_log().back()));
+        TEST_ASSERT(book.get_depth(Side::SELL)[0].total_volume.get() == 24);
+
+        // Increase loses priority: order 2 moves behind order 3
+        book.process_modify(OrderId(2), from_double(100.0), Quantity(12));
+        TEST_ASSERT(book.get_depth(Side::SELL)[0].total_volume.get() == 26);
+        TEST_ASSERT(book.order_count() == 3);
+
+        size_t mark = book.get_event_log().size();
+        book.process_new_order(OrderId(4), Side::BUY, from_double(100.0), Quantity(15));
+        TEST_ASSERT((passive_fills(book, mark) == std::vector<uint64_t>{1, 3, 2}));
+        TEST_ASSERT(book.get_depth(Side::SELL)[0].total_volume.get() == 11);
+
+        // Price change that crosses trades immediately and rests the rest
+        book.process_new_order(OrderId(5), Side::BUY, from_double(99.0), Quantity(20));
+        mark = book.get_event_log().size();
+        book.process_modify(OrderId(5), from_double(100.0), Quantity(20));
+        TEST_ASSERT((passive_fills(book, mark) == std::vector<uint64_t>{2}));
+        TEST_ASSERT(!book.best_ask().has_value());
+        TEST_ASSERT(eq_price(*book.best_bid(), 100.0));
+        TEST_ASSERT(book.get_depth(Side::BUY)[0].total_volume.get() == 9);
+
+        // Zero quantity cancels; unknown ids are a logged no-op
+        book.process_modify(OrderId(5), from_double(100.0), Quantity(0));
+        TEST_ASSERT(!book.best_bid().has_value());
+        TEST_ASSERT(book.order_count() == 0);
+        size_t before = book.get_event_log().size();
+        book.process_modify(OrderId(42), from_double(100.0), Quantity(1));
+        TEST_ASSERT(book.get_event_log().size() == before + 1);
+        std::cout << "Passed\n";
+    }
+
+    static void test_modify_replay_csv() {
+        std::cout << "Test 18: Modify Replay via CSV... ";
+        OrderBook book;
+        book.process_new_order(OrderId(1), Side::SELL, from_double(100.0), Quantity(10));
+        book.process_new_order(OrderId(2), Side::SELL, from_double(100.5), Quantity(10));
+        book.process_modify(OrderId(1), from_double(100.0), Quantity(3));
+        book.process_modify(OrderId(2), from_double(99.5), Quantity(8));
+        book.process_new_order(OrderId(3), Side::BUY, from_double(99.5), Quantity(5));
+
+        const std::string path = "test_modify_replay.log";
+        ReplayEngine::save_log(book.get_event_log(), path);
+        auto loaded = ReplayEngine::load_log(path);
+        std::remove(path.c_str());
+
+        OrderBook replayed = ReplayEngine::replay_from_log(loaded);
+        TEST_ASSERT(replayed.get_event_log().size() == book.get_event_log().size());
+        TEST_ASSERT(replayed.best_ask()->get() == book.best_ask()->get());
+        TEST_ASSERT(replayed.get_depth(Side::SELL)[0].total_volume ==
+                    book.get_depth(Side::SELL)[0].total_volume);
+        TEST_ASSERT(replayed.order_count() == book.order_count());
+        std::cout << "Passed\n";
+    }
+
+    static void test_mass_cancel() {
+        std::cout << "Test 19: Mass Cancel by Side/Range/Owner... ";
+        OrderBook book(100);
+        auto populate = [&book](uint64_t base) {
+            for (uint64_t i = 0; i < 6; ++i) {
+                OwnerId owner(static_cast<uint32_t>(i % 2 + 1));
+                book.process_new_order(OrderId(base + i), Side::BUY,
+                                       from_double(99.0 - static_cast<double>(i % 3)), Quantity(10), owner);
+                book.process_new_order(OrderId(base + 10 + i), Side::SELL,
+                                       from_double(101.0 + static_cast<double>(i % 3)), Quantity(10), owner);
+            }
+        };
+
+        populate(100);
+        TEST_ASSERT(book.order_count() == 12);
+
+        // Side scope: every bid goes, asks untouched
+        TEST_ASSERT(book.process_mass_cancel(MassCancelFilter::for_side(Side::BUY)) == 6);
+        TEST_ASSERT(!book.best_bid().has_value());
+        TEST_ASSERT(book.order_count() == 6);
+        TEST_ASSERT(std::holds_alternative<MassCancelEvent>(book.get_event_log().back()));
+
+        // Price range scope (inclusive): 101 and 102 asks go, 103 stays
+        TEST_ASSERT(book.process_mass_cancel(MassCancelFilter::for_price_range(
+            Side::SELL, from_double(101.0), from_double(102.0))) == 4);
+        TEST_ASSERT(eq_price(*book.best_ask(), 103.0));
+        TEST_ASSERT(book.get_depth(Side::SELL).size() == 1);
+
+        // Owner scope across both sides keeps other owners' FIFO intact
+        book.process_mass_cancel(MassCancelFilter::all());
+        populate(200);
+        TEST_ASSERT(book.process_mass_cancel(MassCancelFilter::for_owner(OwnerId(1))) == 6);
+        TEST_ASSERT(book.order_count() == 6);
+        book.for_each_order(Side::BUY, [](const Order& o) { TEST_ASSERT(o.owner.get() == 2); });
+        book.for_each_order(Side::SELL, [](const Order& o) { TEST_ASSERT(o.owner.get() == 2); });
+        TEST_ASSERT(book.get_depth(Side::BUY)[0].order_count == 1);
+
+        // Cancelled ids are gone from the index; slots are reusable
+        book.process_cancel(OrderId(200));
+        TEST_ASSERT(book.order_count() == 6);
+        TEST_ASSERT(book.process_mass_cancel(MassCancelFilter::all()) == 6);
+        TEST_ASSERT(book.order_count() == 0);
+        for (uint64_t i = 0; i < 100; ++i) {
+            book.process_new_order(OrderId(1000 + i), Side::BUY, from_double(90.0), Quantity(1));
+        }
+        TEST_ASSERT(book.order_count() == 100);
+
+        // Owner 0 (no owner) is an owner like any other, not the wildcard.
+        // Every cancelled order is reported ahead of the summary.
+        auto stream = std::make_unique<ExecutionStream>();
+        auto consumer = stream->subscribe();
+        OrderBook owned(10);
+        owned.attach_execution_stream(stream.get());
+        for (uint64_t i = 0; i < 3; ++i) {
+            owned.process_new_order(OrderId(1 + i), Side::BUY, from_double(90.0 - i), Quantity(1));
+        }
+        owned.process_new_order(OrderId(4), Side::BUY, from_double(80.0), Quantity(4), OwnerId(7));
+        owned.process_new_order(OrderId(5), Side::SELL, from_double(110.0), Quantity(3), OwnerId(7));
+        TEST_ASSERT(owned.process_mass_cancel(MassCancelFilter::for_owner(OwnerId(0))) == 3);
+        TEST_ASSERT(owned.order_count() == 2);
+        TEST_ASSERT(owned.process_mass_cancel(MassCancelFilter::all()) == 2);
+
+        std::vector<ExecutionReport> reports;
+        ExecutionReport r{};
+        while (consumer.poll(r) == PollResult::OK) reports.push_back(r);
+        TEST_ASSERT(reports.size() == 5 + 4 + 3);
+        for (size_t i = 5; i < 8; ++i) {
+            TEST_ASSERT(reports[i].type == ReportType::ACK_CANCEL && reports[i].side == Side::BUY);
+            TEST_ASSERT(reports[i].order_id == i - 4 && reports[i].quantity == 1);
+        }
+        TEST_ASSERT(reports[8].type == ReportType::ACK_MASS_CANCEL && reports[8].quantity == 3);
+        TEST_ASSERT(reports[9].type == ReportType::ACK_CANCEL && reports[9].order_id == 4);
+        TEST_ASSERT(reports[10].type == ReportType::ACK_CANCEL && reports[10].order_id == 5);
+        TEST_ASSERT(reports[10].side == Side::SELL && reports[10].quantity == 3);
+        TEST_ASSERT(reports[11].type == ReportType::ACK_MASS_CANCEL && reports[11].quantity == 2);
+        std::cout << "Passed\n";
+    }
+
+    static void test_mass_cancel_replay() {
+        std::cout << "Test 20: Mass Cancel Replay via CSV... ";
+        OrderBook book;
+        for (uint64_t i = 0; i < 20; ++i) {
+            book.process_new_order(OrderId(i + 1), (i % 2) ? Side::BUY : Side::SELL,
+                                   from_double((i % 2) ? 99.0 - 0.5 * (i % 4) : 101.0 + 0.5 * (i % 4)),
+                                   Quantity(5 + i), OwnerId(static_cast<uint32_t>(i % 3)));
+        }
+        book.process_mass_cancel(MassCancelFilter::for_owner(OwnerId(2)));
+        book.process_mass_cancel(MassCancelFilter::for_price_range(Side::SELL, from_double(101.5),
+                                                                   from_double(200.0)));
+
+        const std::string path = "test_mass_cancel_replay.log";
+        ReplayEngine::save_log(book.get_event_log(), path);
+        auto loaded = ReplayEngine::load_log(path);
+        std::remove(path.c_str());
+
+        OrderBook replayed = ReplayEngine::replay_from_log(loaded);
+        TEST_ASSERT(replayed.order_count() == book.order_count());
+        std::vector<uint64_t> a, b;
+        for (Side side : {Side::BUY, Side::SELL}) {
+            book.for_each_order(side, [&a](const Order& o) { a.push_back(o.id.get()); });
+            replayed.for_each_order(side, [&b](const Order& o) { b.push_back(o.id.get()); });
+        }
+        TEST_ASSERT(a == b);
+        std::cout << "Passed\n";
+    }
+
+    static void test_mass_quote() {
+        std::cout << "Test 21: Two-Sided Mass Quote... ";
+        auto stream = std::make_unique<ExecutionStream>();
+        auto consumer = stream->subscribe();
+        OrderBook book(100);
+        book.attach_execution_stream(stream.get());
+        const OwnerId mm(7);
+        std::vector<ExecutionReport> reports;
+        auto drain = [&consumer, &reports] {
+            reports.clear();
+            ExecutionReport r;
+            while (consumer.poll(r) == PollResult::OK) reports.push_back(r);
+        };
+        
+        QuoteEntry bids[] = {{OrderId(1), from_double(99.0), Quantity(10)},
+                             {OrderId(2), from_double(98.0), Quantity(20)}};
+        QuoteEntry asks[] = {{OrderId(3), from_double(101.0), Quantity(10)},
+                             {OrderId(4), from_double(102.0), Quantity(20)}};
+        book.process_quote(mm, bids, 2, asks, 2);
+        TEST_ASSERT(book.order_count() == 4);
+        TEST_ASSERT(book.get_event_log().size() == 1);  // The whole ladder is one event
+        const QuoteEvent* logged = std::get_if<QuoteEvent>(&book.get_event_log()[0]);
+        TEST_ASSERT(logged && logged->ladder->bid_count == 2 && logged->ladder->ask_count() == 2);
+        TEST_ASSERT(logged->ladder->asks()[1].id.get() == 4);
+        drain();
+        TEST_ASSERT(reports.size() == 5 && reports[0].type == ReportType::ACK_QUOTE);
+        TEST_ASSERT(reports[0].quantity == 4);
+        for (size_t i = 1; i < 5; ++i) {
+            TEST_ASSERT(reports[i].type == ReportType::ACK_NEW && reports[i].order_id == i);
+        }
+        
+        // Another participant queues behind the maker at 99
+        book.process_new_order(OrderId(50), Side::BUY, from_double(99.0), Quantity(5));
+        drain();
+        
+        // Shift: 99 is reduced (keeps slot, id and priority), 98 moves to 97,
+        // 101 is pulled, 102 is kept and a new 103 rung enters
+        QuoteEntry bids2[] = {{OrderId(11), from_double(99.0), Quantity(6)},
+                              {OrderId(12), from_double(97.0), Quantity(20)}};
+        QuoteEntry asks2[] = {{OrderId(13), from_double(101.0), Quantity(0)},
+                              {OrderId(14), from_double(102.0), Quantity(20)},
+                              {OrderId(15), from_double(103.0), Quantity(30)}};
+        book.process_quote(mm, bids2, 2, asks2, 3);
+        TEST_ASSERT(book.order_count() == 5);
+        drain();
+        TEST_ASSERT(reports.size() == 7 && reports[0].type == ReportType::ACK_QUOTE);
+        TEST_ASSERT(reports[1].type == ReportType::ACK_CANCEL && reports[1].order_id == 2);
+        TEST_ASSERT(reports[2].type == ReportType::ACK_MODIFY && reports[2].order_id == 1 &&
+                    reports[2].quantity == 6);
+        TEST_ASSERT(reports[3].type == ReportType::ACK_NEW && reports[3].order_id == 12);
+        TEST_ASSERT(reports[4].type == ReportType::ACK_CANCEL && reports[4].order_id == 3 &&
+                    reports[4].quantity == 10);
+        TEST_ASSERT(reports[5].type == ReportType::ACK_MODIFY && reports[5].order_id == 4);
+        TEST_ASSERT(reports[6].type == ReportType::ACK_NEW && reports[6].order_id == 15);
+        TEST_ASSERT(eq_price(*book.best_ask(), 102.0));
+        
+        std::vector<uint64_t> bid_ids, ask_ids;
+        book.for_each_order(Side::BUY, [&bid_ids](const Order& o) { bid_ids.push_back(o.id.get()); });
+        book.for_each_order(Side::SELL, [&ask_ids](const Order& o) { ask_ids.push_back(o.id.get()); });
+        TEST_ASSERT((bid_ids == std::vector<uint64_t>{1, 50, 12}));
+        TEST_ASSERT((ask_ids == std::vector<uint64_t>{4, 15}));
+        TEST_ASSERT(book.get_depth(Side::BUY)[0].total_volume.get() == 11);
+        
+        // A crossing rung trades like any aggressor; its fills end the ladder
+        book.process_new_order(OrderId(60), Side::SELL, from_double(99.5), Quantity(10));
+        QuoteEntry bids3[] = {{OrderId(21), from_double(99.5), Quantity(4)}};
+        book.process_quote(mm, bids3, 1, nullptr, 0);
+        TEST_ASSERT(book.order_count() == 2);  // 50 and the ask at 99.5
+        const TradeEvent* trade = std::get_if<TradeEvent>(&book.get_event_log().back());
+        TEST_ASSERT(trade && trade->passive_order_id.get() == 60 && trade->quantity.get() == 4);
+        
+        // Owner 0 is rejected without touching the book
+        drain();
+        size_t logged_before = book.get_event_log().size();
+        book.process_quote(OwnerId(0), bids, 2, asks, 2);
+        TEST_ASSERT(book.order_count() == 2);
+        drain();
+        TEST_ASSERT(reports.size() == 1 && reports[0].type == ReportType::REJECT_QUOTE);
+        TEST_ASSERT(reports[0].quantity == static_cast<uint64_t>(RejectReason::NO_OWNER));
+        
+        // So is a ladder crossing itself, even if only through its outer
+        // rungs; a pulled rung does not count
+        QuoteEntry crossed_bids[] = {{OrderId(31), from_double(97.0), Quantity(5)},
+                                     {OrderId(32), from_double(96.0), Quantity(5)}};
+        QuoteEntry crossed_asks[] = {{OrderId(33), from_double(98.0), Quantity(0)},
+                                     {OrderId(34), from_double(97.0), Quantity(5)}};
+        book.process_quote(mm, crossed_bids, 2, crossed_asks, 2);
+        TEST_ASSERT(book.order_count() == 2);
+        drain();
+        TEST_ASSERT(reports.size() == 1 && reports[0].type == ReportType::REJECT_QUOTE);
+        TEST_ASSERT(reports[0].quantity == static_cast<uint64_t>(RejectReason::CROSSED_QUOTE));
+        crossed_asks[1].price = from_double(100.0);  // Clear of the book too
+        book.process_quote(mm, crossed_bids, 2, crossed_asks, 2);
+        TEST_ASSERT(book.order_count() == 5);
+        drain();
+        TEST_ASSERT(reports[0].type == ReportType::ACK_QUOTE);
+        TEST_ASSERT(reports[3].type == ReportType::ACK_CANCEL && reports[3].order_id == 33 &&
+                    reports[3].quantity == 0);
+        TEST_ASSERT(book.get_event_log().size() == logged_before + 3);  // Every quote logged
+        std::cout << "Passed\n";
+    }
+
+    static void test_mass_quote_replay() {
+        std::cout << "Test 22: Mass Quote Replay via CSV... ";
+        OrderBook book;
+        std::vector<QuoteEntry> bids, asks;
+        for (uint64_t round = 0; round < 20; ++round) {
+            bids.clear();
+            asks.clear();
+            for (uint64_t i = 0; i < 5; ++i) {
+                double shift = static_cast<double>(round % 3) * 0.5;
+                bids.push_back({OrderId(1000 + round * 10 + i), from_double(99.0 - i + shift),
+                                Quantity(10 + (round + i) % 4)});
+                asks.push_back({OrderId(1005 + round * 10 + i), from_double(101.0 + i - shift),
+                                Quantity(10 + (round * i) % 3)});
+            }
+            book.process_quote(OwnerId(static_cast<uint32_t>(round % 2 + 1)), bids.data(), 5,
+                               asks.data(), 5);
+            book.process_new_order(OrderId(round + 1), (round % 2) ? Side::BUY : Side::SELL,
+                                   from_double((round % 2) ? 100.5 : 99.5), Quantity(7));
+        }
+
+        const std::string path = "test_mass_quote_replay.log";
+        ReplayEngine::save_log(book.get_event_log(), path);
+        auto loaded = ReplayEngine::load_log(path);
+        std::remove(path.c_str());
+
+        // Trades are not loaded; replay regenerates them
+        OrderBook replayed = ReplayEngine::replay_from_log(loaded);
+        TEST_ASSERT(replayed.get_event_log().size() == book.get_event_log().size());
+        std::vector<std::pair<uint64_t, uint64_t>> a, b;
+        for (Side side : {Side::BUY, Side::SELL}) {
+            book.for_each_order(side, [&a](const Order& o) { a.emplace_back(o.id.get(), o.remaining_qty.get()); });
+            replayed.for_each_order(side, [&b](const Order& o) { b.emplace_back(o.id.get(), o.remaining_qty.get()); });
+        }
+        TEST_ASSERT(a == b);
+        std::cout << "Passed\n";
+    }
+
+    static void test_per_level_fill_reporting() {
+        std::cout << "Test 23: Per-Level Aggregated Fill Reporting... ";
+        auto main_stream = std::make_unique<ExecutionStream>();
+        auto detail_stream = std::make_unique<ExecutionStream>();
+        auto main_consumer = main_stream->subscribe();
+        auto detail_consumer = detail_stream->subscribe();
+
+        OrderBook per_fill(1000), per_level(1000);
+        per_level.set_fill_reporting(FillReporting::PER_LEVEL);
+        per_level.enable_fill_detail(true);
+        per_level.attach_execution_stream(main_stream.get());
+        per_level.attach_fill_detail_stream(detail_stream.get());
+
+        // Deep queues at two levels, then one sweep through both
+        for (OrderBook* book : {&per_fill, &per_level}) {
+            for (uint64_t i = 0; i < 100; ++i) {
+                book->process_new_order(OrderId(i + 1), Side::SELL,
+                                        from_double(i < 60 ? 100.0 : 100.5), Quantity(2));
+            }
+            book->process_new_order(OrderId(500), Side::BUY, from_double(101.0), Quantity(150));
+        }
+
+        // Book state and clock are identical; only the reporting differs
+        TEST_ASSERT(per_fill.order_count() == per_level.order_count());
+        TEST_ASSERT(per_fill.get_depth(Side::SELL)[0].total_volume ==
+                    per_level.get_depth(Side::SELL)[0].total_volume);
+        TEST_ASSERT(per_fill.get_event_log().size() == 101 + 75);
+        TEST_ASSERT(per_level.get_event_log().size() == 101 + 2);
+
+        const auto& log = per_level.get_event_log();
+        const LevelTradeEvent* first = std::get_if<LevelTradeEvent>(&log[101]);
+        const LevelTradeEvent* second = std::get_if<LevelTradeEvent>(&log[102]);
+        TEST_ASSERT(first && second);
+        TEST_ASSERT(first->fill_count == 60 && first->quantity.get() == 120);
+        TEST_ASSERT(eq_price(first->price, 100.0));
+        TEST_ASSERT(second->fill_count == 15 && second->quantity.get() == 30);
+        TEST_ASSERT(get_timestamp(log[102]) == get_timestamp(per_fill.get_event_log().back()));
+
+        // Detail log and stream carry every fill in order
+        const auto& detail = per_level.get_fill_detail();
+        TEST_ASSERT(detail.size() == 75);
+        for (size_t i = 0; i < detail.size(); ++i) {
+            const TradeEvent* t = std::get_if<TradeEvent>(&per_fill.get_event_log()[101 + i]);
+            TEST_ASSERT(t && t->passive_order_id == detail[i].passive_order_id);
+            TEST_ASSERT(t->timestamp == detail[i].timestamp);
+        }
+
+        size_t level_fills = 0, fills = 0;
+        std::vector<uint32_t> fill_counts;
+        ExecutionReport r{};
+        while (main_consumer.poll(r) == PollResult::OK) {
+            TEST_ASSERT(r.type != ReportType::FILL);
+            if (r.type == ReportType::LEVEL_FILL) {
+                ++level_fills;
+                fill_counts.push_back(r.fill_count);
+                TEST_ASSERT(r.order_id == 500 && r.contra_order_id == 0);
+            }
+        }
+        TEST_ASSERT((fill_counts == std::vector<uint32_t>{60, 15}));
+        while (detail_consumer.poll(r) == PollResult::OK) {
+            TEST_ASSERT(r.type == ReportType::FILL);
+            ++fills;
+        }
+        TEST_ASSERT(level_fills == 2 && fills == 75);
+
+        // Replay in the same mode reproduces the summarised log
+        OrderBook replayed = ReplayEngine::replay_from_log(log, FillReporting::PER_LEVEL);
+        TEST_ASSERT(replayed.get_event_log().size() == log.size());
+        TEST_ASSERT(replayed.order_count() == per_level.order_count());
+        std::cout << "Passed\n";
+    }
+
+    static void test_journal_file() {
+        std::cout << "Test 24: Binary Journal Save/Load... ";
+        OrderBook book;
+        for (uint64_t i = 0; i < 50; ++i) {
+            book.process_new_order(OrderId(i + 1), (i % 2) ? Side::BUY : Side::SELL,
+                                   from_double((i % 2) ? 99.0 + 0.01 * (i % 7) : 99.03 + 0.01 * (i % 5)),
+                                   Quantity(1 + i % 9), OwnerId(static_cast<uint32_t>(i % 3)));
+        }
+        book.process_modify(OrderId(2), from_double(98.0), Quantity(4));
+        book.process_mass_cancel(MassCancelFilter::all());
+
+        const std::string path = "test_journal.bin";
+        ReplayEngine::save_journal(book.get_event_log(), path, 16);
+        auto loaded = ReplayEngine::load_journal(path);
+        std::remove(path.c_str());
+
+        // Unbounded mass cancel ranges survive the zigzag encoding
+        const auto& log = book.get_event_log();
+        TEST_ASSERT(loaded.size() == log.size());
+        const MassCancelEvent* mc = std::get_if<MassCancelEvent>(&loaded.back());
+        TEST_ASSERT(mc && mc->filter.min_price.get() == std::numeric_limits<int64_t>::min());
+        TEST_ASSERT(mc->filter.max_price.get() == std::numeric_limits<int64_t>::max());
+        char a[256], b[256];
+        for (size_t i = 0; i < log.size(); ++i) {
+            event_to_buffer(log[i], a, sizeof(a));
+            event_to_buffer(loaded[i], b, sizeof(b));
+            TEST_ASSERT(std::string(a) == b);
+        }
+
+        // Corruption is detected, not decoded into garbage
+        JournalWriter writer(16);
+        writer.append(log);
+        std::vector<uint8_t> bytes = writer.finish();
+        std::vector<uint8_t> bad_footer = bytes;
+        bad_footer.back() ^= 0xFF;
+        bool threw = false;
+        try { JournalReader reader(bad_footer); } catch (const std::runtime_error&) { threw = true; }
+        TEST_ASSERT(threw);
+
+        std::vector<uint8_t> bad_block = bytes;
+        bad_block[JOURNAL_FILE_HEADER_SIZE + JOURNAL_BLOCK_HEADER_SIZE] = 0x7F;  // Unknown tag
+        JournalReader reader(bad_block);
+        std::vector<Event> out;
+        TEST_ASSERT(!reader.read_block(0, out));
+        TEST_ASSERT(reader.read_block(1, out));
+
+        // Quote rung counts whose sum wraps past 2^64 are refused
+        std::vector<uint8_t> quote = {static_cast<uint8_t>(EventType::QUOTE), 2, 7, 1};
+        journal::put_varint(quote, std::numeric_limits<uint64_t>::max());
+        quote.insert(quote.end(), {2, 2, 1});
+        out.clear();
+        TEST_ASSERT(!JournalBlockDecoder::decode(quote.data(), quote.size(), 1, out));
+        TEST_ASSERT(out.empty());
+        std::cout << "Passed\n";
+    }
+
+    static void test_instrument_validation() {
+        std::cout << "Test 25: Instrument Tick/Lot/Band Validation... ";
+        auto stream = std::make_unique<ExecutionStream>();
+        auto consumer = stream->subscribe();
+        OrderBook book(100);
+        book.attach_execution_stream(stream.get());
+
+        // 0.05 ticks, lots of 10, 100 ticks either side of 100.00
+        Instrument inst = Instrument::make(from_double(0.05), Quantity(10), from_double(100.0), 100);
+        TEST_ASSERT(!Instrument::make(Price(0), Quantity(1), Price(0), 1).valid());
+        // Band edges past the Price range
+        TEST_ASSERT(!Instrument::make(Price(INT64_MAX / 2), Quantity(1), Price(0), 3).valid());
+        TEST_ASSERT(!Instrument::make(Price(1000), Quantity(1), Price(INT64_MAX - 10), 1).valid());
+        TEST_ASSERT(book.set_instrument(inst));
+        TEST_ASSERT(std::holds_alternative<InstrumentEvent>(book.get_event_log().back()));
+
+        auto last_reject = [&book]() {
+            const auto* r = std::get_if<RejectOrderEvent>(&book.get_event_log().back());
+            return r ? r->reason : RejectReason::NONE;
+        };
+        book.process_new_order(OrderId(1), Side::BUY, from_double(99.97), Quantity(10));
+        TEST_ASSERT(last_reject() == RejectReason::OFF_TICK);
+        book.process_new_order(OrderId(2), Side::BUY, from_double(99.95), Quantity(15));
+        TEST_ASSERT(last_reject() == RejectReason::ODD_LOT);
+        book.process_new_order(OrderId(3), Side::SELL, from_double(105.05), Quantity(10));
+        TEST_ASSERT(last_reject() == RejectReason::OUTSIDE_BAND);
+        book.process_new_order(OrderId(4), Side::SELL, from_double(100.0), Quantity(0));
+        TEST_ASSERT(last_reject() == RejectReason::ZERO_QUANTITY);
+        TEST_ASSERT(book.order_count() == 0);
+
+        // Valid orders rest; the instrument is fixed while they do
+        book.process_new_order(OrderId(5), Side::BUY, from_double(99.95), Quantity(20));
+        book.process_new_order(OrderId(6), Side::SELL, from_double(105.0), Quantity(10));
+        TEST_ASSERT(book.order_count() == 2);
+        TEST_ASSERT(!book.set_instrument(Instrument::unrestricted()));  // Book not empty
+
+        // A rejected modify leaves the order as it was
+        book.process_modify(OrderId(5), from_double(99.93), Quantity(20));
+        TEST_ASSERT(last_reject() == RejectReason::OFF_TICK);
+        TEST_ASSERT(eq_price(*book.best_bid(), 99.95));
+
+        size_t rejects = 0, acks = 0;
+        ExecutionReport r{};
+        while (consumer.poll(r) == PollResult::OK) {
+            if (r.type == ReportType::REJECT_NEW) ++rejects;
+            if (r.type == ReportType::ACK_NEW) ++acks;
+        }
+        TEST_ASSERT(rejects == 4 && acks == 2);
+
+        // The instrument is part of the log, so replay rejects the same orders
+        const std::string path = "test_instrument_replay.log";
+        ReplayEngine::save_log(book.get_event_log(), path);
+        auto loaded = ReplayEngine::load_log(path);
+        std::remove(path.c_str());
+        OrderBook replayed = ReplayEngine::replay_from_log(loaded);
+        TEST_ASSERT(replayed.instrument().tick_size == inst.tick_size);
+        TEST_ASSERT(replayed.get_event_log().size() == book.get_event_log().size());
+        TEST_ASSERT(replayed.order_count() == 2);
+        std::cout << "Passed\n";
+    }
+
+    static void test_cumulative_depth() {
+        std::cout << "Test 26: Fenwick Cumulative Depth Queries... ";
+        OrderBook book(100);
+        TEST_ASSERT(!book.enable_cumulative_depth(true));  // Needs a price band
+        TEST_ASSERT(book.set_instrument(Instrument::make(from_double(0.01), Quantity(1),
+                                                         from_double(100.0), 500)));
+        TEST_ASSERT(book.enable_cumulative_depth(true));
+
+        // Asks 100.10 x10, 100.20 x20 (two orders), 100.50 x5
+        book.process_new_order(OrderId(1), Side::SELL, from_double(100.10), Quantity(10));
+        book.process_new_order(OrderId(2), Side::SELL, from_double(100.20), Quantity(15));
+        book.process_new_order(OrderId(3), Side::SELL, from_double(100.20), Quantity(5));
+        book.process_new_order(OrderId(4), Side::SELL, from_double(100.50), Quantity(5));
+        // Bids 99.90 x7, 99.50 x3
+        book.process_new_order(OrderId(5), Side::BUY, from_double(99.90), Quantity(7));
+        book.process_new_order(OrderId(6), Side::BUY, from_double(99.50), Quantity(3));
+
+        TEST_ASSERT(book.cumulative_volume(Side::SELL, from_double(100.20)).get() == 30);
+        TEST_ASSERT(book.cumulative_volume(Side::SELL, from_double(100.19)).get() == 10);
+        TEST_ASSERT(book.cumulative_volume(Side::SELL, from_double(100.05)).get() == 0);
+        TEST_ASSERT(book.cumulative_volume(Side::SELL, from_double(200.0)).get() == 35);
+        TEST_ASSERT(book.cumulative_volume(Side::BUY, from_double(99.50)).get() == 10);
+        TEST_ASSERT(book.cumulative_volume(Side::BUY, Price(from_double(99.50).get() + 1)).get() == 7);
+        TEST_ASSERT(book.cumulative_volume(Side::BUY, from_double(1.0)).get() == 10);
+
+        TEST_ASSERT(eq_price(*book.price_for_depth(Side::SELL, Quantity(10)), 100.10));
+        TEST_ASSERT(eq_price(*book.price_for_depth(Side::SELL, Quantity(11)), 100.20));
+        TEST_ASSERT(eq_price(*book.price_for_depth(Side::SELL, Quantity(35)), 100.50));
+        TEST_ASSERT(!book.price_for_depth(Side::SELL, Quantity(36)).has_value());
+        TEST_ASSERT(eq_price(*book.price_for_depth(Side::BUY, Quantity(8)), 99.50));
+
+        // Fills, cancels and in-place reductions keep the tree current
+        book.process_new_order(OrderId(7), Side::BUY, from_double(100.20), Quantity(12));
+        book.process_cancel(OrderId(4));
+        book.process_modify(OrderId(5), from_double(99.90), Quantity(2));
+        TEST_ASSERT(book.cumulative_volume(Side::SELL, from_double(101.0)).get() == 18);
+        TEST_ASSERT(eq_price(*book.price_for_depth(Side::SELL, Quantity(1)), 100.20));
+        TEST_ASSERT(book.cumulative_volume(Side::BUY, from_double(99.0)).get() == 5);
+
+        // Same answers from the linear fallback
+        TEST_ASSERT(book.enable_cumulative_depth(false));
+        TEST_ASSERT(book.cumulative_volume(Side::SELL, from_double(101.0)).get() == 18);
+        TEST_ASSERT(book.cumulative_volume(Side::BUY, from_double(99.0)).get() == 5);
+        TEST_ASSERT(eq_price(*book.price_for_depth(Side::BUY, Quantity(3)), 99.50));
+        std::cout << "Passed\n";
+    }
+
+    static void test_simulate_fill() {
+        std::cout << "Test 27: Dry-Run Fill Estimate... ";
+        OrderBook book(100);
+        book.process_new_order(OrderId(1), Side::SELL, from_double(100.0), Quantity(10));
+        book.process_new_order(OrderId(2), Side::SELL, from_double(100.0), Quantity(5));
+        book.process_new_order(OrderId(3), Side::SELL, from_double(101.0), Quantity(20));
+        book.process_new_order(OrderId(4), Side::SELL, from_double(103.0), Quantity(50));
+        const size_t log_size = book.get_event_log().size();
+
+        // Sweeps 100 fully and 101 partially; stops short of 103
+        FillEstimate e = book.simulate_fill(Side::BUY, from_double(102.0), Quantity(25));
+        TEST_ASSERT(e.filled.get() == 25 && e.levels_touched == 2);
+        TEST_ASSERT(eq_price(*e.worst_price, 101.0));
+        TEST_ASSERT(e.notional == 15 * from_double(100.0).get() + 10 * from_double(101.0).get());
+        TEST_ASSERT(e.vwap() > 100.39 && e.vwap() < 100.41);
+
+        // Limited by the price: only what crosses fills
+        e = book.simulate_fill(Side::BUY, from_double(102.0), Quantity(1000));
+        TEST_ASSERT(e.filled.get() == 35);
+
+        // Nothing crosses; the book and log are untouched throughout
+        e = book.simulate_fill(Side::BUY, from_double(99.0), Quantity(10));
+        TEST_ASSERT(e.filled.get() == 0 && !e.worst_price.has_value() && e.vwap() == 0.0);
+        TEST_ASSERT(book.get_event_log().size() == log_size);
+        TEST_ASSERT(book.order_count() == 4);
+
+        // The real order executes exactly what was estimated
+        book.process_new_order(OrderId(10), Side::BUY, from_double(102.0), Quantity(25));
+        uint64_t traded = 0;
+        for (size_t i = log_size; i < book.get_event_log().size(); ++i) {
+            if (auto t = std::get_if<TradeEvent>(&book.get_event_log()[i])) traded += t->quantity.get();
+        }
+        TEST_ASSERT(traded == 25);
+
+        // Notional past 64 bits: 2 * 10^10 lots at a scaled price of 10^9
+        OrderBook big(10);
+        const Price high = from_double(100000.0);
+        const uint64_t lots = 20000000000ULL;
+        big.process_new_order(OrderId(1), Side::SELL, high, Quantity(lots));
+        e = big.simulate_fill(Side::BUY, high, Quantity(lots));
+        TEST_ASSERT(e.notional == Notional(high.get()) * lots);
+        TEST_ASSERT(e.notional > Notional(std::numeric_limits<int64_t>::max()));
+        TEST_ASSERT(e.vwap() > 99999.0 && e.vwap() < 100001.0);
+        std::cout << "Passed\n";
+    }
+
+    static void test_latency_probes() {
+        std::cout << "Test 28: Latency Probes... ";
+        uint64_t t0 = TscClock::now();
+        uint64_t t1 = TscClock::now_serialized();
+        TEST_ASSERT(t1 >= t0);
+        TEST_ASSERT(TscClock::ticks_per_ns() > 0.0);
+
+        // Log2 buckets: percentiles report the bucket's upper bound
+        ProbeHistogram h;
+        for (uint64_t v = 1; v <= 100; ++v) h.record(v);
+        auto s = h.snapshot();
+        TEST_ASSERT(s.count == 100 && s.sum == 5050 && s.max == 100);
+        TEST_ASSERT(s.percentile(50) == 63 && s.percentile(100) == 100);
+
+        LatencyProbes::reset_all();
+        OrderBook book(100);
+        book.process_new_order(OrderId(1), Side::SELL, from_double(100.0), Quantity(10));
+        book.process_new_order(OrderId(2), Side::SELL, from_double(100.0), Quantity(10));
+        book.process_new_order(OrderId(3), Side::SELL, from_double(101.0), Quantity(10));
+        book.process_new_order(OrderId(4), Side::BUY, from_double(101.0), Quantity(25));
+        book.process_cancel(OrderId(3));
+
+        auto probes = LatencyProbes::local().snapshot();
+        const auto& new_orders = probes.cycles[static_cast<size_t>(ProbeStage::NEW_ORDER)];
+#if MATCHING_ENGINE_PROBES
+        TEST_ASSERT(new_orders.count == 4);
+        TEST_ASSERT(probes.cycles[static_cast<size_t>(ProbeStage::CANCEL)].count == 1);
+        TEST_ASSERT(probes.cycles[static_cast<size_t>(ProbeStage::REST)].count == 3);
+        // The buy swept two levels and three orders
+        TEST_ASSERT(probes.levels_swept.max == 2 && probes.orders_swept.max == 3);
+        TEST_ASSERT(probes.orders_swept.sum == 3);
+#else
+        TEST_ASSERT(new_orders.count == 0);  // Compiled out
+#endif
+        std::cout << "Passed\n";
+    }
+
+    static void test_pipeline_matches_inline() {
+        std::cout << "Test 29: Pipeline Matches Inline Processing... ";
+        // Mixed flow on a 0.05 tick grid, with off-tick orders and modifies
+        // so the ingress verdicts matter
+        std::vector<Command> cmds;
+        uint64_t state = 12345;
+        auto next = [&state]() { return state = state * 6364136223846793005ULL + 1442695040888963407ULL; };
+        for (uint64_t i = 1; i <= 5000; ++i) {
+            uint64_t r = next() >> 33;
+            double px = 100.0 + 0.05 * static_cast<double>(static_cast<int>(r % 21) - 10);
+            if (r % 37 == 0) px += 0.01;  // Off tick
+            if (i > 10 && r % 5 == 0) {
+                cmds.push_back(Command::cancel(OrderId(i - 1 - (r >> 8) % 10)));
+            } else if (i > 10 && r % 7 == 0) {
+                cmds.push_back(Command::modify(OrderId(i - 1 - (r >> 8) % 10), from_double(px),
+                                               Quantity(10 * (r % 4))));
+            } else {
+                cmds.push_back(Command::new_order(OrderId(i), (r & 1) ? Side::BUY : Side::SELL,
+                                                  from_double(px), Quantity(10 * (1 + r % 5))));
+            }
+        }
+        Instrument inst = Instrument::make(from_double(0.05), Quantity(10), from_double(100.0), 100);
+
+        OrderBook inline_book(10000);
+        TEST_ASSERT(inline_book.set_instrument(inst));
+        inline_book.process_batch(cmds.data(), cmds.size());
+
+        PipelineConfig config;
+        config.book_capacity = 10000;
+        config.ring_capacity = 64;  // Small, so every stage sees backpressure
+        config.memory_journal = true;
+        Pipeline pipeline(config);
+        TEST_ASSERT(pipeline.book().set_instrument(inst));
+        std::vector<std::string> published;
+        uint64_t last_seq = 0;
+        bool in_order = true;
+        pipeline.subscribe([&](const PipelineEvent& e) {
+            char buf[256];
+            event_to_buffer(e.event, buf, sizeof(buf));
+            published.emplace_back(buf);
+            in_order = in_order && e.seq >= last_seq;
+            last_seq = e.seq;
+        });
+        pipeline.start();
+        for (const Command& cmd : cmds) pipeline.submit(cmd);
+        pipeline.stop();
+
+        // Same events in the same order, the same resting book and journal
+        const auto& expected = inline_book.get_event_log();
+        TEST_ASSERT(published.size() == expected.size());
+        for (size_t i = 0; i < expected.size(); ++i) {
+            char buf[256];
+            event_to_buffer(expected[i], buf, sizeof(buf));
+            TEST_ASSERT(published[i] == buf);
+        }
+        TEST_ASSERT(in_order && last_seq == cmds.size());
+        TEST_ASSERT(pipeline.published() == cmds.size());
+        TEST_ASSERT(pipeline.book().order_count() == inline_book.order_count());
+        TEST_ASSERT(pipeline.book().best_bid() == inline_book.best_bid());
+        TEST_ASSERT(pipeline.book().best_ask() == inline_book.best_ask());
+        TEST_ASSERT(pipeline.book().get_event_log().empty());
+        TEST_ASSERT(pipeline.journal().events_written() == expected.size());
+        TEST_ASSERT(pipeline.async_journal() == nullptr);
+        TEST_ASSERT(pipeline.hop(PipelineHop::END_TO_END).count == cmds.size());
+
+        // By default the journal stage writes an AsyncJournal to disk
+        PipelineConfig disk;
+        disk.book_capacity = 10000;
+        disk.journal_path = "test_pipeline.jnl";
+        disk.journal.sync = false;
+        {
+            Pipeline durable(disk);
+            TEST_ASSERT(durable.book().set_instrument(inst));
+            durable.start();
+            for (const Command& cmd : cmds) durable.submit(cmd);
+            durable.stop();
+            TEST_ASSERT(durable.async_journal()->appended() == expected.size());
+        }
+        std::vector<Event> journaled;
+        TEST_ASSERT(AsyncJournal::read(disk.journal_path, journaled));
+        TEST_ASSERT(journaled.size() == expected.size());
+        for (size_t i = 0; i < expected.size(); ++i) {
+            char a[256], b[256];
+            event_to_buffer(expected[i], a, sizeof(a));
+            event_to_buffer(journaled[i], b, sizeof(b));
+            TEST_ASSERT(std::string(a) == b);
+        }
+        std::remove(disk.journal_path.c_str());
+        std::cout << "Passed\n";
+    }
+
+    static void test_async_journal() {
+        std::cout << "Test 30: Async Group-Commit Journal... ";
+        auto to_strings = [](const std::vector<Event>& log) {
+            std::vector<std::string> out;
+            char buf[256];
+            for (const auto& e : log) {
+                event_to_buffer(e, buf, sizeof(buf));
+                out.emplace_back(buf);
+            }
+            return out;
+        };
+        // io_uring (where available) and pwrite; a tiny queue forces spills
+        // and small buffers force many writes
+        for (bool uring : {true, false}) {
+            const std::string path = uring ? "test_async_uring.jnl" : "test_async_pwrite.jnl";
+            AsyncJournalConfig config;
+            config.use_io_uring = uring;
+            config.queue_capacity = 16;
+            config.buffer_bytes = 64 * 1024;
+            config.record_events = 100;
+            config.sync_interval = std::chrono::microseconds(0);
+            OrderBook book(5000);
+            uint64_t first_seq = 0;
+            {
+                AsyncJournal journal(path, config);
+                TEST_ASSERT(uring || std::string(journal.backend()) == "pwrite");
+                book.attach_event_sink(&journal);
+                for (uint64_t i = 1; i <= 3000; ++i) {
+                    Side side = (i % 2) ? Side::BUY : Side::SELL;
+                    book.process_new_order(OrderId(i), side, from_double(100.0 + (i % 7) * 0.01 - 0.03),
+                                           Quantity(10 + i % 5));
+                    if (i % 3 == 0) book.process_cancel(OrderId(i - 1));
+                    if (i == 1) first_seq = journal.appended();
+                }
+                TEST_ASSERT(journal.appended() == book.get_event_log().size());
+                // Acks wait on the durability watermark, never on append()
+                TEST_ASSERT(journal.wait_durable(journal.appended(), std::chrono::seconds(10)));
+                TEST_ASSERT(journal.durable() >= journal.appended());
+                book.attach_event_sink(nullptr);
+                journal.close();
+                auto stats = journal.stats();
+                TEST_ASSERT(!journal.failed() && stats.syncs > 0 && stats.writes > 0);
+                TEST_ASSERT(stats.records >= (book.get_event_log().size() + 99) / 100);
+            }
+            TEST_ASSERT(first_seq == 1);
+
+            std::vector<Event> loaded;
+            TEST_ASSERT(AsyncJournal::read(path, loaded));
+            TEST_ASSERT(to_strings(loaded) == to_strings(book.get_event_log()));
+            std::remove(path.c_str());
+        }
+
+        // A failed write is final. The file size is capped so the write
+        // reaching it fails (EFBIG); the SIGXFSZ raised on the way lifts the
+        // cap, so every later write would succeed, and a writer that carried
+        // on would move the watermarks past the lost records. (io_uring
+        // writes may not be held to the cap; pwrite always is.)
+        for (bool uring : {true, false}) {
+            const std::string path = "test_async_fail.jnl";
+            AsyncJournalConfig config;
+            config.use_io_uring = uring;
+            config.record_events = 16;
+            config.sync_interval = std::chrono::microseconds(0);
+            std::vector<Event> cancels;
+            for (uint64_t i = 1; i <= 200000; ++i) {
+                cancels.emplace_back(std::in_place_type<CancelOrderEvent>, Timestamp(i), OrderId(i));
+            }
+            auto cancel = [&cancels](uint64_t seq) -> const Event& {
+                return cancels[(seq - 1) % cancels.size()];
+            };
+            rlimit saved{};
+            getrlimit(RLIMIT_FSIZE, &saved);
+            auto saved_handler = std::signal(SIGXFSZ, lift_file_size_cap);
+            rlimit capped = saved;
+            capped.rlim_cur = 16 * 1024;
+            setrlimit(RLIMIT_FSIZE, &capped);
+            {
+                AsyncJournal journal(path, config);
+                uint64_t seq = 0;
+                for (uint64_t i = 0; i < 10; ++i) seq = journal.append(cancel(seq + 1));
+                TEST_ASSERT(journal.wait_durable(seq, std::chrono::seconds(10)));
+                const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+                while (!journal.failed() && std::chrono::steady_clock::now() < deadline) {
+                    // Bursts keep events queued behind the failing write
+                    for (int i = 0; i < 4096; ++i) seq = journal.append(cancel(seq + 1));
+                }
+                setrlimit(RLIMIT_FSIZE, &saved);
+                TEST_ASSERT(uring || journal.failed());
+                if (journal.failed()) {
+                    TEST_ASSERT(journal.error() == EFBIG);
+                    const uint64_t written = journal.written(), durable = journal.durable();
+                    TEST_ASSERT(durable >= 10 && durable <= written && written < seq);
+                    
+                    for (uint64_t i = 0; i < 40000; ++i) seq = journal.append(cancel(seq + 1));
+                    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+                    for (uint64_t s = durable + 1; s <= seq; ++s) {
+                        TEST_ASSERT(!journal.wait_durable(s, std::chrono::microseconds(0)));
+                    }
+                    TEST_ASSERT(journal.written() == written && journal.durable() == durable);
+                    journal.close();
+                    TEST_ASSERT(journal.durable() == durable);
+                    // Nothing was written once the cap had been lifted
+                    TEST_ASSERT(std::filesystem::file_size(path) <= capped.rlim_cur);
+                }
+            }
+            std::signal(SIGXFSZ, saved_handler);
+            std::remove(path.c_str());
+        }
+        std::cout << "Passed\n";
+    }
+
+    // SIGXFSZ handler: makes the failure injected above a one-off
+    static void lift_file_size_cap(int) {
+        rlimit limit{};
+        getrlimit(RLIMIT_FSIZE, &limit);
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_FSIZE, &limit);
+    }
+
+    static void test_journal_crc_recovery() {
+        std::cout << "Test 31: Journal CRC32C and Torn-Tail Recovery... ";
+        // Known answer, hardware/software agreement at every length and
+        // alignment, and chaining
+        TEST_ASSERT(crc32c::value("123456789", 9) == 0xE3069283u);
+        TEST_ASSERT(crc32c::extend_software(0, "123456789", 9) == 0xE3069283u);
+        uint8_t noise[300];
+        for (size_t i = 0; i < sizeof(noise); ++i) noise[i] = static_cast<uint8_t>(i * 131 + 7);
+        for (size_t off = 0; off < 8; ++off) {
+            for (size_t len = 0; len + off <= sizeof(noise); len += 13) {
+                TEST_ASSERT(crc32c::extend(0, noise + off, len) ==
+                            crc32c::extend_software(0, noise + off, len));
+            }
+        }
+        TEST_ASSERT(crc32c::extend(crc32c::value(noise, 100), noise + 100, 200) ==
+                    crc32c::value(noise, 300));
+
+        const std::string path = "test_recovery.jnl";
+        OrderBook book(2000);
+        for (uint64_t i = 1; i <= 1000; ++i) {
+            book.process_new_order(OrderId(i), (i % 2) ? Side::BUY : Side::SELL,
+                                   from_double(100.0 + (i % 5) * 0.01 - 0.02), Quantity(5 + i % 3));
+        }
+        const std::vector<Event>& log = book.get_event_log();
+        AsyncJournalConfig config;
+        config.record_events = 64;
+        {
+            AsyncJournal journal(path, config);
+            for (const Event& e : log) journal.append(e);
+        }
+        AsyncJournalScan full = AsyncJournal::verify(path);
+        TEST_ASSERT(full.clean() && full.events == log.size());
+
+        auto file_bytes = [&path] {
+            std::ifstream in(path, std::ios::binary);
+            return std::vector<char>((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        };
+        auto write_bytes = [&path](const std::vector<char>& bytes) {
+            std::ofstream out(path, std::ios::binary | std::ios::trunc);
+            out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+        };
+        const std::vector<char> original = file_bytes();
+
+        // How the writer split the events into records depends on timing;
+        // take the event counts from the record headers
+        std::vector<uint64_t> record_events;
+        for (size_t pos = ASYNC_JOURNAL_HEADER_SIZE; pos < original.size();) {
+            const uint8_t* header = reinterpret_cast<const uint8_t*>(original.data() + pos);
+            record_events.push_back(journal::get_u32(header + 4));
+            TEST_ASSERT(record_events.back() >= 1 && record_events.back() <= 64);
+            pos += ASYNC_JOURNAL_RECORD_HEADER_SIZE + journal::get_u32(header);
+        }
+        TEST_ASSERT(record_events.size() == full.records);
+        const uint64_t kept = full.events - record_events.back();
+
+        // Torn write: the last record is cut short
+        std::vector<char> torn(original.begin(), original.end() - 10);
+        write_bytes(torn);
+        std::vector<Event> loaded;
+        TEST_ASSERT(!AsyncJournal::read(path, loaded));
+        TEST_ASSERT(loaded.size() == kept);
+
+        // Bit rot inside an earlier record: everything from it on is dropped
+        std::vector<char> flipped = original;
+        flipped[ASYNC_JOURNAL_HEADER_SIZE + ASYNC_JOURNAL_RECORD_HEADER_SIZE + 3] ^= 0x40;
+        write_bytes(flipped);
+        AsyncJournalScan bad = AsyncJournal::verify(path);
+        TEST_ASSERT(bad.records == 0 && bad.valid_bytes == ASYNC_JOURNAL_HEADER_SIZE);
+
+        // Zero-filled tail (allocated but unwritten blocks) is trimmed
+        std::vector<char> zeros = original;
+        zeros.resize(original.size() + 4096, 0);
+        write_bytes(zeros);
+        AsyncJournalScan trimmed = AsyncJournal::recover(path);
+        TEST_ASSERT(!trimmed.clean() && trimmed.events == log.size());
+        TEST_ASSERT(file_bytes() == original);
+
+        // Resume after a torn tail: truncate, then continue the sequence
+        write_bytes(torn);
+        {
+            config.resume = true;
+            AsyncJournal journal(path, config);
+            TEST_ASSERT(journal.appended() == kept && journal.durable() == kept);
+            for (size_t i = kept; i < log.size(); ++i) {
+                TEST_ASSERT(journal.append(log[i]) == i + 1);
+            }
+        }
+        loaded.clear();
+        TEST_ASSERT(AsyncJournal::read(path, loaded));
+        TEST_ASSERT(loaded.size() == log.size());
+        char a[256], b[256];
+        for (size_t i = 0; i < log.size(); ++i) {
+            event_to_buffer(loaded[i], a, sizeof(a));
+            event_to_buffer(log[i], b, sizeof(b));
+            TEST_ASSERT(std::string(a) == b);
+        }
+        std::remove(path.c_str());
+        std::cout << "Passed\n";
+    }
+
+    static void test_segmented_journal() {
+        std::cout << "Test 32: Segmented Journal With Footer Index... ";
+        auto to_strings = [](std::vector<Event>::const_iterator begin, std::vector<Event>::const_iterator end) {
+            std::vector<std::string> out;
+            char buf[256];
+            for (auto it = begin; it != end; ++it) {
+                event_to_buffer(*it, buf, sizeof(buf));
+                out.emplace_back(buf);
+            }
+            return out;
+        };
+        auto same = [&](const std::vector<Event>& a, const std::vector<Event>& b) {
+            return to_strings(a.begin(), a.end()) == to_strings(b.begin(), b.end());
+        };
+        const std::string dir = "test_segments";
+        std::filesystem::remove_all(dir);
+        AsyncJournalConfig config;
+        config.segment_bytes = 4096;
+        config.record_events = 50;
+        config.index_events = 100;
+
+        OrderBook book(8000);
+        auto trade = [&book](uint64_t from, uint64_t to) {
+            for (uint64_t i = from; i <= to; ++i) {
+                book.process_new_order(OrderId(i), (i % 2) ? Side::BUY : Side::SELL,
+                                       from_double(100.0 + (i % 9) * 0.01 - 0.04), Quantity(3 + i % 4));
+                if (i % 4 == 0) book.process_cancel(OrderId(i - 1));
+            }
+        };
+        {
+            AsyncJournal journal(dir, config);
+            book.attach_event_sink(&journal);
+            trade(1, 2000);
+            book.attach_event_sink(nullptr);
+            journal.close();
+            TEST_ASSERT(!journal.failed() && journal.stats().segments > 3);
+        }
+        const std::vector<Event>& log = book.get_event_log();
+
+        // Rolled at the size limit, every segment sealed and chained
+        JournalSegments segments = JournalSegments::open(dir);
+        TEST_ASSERT(segments.segments().size() > 3);
+        TEST_ASSERT(segments.first_seq() == 1 && segments.last_seq() == log.size());
+        TEST_ASSERT(segments.verify());
+        for (const JournalSegmentInfo& seg : segments.segments()) {
+            TEST_ASSERT(seg.sealed && !seg.index.empty() && seg.first_ts <= seg.last_ts);
+            TEST_ASSERT(seg.records_end <= config.segment_bytes);
+            TEST_ASSERT(seg.index.front().first == seg.first_seq);
+        }
+        std::vector<Event> loaded;
+        TEST_ASSERT(segments.read_all(loaded) && same(loaded, log));
+
+        // Seek anywhere: segment starts, mid-index, the last event, past the end
+        const JournalSegmentInfo& second = segments.segments()[1];
+        for (uint64_t seq : {uint64_t(1), second.first_seq, second.first_seq + 77,
+                             uint64_t(log.size() / 2), uint64_t(log.size())}) {
+            TEST_ASSERT(segments.find_segment(seq) < segments.segments().size());
+            const JournalSegmentInfo& seg = segments.segments()[segments.find_segment(seq)];
+            TEST_ASSERT(seg.first_seq <= seq && seq <= seg.last_seq);
+            std::vector<Event> window;
+            TEST_ASSERT(segments.read_from(seq, window, 10));
+            size_t end = std::min<size_t>(log.size(), seq - 1 + 10);
+            TEST_ASSERT(to_strings(window.begin(), window.end()) ==
+                        to_strings(log.begin() + static_cast<std::ptrdiff_t>(seq - 1),
+                                   log.begin() + static_cast<std::ptrdiff_t>(end)));
+        }
+        TEST_ASSERT(segments.find_segment(log.size() + 1) == segments.segments().size());
+        std::vector<Event> tail = ReplayEngine::load_segments(dir, log.size() - 5);
+        TEST_ASSERT(tail.size() == 6);
+
+        // A crash tore the last footer: resume continues inside that segment
+        const std::string last_path = segments.segments().back().path;
+        std::filesystem::resize_file(last_path, std::filesystem::file_size(last_path) - 10);
+        TEST_ASSERT(!JournalSegments::open(dir).segments().back().sealed);
+        const size_t before = log.size();
+        {
+            config.resume = true;
+            AsyncJournal journal(dir, config);
+            TEST_ASSERT(journal.appended() == before);
+            book.attach_event_sink(&journal);
+            trade(2001, 2600);
+            book.attach_event_sink(nullptr);
+        }
+        segments = JournalSegments::open(dir);
+        TEST_ASSERT(segments.last_seq() == log.size() && segments.verify());
+        loaded.clear();
+        TEST_ASSERT(segments.read_all(loaded) && same(loaded, log));
+        TEST_ASSERT(same(ReplayEngine::load_segments(dir, before + 1),
+                         std::vector<Event>(log.begin() + static_cast<std::ptrdiff_t>(before), log.end())));
+        std::filesystem::remove_all(dir);
+        std::cout << "Passed\n";
+    }
+
+    static void test_journal_replica() {
+        std::cout << "Test 33: Journal-Tailing Replica... ";
+        for (bool segmented : {false, true}) {
+            // The replica starts before the journal exists and tails it live
+            const std::string path = segmented ? "test_replica_segments" : "test_replica.jnl";
+            std::filesystem::remove_all(path);
+            JournalReplica replica(path, 10000);
+            TEST_ASSERT(replica.poll() == 0 && replica.applied() == 0);
+
+            std::atomic<uint64_t> expected{std::numeric_limits<uint64_t>::max()};
+            std::atomic<bool> timed_out{false};
+            std::thread tail([&] {
+                auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+                while (replica.applied() != expected.load(std::memory_order_acquire)) {
+                    if (std::chrono::steady_clock::now() > deadline) {
+                        timed_out = true;
+                        return;
+                    }
+                    if (replica.poll() == 0) replica.wait(std::chrono::milliseconds(1));
+                }
+            });
+
+            AsyncJournalConfig config;
+            config.record_events = 64;
+            config.sync = false;
+            if (segmented) config.segment_bytes = 8192;
+            OrderBook book(10000);
+            {
+                AsyncJournal journal(path, config);
+                book.attach_event_sink(&journal);
+                for (uint64_t i = 1; i <= 3000; ++i) {
+                    Side side = (i % 2) ? Side::BUY : Side::SELL;
+                    book.process_new_order(OrderId(i), side, from_double(100.0 + (i % 11) * 0.01 - 0.05),
+                                           Quantity(2 + i % 6), OwnerId(1 + i % 3));
+                    if (i % 5 == 0) book.process_cancel(OrderId(i - 2));
+                    if (i % 7 == 0) book.process_modify(OrderId(i - 1), from_double(100.02), Quantity(4));
+                    if (i % 1000 == 0) book.process_mass_cancel(MassCancelFilter::for_owner(OwnerId(2)));
+                }
+                book.attach_event_sink(nullptr);
+                journal.close();
+                expected.store(journal.appended(), std::memory_order_release);
+            }
+            tail.join();
+            TEST_ASSERT(!timed_out);
+            TEST_ASSERT(replica.segmented() == segmented);
+            TEST_ASSERT(replica.applied() == book.get_event_log().size());
+            TEST_ASSERT(replica.max_lag().events > 0);
+
+            // Same resting orders, in the same priority, as the primary
+            const OrderBook& copy = replica.book();
+            TEST_ASSERT(copy.order_count() == book.order_count());
+            TEST_ASSERT(copy.best_bid() == book.best_bid() && copy.best_ask() == book.best_ask());
+            std::vector<std::pair<uint64_t, uint64_t>> a, b;
+            for (Side side : {Side::BUY, Side::SELL}) {
+                book.for_each_order(side, [&a](const Order& o) { a.emplace_back(o.id.get(), o.remaining_qty.get()); });
+                copy.for_each_order(side, [&b](const Order& o) { b.emplace_back(o.id.get(), o.remaining_qty.get()); });
+            }
+            TEST_ASSERT(a == b);
+            TEST_ASSERT(replica.poll() == 0);
+            std::filesystem::remove_all(path);
+        }
+        
+        // The fill reporting mode is not journaled: a replica built in the
+        // primary's mode regenerates its exact log
+        const std::string dir = "test_replica_archived";
+        std::filesystem::remove_all(dir);
+        AsyncJournalConfig config;
+        config.record_events = 32;
+        config.sync = false;
+        config.segment_bytes = 4096;
+        OrderBook book(10000);
+        book.set_fill_reporting(FillReporting::PER_LEVEL);
+        {
+            AsyncJournal journal(dir, config);
+            book.attach_event_sink(&journal);
+            for (uint64_t i = 1; i <= 2000; ++i) {
+                Side side = (i % 2) ? Side::BUY : Side::SELL;
+                book.process_new_order(OrderId(i), side, from_double(100.0 + (i % 9) * 0.01 - 0.04),
+                                       Quantity(1 + i % 4), OwnerId(1));
+                if (i % 6 == 0) book.process_cancel(OrderId(i - 3));
+            }
+            book.attach_event_sink(nullptr);
+        }
+        const std::vector<Event>& log = book.get_event_log();
+        {
+            JournalReplica replica(dir, 10000, FillReporting::PER_LEVEL);
+            TEST_ASSERT(replica.poll() == log.size());
+            TEST_ASSERT(replica.book().get_event_log().size() == log.size());
+            size_t level_trades = 0;
+            for (const Event& e : replica.book().get_event_log()) {
+                level_trades += std::holds_alternative<LevelTradeEvent>(e);
+            }
+            TEST_ASSERT(level_trades > 0);
+        }
+        
+        // Archive the oldest segments: without a base the replica refuses
+        // to start mid-history, with one it catches up to the primary
+        JournalSegments all = JournalSegments::open(dir);
+        TEST_ASSERT(all.segments().size() > 3);
+        for (size_t i = 0; i < 2; ++i) {
+            std::filesystem::remove(async_journal::segment_path(dir, all.segments()[i].first_seq));
+        }
+        const uint64_t first_seq = all.segments()[2].first_seq;
+        {
+            JournalReplica replica(dir, 10000, FillReporting::PER_LEVEL);
+            bool threw = false;
+            try {
+                replica.poll();
+            } catch (const std::runtime_error&) {
+                threw = true;
+            }
+            TEST_ASSERT(threw && replica.applied() == 0);
+        }
+        {
+            // A base reaching into the oldest segment; its earlier events are skipped
+            const uint64_t base_seq = first_seq + 5;
+            std::vector<Event> prefix(log.begin(), log.begin() + base_seq);
+            JournalReplica replica(dir, ReplayEngine::replay_from_log(prefix, FillReporting::PER_LEVEL),
+                                   base_seq);
+            TEST_ASSERT(replica.applied() == base_seq);
+            TEST_ASSERT(replica.poll() == log.size() - base_seq);
+            TEST_ASSERT(replica.applied() == log.size());
+            std::vector<std::pair<uint64_t, uint64_t>> a, b;
+            for (Side side : {Side::BUY, Side::SELL}) {
+                book.for_each_order(side, [&a](const Order& o) { a.emplace_back(o.id.get(), o.remaining_qty.get()); });
+                replica.book().for_each_order(side, [&b](const Order& o) { b.emplace_back(o.id.get(), o.remaining_qty.get()); });
+            }
+            TEST_ASSERT(!a.empty() && a == b);
+        }
+        std::filesystem::remove_all(dir);
+
+        // A record longer than the replica's 64 KiB read window: a quote
+        // ladder between two runs of orders
+        const std::string big = "test_replica_big.jnl";
+        std::vector<QuoteEntry> bids, asks;
+        for (uint64_t i = 0; i < 4000; ++i) {
+            bids.push_back({OrderId((2 * i + 1) << 30), from_double(90.0 - 0.01 * i), Quantity(100000 + i % 7)});
+            asks.push_back({OrderId((2 * i + 2) << 30), from_double(110.0 + 0.01 * i), Quantity(100000 + i % 5)});
+        }
+        OrderBook primary(20000);
+        {
+            AsyncJournalConfig big_config;
+            big_config.sync = false;
+            AsyncJournal journal(big, big_config);
+            primary.attach_event_sink(&journal);
+            for (uint64_t i = 1; i <= 500; ++i) {
+                primary.process_new_order(OrderId(i), (i % 2) ? Side::BUY : Side::SELL,
+                                          from_double((i % 2) ? 99.0 : 101.0), Quantity(1));
+            }
+            primary.process_quote(OwnerId(7), bids.data(), bids.size(), asks.data(), asks.size());
+            for (uint64_t i = 501; i <= 600; ++i) primary.process_cancel(OrderId(i - 500));
+            primary.attach_event_sink(nullptr);
+        }
+        TEST_ASSERT(std::filesystem::file_size(big) > 64 * 1024);
+        {
+            JournalReplica replica(big, 20000, FillReporting::PER_FILL, 64 * 1024);
+            TEST_ASSERT(replica.poll() == primary.get_event_log().size());
+            TEST_ASSERT(replica.book().order_count() == primary.order_count());
+            TEST_ASSERT(replica.book().best_bid() == primary.best_bid());
+            TEST_ASSERT(replica.book().best_ask() == primary.best_ask());
+        }
+        std::remove(big.c_str());
+        std::cout << "Passed\n";
+    }
+
+    // Build with -DENABLE_ASAN=ON to check the writer's buffer edges
+    static void test_oversized_journal_records() {
+        std::cout << "Test 34: Journal Records Larger Than a Buffer... ";
+        // 8000 rungs encode to well over the 64 KiB write buffer and the
+        // 4 KiB segments; small orders before and after it fill the buffer
+        // up to the edge first
+        std::vector<QuoteEntry> bids, asks;
+        for (uint64_t i = 0; i < 4000; ++i) {
+            bids.push_back({OrderId((2 * i + 1) << 30), from_double(90.0 - 0.01 * i), Quantity(100000 + i % 7)});
+            asks.push_back({OrderId((2 * i + 2) << 30), from_double(110.0 + 0.01 * i), Quantity(100000 + i % 5)});
+        }
+        {
+            auto ladder = std::make_shared<QuoteLadder>();
+            ladder->bid_count = 4000;
+            ladder->rungs = bids;
+            ladder->rungs.insert(ladder->rungs.end(), asks.begin(), asks.end());
+            JournalBlockEncoder encoder;
+            encoder.add(Event(std::in_place_type<QuoteEvent>, Timestamp(1), OwnerId(7), ladder));
+            TEST_ASSERT(encoder.payload().size() > 64 * 1024);
+        }
+        for (bool segmented : {false, true}) {
+            const std::string path = segmented ? "test_oversized_segments" : "test_oversized.jnl";
+            std::filesystem::remove_all(path);
+            AsyncJournalConfig config;
+            config.buffer_bytes = 64 * 1024;
+            config.record_events = 4096;
+            config.sync = false;
+            if (segmented) config.segment_bytes = 4096;
+            OrderBook book(20000);
+            {
+                AsyncJournal journal(path, config);
+                book.attach_event_sink(&journal);
+                for (uint64_t i = 1; i <= 3000; ++i) {
+                    book.process_new_order(OrderId(i), (i % 2) ? Side::BUY : Side::SELL,
+                                           from_double((i % 2) ? 99.0 : 101.0), Quantity(1));
+                }
+                book.process_quote(OwnerId(7), bids.data(), bids.size(), asks.data(), asks.size());
+                book.process_quote(OwnerId(7), bids.data(), 10, asks.data(), 10);
+                for (uint64_t i = 3001; i <= 3100; ++i) book.process_cancel(OrderId(i - 3000));
+                book.attach_event_sink(nullptr);
+                journal.close();
+                TEST_ASSERT(!journal.failed() && journal.appended() == book.get_event_log().size());
+            }
+            std::vector<Event> loaded;
+            if (segmented) {
+                JournalSegments segments = JournalSegments::open(path);
+                TEST_ASSERT(segments.verify() && segments.read_all(loaded));
+                // The quote took a segment of its own, past the size limit
+                size_t oversized = 0;
+                for (const JournalSegmentInfo& seg : segments.segments()) {
+                    if (seg.records_end > config.segment_bytes) {
+                        ++oversized;
+                        TEST_ASSERT(seg.first_seq == seg.last_seq);
+                    }
+                }
+                TEST_ASSERT(oversized == 1);
+            } else {
+                TEST_ASSERT(AsyncJournal::read(path, loaded));
+            }
+            const std::vector<Event>& log = book.get_event_log();
+            TEST_ASSERT(loaded.size() == log.size());
+            char a[256], b[256];
+            for (size_t i = 0; i < log.size(); ++i) {
+                event_to_buffer(loaded[i], a, sizeof(a));
+                event_to_buffer(log[i], b, sizeof(b));
+                TEST_ASSERT(std::string(a) == b);
+            }
+            const QuoteEvent* quote = nullptr;
+            for (const Event& e : loaded) {
+                if (!quote) quote = std::get_if<QuoteEvent>(&e);
+            }
+            TEST_ASSERT(quote && quote->ladder->rungs.size() == 8000);
+            TEST_ASSERT(quote->ladder->rungs.back().price == asks.back().price);
+            std::filesystem::remove_all(path);
+        }
+        std::cout << "Passed\n";
+    }
+
+    static void test_reserved_owner_rejected() {
+        std::cout << "Test 35: Wildcard Owner Rejected on Entry... ";
+        auto stream = std::make_unique<ExecutionStream>();
+        auto consumer = stream->subscribe();
+        OrderBook book(100);
+        book.attach_execution_stream(stream.get());
+
+        // ANY_OWNER means "every owner" to a mass cancel, so no order may
+        // rest under it
+        book.process_new_order(OrderId(1), Side::BUY, from_double(100.0), Quantity(10),
+                               MassCancelFilter::ANY_OWNER);
+        const auto* r = std::get_if<RejectOrderEvent>(&book.get_event_log().back());
+        TEST_ASSERT(r && r->order_id == OrderId(1) && r->reason == RejectReason::RESERVED_OWNER);
+        TEST_ASSERT(book.order_count() == 0);
+
+        ExecutionReport report{};
+        TEST_ASSERT(consumer.poll(report) == PollResult::OK);
+        TEST_ASSERT(report.type == ReportType::REJECT_NEW);
+        TEST_ASSERT(report.quantity == static_cast<uint64_t>(RejectReason::RESERVED_OWNER));
+
+        // The owner just below the wildcard is an ordinary one
+        book.process_new_order(OrderId(2), Side::BUY, from_double(100.0), Quantity(10),
+                               OwnerId(MassCancelFilter::ANY_OWNER.get() - 1));
+        TEST_ASSERT(book.order_count() == 1);
+
+        // Replay rejects the same order
+        OrderBook replayed = ReplayEngine::replay_from_log(book.get_event_log());
+        TEST_ASSERT(replayed.get_event_log().size() == book.get_event_log().size());
+        TEST_ASSERT(replayed.order_count() == 1);
+        std::cout << "Passed\n";
+    }
 };
 
 // ============================================================================